@@ -0,0 +1,80 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_ASYNC_CONNECT_PRIVATE_H
+#define LV_LIBSSH2_ASYNC_CONNECT_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2-socket-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+typedef enum _lv_libssh2_async_connect_states {
+  LV_LIBSSH2_ASYNC_CONNECT_STATE_RESOLVE = 0,
+  LV_LIBSSH2_ASYNC_CONNECT_STATE_CONNECT,
+  LV_LIBSSH2_ASYNC_CONNECT_STATE_HANDSHAKE,
+  LV_LIBSSH2_ASYNC_CONNECT_STATE_VERIFY,
+  LV_LIBSSH2_ASYNC_CONNECT_STATE_AUTHENTICATE,
+  LV_LIBSSH2_ASYNC_CONNECT_STATE_DONE
+} lv_libssh2_async_connect_states_t;
+
+/**
+ * A connection and authentication that advances one non-blocking step at a
+ * time, either on its own thread or whenever it is polled. The mutex guards
+ * the status, which stays ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN until the
+ * state is done.
+ */
+struct _lv_libssh2_async_connect {
+  lv_libssh2_session_t *session;
+  char *host;
+  int32_t port;
+  int32_t timeout;
+  lv_libssh2_credentials_t *credentials;
+  lv_libssh2_knownhosts_store_t *known_hosts;
+  lv_libssh2_async_connect_states_t state;
+  lv_libssh2_connector_t connector;
+  bool connector_open;
+  int blocking;
+  size_t auth_step;
+  uint64_t start;
+  lv_libssh2_atomic_t cancelled;
+  bool background;
+  lv_libssh2_thread_t thread;
+  lv_libssh2_mutex_t mutex;
+  lv_libssh2_condition_t finished;
+  lv_libssh2_status_t status;
+};
+
+#endif
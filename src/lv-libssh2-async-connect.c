@@ -0,0 +1,360 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-async-connect-private.h"
+#include "lv-libssh2-credentials-private.h"
+#include "lv-libssh2-knownhosts-store-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-socket-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+/* The longest a background step waits, in milliseconds, so that a
+ * cancellation is noticed promptly. */
+#define WAIT_PERIOD 100
+
+/* Gets how long a step may wait, returning `false` if the timeout passed. */
+static bool
+lv_libssh2_async_connect_wait_time(lv_libssh2_async_connect_t *operation,
+                                   const uint32_t milliseconds,
+                                   uint32_t *wait) {
+  *wait = milliseconds;
+  if (operation->timeout < 0) {
+    return true;
+  }
+  uint64_t elapsed = lv_libssh2_time_elapsed(operation->start) / 1000;
+  if (elapsed >= (uint64_t)operation->timeout) {
+    return false;
+  }
+  if ((uint64_t)operation->timeout - elapsed < *wait) {
+    *wait = (uint32_t)((uint64_t)operation->timeout - elapsed);
+  }
+  return true;
+}
+
+/* Runs one step of the current state, waiting at most the number of
+ * milliseconds for the socket. Returns
+ * ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN until the operation is done. */
+static lv_libssh2_status_t
+lv_libssh2_async_connect_advance(lv_libssh2_async_connect_t *operation,
+                                 const uint32_t milliseconds) {
+  lv_libssh2_session_t *session = operation->session;
+  if (lv_libssh2_atomic_load(&operation->cancelled) != 0) {
+    return LV_LIBSSH2_STATUS_ERROR_CANCELLED;
+  }
+  uint32_t wait = 0;
+  if (!lv_libssh2_async_connect_wait_time(operation, milliseconds, &wait)) {
+    return operation->state <= LV_LIBSSH2_ASYNC_CONNECT_STATE_CONNECT
+               ? LV_LIBSSH2_STATUS_ERROR_SOCKET_TIMEOUT
+               : LV_LIBSSH2_STATUS_ERROR_TIMEOUT;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  int result = 0;
+  switch (operation->state) {
+  case LV_LIBSSH2_ASYNC_CONNECT_STATE_RESOLVE:
+    /* Resolving the host is the one step that blocks. */
+    status = lv_libssh2_connector_start(
+        &operation->connector, operation->host, operation->port, 0,
+        session->send_buffer_size, session->receive_buffer_size);
+    if (lv_libssh2_status_is_err(status)) {
+      return status;
+    }
+    operation->connector_open = true;
+    operation->state = LV_LIBSSH2_ASYNC_CONNECT_STATE_CONNECT;
+    break;
+  case LV_LIBSSH2_ASYNC_CONNECT_STATE_CONNECT: {
+    lv_libssh2_socket_t socket = LV_LIBSSH2_SOCKET_INVALID;
+    status = lv_libssh2_connector_step(&operation->connector, wait, &socket);
+    if (status == LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+      return status;
+    }
+    lv_libssh2_connector_close(&operation->connector);
+    operation->connector_open = false;
+    if (lv_libssh2_status_is_err(status)) {
+      return status;
+    }
+    session->socket = socket;
+    session->owns_socket = true;
+    operation->blocking = libssh2_session_get_blocking(session->inner);
+    libssh2_session_set_blocking(session->inner, 0);
+    operation->state = LV_LIBSSH2_ASYNC_CONNECT_STATE_HANDSHAKE;
+    break;
+  }
+  case LV_LIBSSH2_ASYNC_CONNECT_STATE_HANDSHAKE:
+    result = libssh2_session_handshake(session->inner, session->socket);
+    if (result == LIBSSH2_ERROR_EAGAIN) {
+      lv_libssh2_session_wait(session, wait);
+      return LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+    }
+    if (result != 0) {
+      return lv_libssh2_status_from_result(result);
+    }
+    operation->state = LV_LIBSSH2_ASYNC_CONNECT_STATE_VERIFY;
+    break;
+  case LV_LIBSSH2_ASYNC_CONNECT_STATE_VERIFY:
+    if (operation->known_hosts != NULL) {
+      status = lv_libssh2_knownhosts_store_verify(
+          operation->known_hosts, session, operation->host, operation->port);
+      if (lv_libssh2_status_is_err(status)) {
+        return status;
+      }
+    }
+    operation->state = LV_LIBSSH2_ASYNC_CONNECT_STATE_AUTHENTICATE;
+    break;
+  case LV_LIBSSH2_ASYNC_CONNECT_STATE_AUTHENTICATE:
+    status = lv_libssh2_credentials_authenticate(
+        operation->credentials, session, &operation->auth_step);
+    if (status == LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+      lv_libssh2_session_wait(session, wait);
+      return status;
+    }
+    if (lv_libssh2_status_is_err(status)) {
+      return status;
+    }
+    operation->state = LV_LIBSSH2_ASYNC_CONNECT_STATE_DONE;
+    return LV_LIBSSH2_STATUS_OK;
+  case LV_LIBSSH2_ASYNC_CONNECT_STATE_DONE:
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  return LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+}
+
+/* Releases what the steps opened and records the final status. A failed
+ * session is left without a socket. */
+static void
+lv_libssh2_async_connect_finish(lv_libssh2_async_connect_t *operation,
+                                const lv_libssh2_status_t status) {
+  lv_libssh2_session_t *session = operation->session;
+  if (operation->connector_open) {
+    lv_libssh2_connector_close(&operation->connector);
+    operation->connector_open = false;
+  }
+  if (operation->state > LV_LIBSSH2_ASYNC_CONNECT_STATE_CONNECT) {
+    libssh2_session_set_blocking(session->inner, operation->blocking);
+    if (lv_libssh2_status_is_err(status)) {
+      lv_libssh2_socket_close(session->socket);
+      session->socket = LV_LIBSSH2_SOCKET_INVALID;
+      session->owns_socket = false;
+    }
+  }
+  operation->state = LV_LIBSSH2_ASYNC_CONNECT_STATE_DONE;
+  lv_libssh2_mutex_lock(&operation->mutex);
+  operation->status = status;
+  lv_libssh2_condition_broadcast(&operation->finished);
+  lv_libssh2_mutex_unlock(&operation->mutex);
+}
+
+static void lv_libssh2_async_connect_run(void *context) {
+  lv_libssh2_async_connect_t *operation = context;
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+  while (status == LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+    status = lv_libssh2_async_connect_advance(operation, WAIT_PERIOD);
+  }
+  lv_libssh2_async_connect_finish(operation, status);
+}
+
+static lv_libssh2_status_t
+lv_libssh2_async_connect_status(lv_libssh2_async_connect_t *operation) {
+  lv_libssh2_mutex_lock(&operation->mutex);
+  lv_libssh2_status_t status = operation->status;
+  lv_libssh2_mutex_unlock(&operation->mutex);
+  return status;
+}
+
+/* Advances an operation without a thread of its own, returning its status
+ * afterwards. */
+static lv_libssh2_status_t
+lv_libssh2_async_connect_step(lv_libssh2_async_connect_t *operation,
+                              const uint32_t milliseconds) {
+  if (operation->state == LV_LIBSSH2_ASYNC_CONNECT_STATE_DONE) {
+    return operation->status;
+  }
+  lv_libssh2_status_t status =
+      lv_libssh2_async_connect_advance(operation, milliseconds);
+  if (status != LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+    lv_libssh2_async_connect_finish(operation, status);
+  }
+  return status;
+}
+
+static void
+lv_libssh2_async_connect_free(lv_libssh2_async_connect_t *operation) {
+  if (operation->credentials != NULL) {
+    lv_libssh2_credentials_destroy(operation->credentials);
+  }
+  lv_libssh2_condition_destroy(&operation->finished);
+  lv_libssh2_mutex_destroy(&operation->mutex);
+  free(operation->host);
+  free(operation);
+}
+
+lv_libssh2_status_t lv_libssh2_async_connect_create(
+    lv_libssh2_session_t *session, const char *host, const int32_t port,
+    lv_libssh2_credentials_t *credentials,
+    lv_libssh2_knownhosts_store_t *known_hosts, const int32_t timeout,
+    const bool background, lv_libssh2_async_connect_t **handle) {
+  *handle = NULL;
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (host == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (credentials == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session->socket != LV_LIBSSH2_SOCKET_INVALID) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  lv_libssh2_async_connect_t *operation =
+      calloc(1, sizeof(lv_libssh2_async_connect_t));
+  if (operation == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  lv_libssh2_mutex_init(&operation->mutex);
+  lv_libssh2_condition_init(&operation->finished);
+  operation->host = malloc(strlen(host) + 1);
+  if (operation->host == NULL) {
+    lv_libssh2_async_connect_free(operation);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  strcpy(operation->host, host);
+  lv_libssh2_status_t status =
+      lv_libssh2_credentials_copy(credentials, &operation->credentials);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_async_connect_free(operation);
+    return status;
+  }
+  operation->session = session;
+  operation->port = port;
+  operation->timeout = timeout;
+  operation->known_hosts = known_hosts;
+  operation->state = LV_LIBSSH2_ASYNC_CONNECT_STATE_RESOLVE;
+  operation->start = lv_libssh2_time_now();
+  operation->status = LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+  operation->background = background;
+  if (background) {
+    status = lv_libssh2_thread_start(&operation->thread,
+                                     lv_libssh2_async_connect_run, operation);
+    if (lv_libssh2_status_is_err(status)) {
+      lv_libssh2_async_connect_free(operation);
+      return status;
+    }
+  }
+  *handle = operation;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_async_connect_destroy(lv_libssh2_async_connect_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_atomic_add(&handle->cancelled, 1);
+  if (handle->background) {
+    lv_libssh2_thread_join(handle->thread);
+  } else {
+    lv_libssh2_async_connect_step(handle, 0);
+  }
+  lv_libssh2_async_connect_free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_async_connect_poll(lv_libssh2_async_connect_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->background) {
+    return lv_libssh2_async_connect_status(handle);
+  }
+  return lv_libssh2_async_connect_step(handle, 0);
+}
+
+lv_libssh2_status_t
+lv_libssh2_async_connect_wait(lv_libssh2_async_connect_t *handle,
+                              const int32_t timeout) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  const uint64_t start = lv_libssh2_time_now();
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+  for (;;) {
+    uint32_t wait = WAIT_PERIOD;
+    if (timeout >= 0) {
+      uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+      if (elapsed >= (uint64_t)timeout) {
+        break;
+      }
+      if ((uint64_t)timeout - elapsed < wait) {
+        wait = (uint32_t)((uint64_t)timeout - elapsed);
+      }
+    }
+    if (handle->background) {
+      lv_libssh2_mutex_lock(&handle->mutex);
+      if (handle->status == LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+        lv_libssh2_condition_timed_wait(&handle->finished, &handle->mutex,
+                                        wait);
+      }
+      status = handle->status;
+      lv_libssh2_mutex_unlock(&handle->mutex);
+    } else {
+      status = lv_libssh2_async_connect_step(handle, wait);
+    }
+    if (status != LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+      return status;
+    }
+  }
+  if (handle->background) {
+    return lv_libssh2_async_connect_status(handle);
+  }
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_async_connect_cancel(lv_libssh2_async_connect_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_atomic_add(&handle->cancelled, 1);
+  return LV_LIBSSH2_STATUS_OK;
+}
@@ -34,10 +34,31 @@
 #ifndef LV_LIBSSH2_CHANNEL_PRIVATE_H
 #define LV_LIBSSH2_CHANNEL_PRIVATE_H
 
+#include "lv-libssh2-ring-private.h"
 #include "lv-libssh2.h"
 
 struct _lv_libssh2_channel {
   LIBSSH2_CHANNEL *inner;
+  lv_libssh2_session_t *session;
+  lv_libssh2_ring_t *ring;
+  struct _lv_libssh2_channel_queues *queues;
+  uint32_t autotune_max;
+  uint32_t autotune_window;
 };
 
+/* Wraps an open inner channel in a new handle with no ring, pump, or
+ * auto-tuning. Frees the inner channel if the handle cannot be allocated. */
+lv_libssh2_status_t lv_libssh2_channel_wrap(lv_libssh2_session_t *session,
+                                            LIBSSH2_CHANNEL *inner,
+                                            lv_libssh2_channel_t **handle);
+
+/* Frees the inner channel, removing it from its pump first, then the ring
+ * and the handle itself. Returns the result of freeing the inner channel. */
+int lv_libssh2_channel_free(lv_libssh2_channel_t *channel);
+
+/* Grows the receive window of an auto-tuned channel after a read that
+ * returned `byte_count` bytes. Does nothing for other channels. */
+void lv_libssh2_channel_autotune(lv_libssh2_channel_t *channel,
+                                 const size_t byte_count);
+
 #endif
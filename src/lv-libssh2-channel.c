@@ -38,40 +38,81 @@
 
 #include "lv-libssh2-channel-private.h"
 #include "lv-libssh2-listener-private.h"
+#include "lv-libssh2-pump-private.h"
+#include "lv-libssh2-ring-private.h"
 #include "lv-libssh2-session-private.h"
 #include "lv-libssh2-status-private.h"
 #include "lv-libssh2.h"
 
+/* The remaining receive window, as a fraction of the auto-tuned window, below
+ * which the sender is considered to be limited by the window. */
+#define AUTOTUNE_DRAINED_DIVISOR 4
+/* The remaining receive window, as a fraction of the auto-tuned window, below
+ * which the window is topped back up. */
+#define AUTOTUNE_REFILL_DIVISOR 2
+
 lv_libssh2_status_t lv_libssh2_channel_create(lv_libssh2_session_t *session,
                                               lv_libssh2_channel_t **handle) {
+  return lv_libssh2_channel_create_ex(session, LIBSSH2_CHANNEL_WINDOW_DEFAULT,
+                                      LIBSSH2_CHANNEL_PACKET_DEFAULT, handle);
+}
+
+lv_libssh2_status_t lv_libssh2_channel_wrap(lv_libssh2_session_t *session,
+                                            LIBSSH2_CHANNEL *inner,
+                                            lv_libssh2_channel_t **handle) {
+  lv_libssh2_channel_t *channel = malloc(sizeof(lv_libssh2_channel_t));
+  if (channel == NULL) {
+    libssh2_channel_free(inner);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  channel->inner = inner;
+  channel->session = session;
+  channel->ring = NULL;
+  channel->queues = NULL;
+  channel->autotune_max = 0;
+  channel->autotune_window = 0;
+  *handle = channel;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_channel_create_ex(lv_libssh2_session_t *session,
+                             const uint32_t window_size,
+                             const uint32_t packet_size,
+                             lv_libssh2_channel_t **handle) {
   *handle = NULL;
   if (session == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
   LIBSSH2_CHANNEL *inner = libssh2_channel_open_ex(
       session->inner, "session", sizeof("session") - 1,
-      LIBSSH2_CHANNEL_WINDOW_DEFAULT, LIBSSH2_CHANNEL_PACKET_DEFAULT, NULL, 0);
+      window_size == 0 ? LIBSSH2_CHANNEL_WINDOW_DEFAULT : window_size,
+      packet_size == 0 ? LIBSSH2_CHANNEL_PACKET_DEFAULT : packet_size, NULL, 0);
   if (inner == NULL) {
     return lv_libssh2_status_from_result(
         libssh2_session_last_errno(session->inner));
   }
-  lv_libssh2_channel_t *channel = malloc(sizeof(lv_libssh2_channel_t));
-  if (channel == NULL) {
-    libssh2_channel_free(inner);
-    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
-  }
-  channel->inner = inner;
-  *handle = channel;
-  return LV_LIBSSH2_STATUS_OK;
+  return lv_libssh2_channel_wrap(session, inner, handle);
+}
+
+int lv_libssh2_channel_free(lv_libssh2_channel_t *channel) {
+  int result = 0;
+  if (channel->queues != NULL) {
+    result = lv_libssh2_pump_release(channel);
+  } else {
+    result = libssh2_channel_free(channel->inner);
+  }
+  channel->inner = NULL;
+  lv_libssh2_channel_ring_destroy(channel);
+  free(channel);
+  return result;
 }
 
 lv_libssh2_status_t lv_libssh2_channel_destroy(lv_libssh2_channel_t *handle) {
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
-  libssh2_channel_free(handle->inner);
-  handle->inner = NULL;
-  free(handle);
+  lv_libssh2_channel_free(handle);
   return LV_LIBSSH2_STATUS_OK;
 }
 
@@ -90,12 +131,19 @@ lv_libssh2_status_t lv_libssh2_channel_read(lv_libssh2_channel_t *handle,
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (handle->queues != NULL &&
+      lv_libssh2_pump_read(handle, 0, buffer, buffer_len, byte_count,
+                           &status)) {
+    return status;
+  }
   ssize_t result =
       libssh2_channel_read_ex(handle->inner, 0, buffer, buffer_len);
   if (result < 0) {
     return lv_libssh2_status_from_result((int)result);
   }
   *byte_count = result;
+  lv_libssh2_channel_autotune(handle, *byte_count);
   return LV_LIBSSH2_STATUS_OK;
 }
 
@@ -112,12 +160,19 @@ lv_libssh2_status_t lv_libssh2_channel_read_stderr(lv_libssh2_channel_t *handle,
   if (byte_count == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
-  size_t result = libssh2_channel_read_ex(
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (handle->queues != NULL &&
+      lv_libssh2_pump_read(handle, SSH_EXTENDED_DATA_STDERR, buffer,
+                           buffer_len, byte_count, &status)) {
+    return status;
+  }
+  ssize_t result = libssh2_channel_read_ex(
       handle->inner, SSH_EXTENDED_DATA_STDERR, buffer, buffer_len);
   if (result < 0) {
     return lv_libssh2_status_from_result((int)result);
   }
   *byte_count = result;
+  lv_libssh2_channel_autotune(handle, *byte_count);
   return LV_LIBSSH2_STATUS_OK;
 }
 
@@ -140,14 +195,7 @@ lv_libssh2_status_t lv_libssh2_channel_direct_tcpip(
     return lv_libssh2_status_from_result(
         libssh2_session_last_errno(session->inner));
   }
-  lv_libssh2_channel_t *channel = malloc(sizeof(lv_libssh2_channel_t));
-  if (channel == NULL) {
-    libssh2_channel_free(inner);
-    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
-  }
-  channel->inner = inner;
-  *handle = channel;
-  return LV_LIBSSH2_STATUS_OK;
+  return lv_libssh2_channel_wrap(session, inner, handle);
 }
 
 lv_libssh2_status_t lv_libssh2_channel_eof(lv_libssh2_channel_t *handle,
@@ -187,14 +235,7 @@ lv_libssh2_channel_forward_accept(lv_libssh2_session_t *session,
     return lv_libssh2_status_from_result(
         libssh2_session_last_errno(session->inner));
   }
-  lv_libssh2_channel_t *channel = malloc(sizeof(lv_libssh2_channel_t));
-  if (channel == NULL) {
-    libssh2_channel_free(inner);
-    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
-  }
-  channel->inner = inner;
-  *handle = channel;
-  return LV_LIBSSH2_STATUS_OK;
+  return lv_libssh2_channel_wrap(session, inner, handle);
 }
 
 lv_libssh2_status_t
@@ -308,6 +349,75 @@ lv_libssh2_status_t lv_libssh2_channel_receive_window_adjust(
   return lv_libssh2_status_from_result(result);
 }
 
+void lv_libssh2_channel_autotune(lv_libssh2_channel_t *channel,
+                                 const size_t byte_count) {
+  if (channel->autotune_max == 0 || byte_count == 0) {
+    return;
+  }
+  uint32_t remaining =
+      libssh2_channel_window_read_ex(channel->inner, NULL, NULL);
+  if (remaining >= channel->autotune_window / AUTOTUNE_REFILL_DIVISOR) {
+    return;
+  }
+  /* A sender that nearly exhausted the window while the reader kept up was
+   * held back by the window rather than the link, so the bandwidth-delay
+   * product is larger than the window. Data still waiting to be read means
+   * the reader is the bottleneck instead, and a larger window would only
+   * buffer more of it. */
+  if (remaining < channel->autotune_window / AUTOTUNE_DRAINED_DIVISOR &&
+      !libssh2_poll_channel_read(channel->inner, 0)) {
+    uint32_t grown = channel->autotune_window * 2;
+    if (grown < channel->autotune_window || grown > channel->autotune_max) {
+      grown = channel->autotune_max;
+    }
+    channel->autotune_window = grown;
+  }
+  uint32_t adjustment = channel->autotune_window - remaining;
+  if (adjustment < LIBSSH2_CHANNEL_MINADJUST) {
+    return;
+  }
+  /* Failures, including LIBSSH2_ERROR_EAGAIN on a non-blocking channel, leave
+   * the adjustment to the next read. */
+  unsigned int window = 0;
+  libssh2_channel_receive_window_adjust2(channel->inner, adjustment, 0,
+                                         &window);
+}
+
+lv_libssh2_status_t
+lv_libssh2_channel_set_autotune(lv_libssh2_channel_t *handle,
+                                const uint32_t max_window) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  unsigned long initial = 0;
+  libssh2_channel_window_read_ex(handle->inner, NULL, &initial);
+  if (max_window != 0 && max_window < initial) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  handle->autotune_max = max_window;
+  handle->autotune_window = (uint32_t)initial;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_channel_autotune_window(lv_libssh2_channel_t *handle,
+                                   uint32_t *window) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (window == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->autotune_max == 0) {
+    unsigned long initial = 0;
+    libssh2_channel_window_read_ex(handle->inner, NULL, &initial);
+    *window = (uint32_t)initial;
+  } else {
+    *window = handle->autotune_window;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
 lv_libssh2_status_t lv_libssh2_channel_request_pty(lv_libssh2_channel_t *handle,
                                                    const char *terminal) {
   if (handle == NULL) {
@@ -430,6 +540,11 @@ lv_libssh2_status_t lv_libssh2_channel_write(lv_libssh2_channel_t *handle,
   if (byte_count == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (handle->queues != NULL &&
+      lv_libssh2_pump_write(handle, buffer, buffer_len, byte_count, &status)) {
+    return status;
+  }
   ssize_t result =
       libssh2_channel_write_ex(handle->inner, 0, buffer, buffer_len);
   if (result < 0) {
@@ -452,6 +567,9 @@ lv_libssh2_channel_write_stderr(lv_libssh2_channel_t *handle,
   if (byte_count == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  if (handle->queues != NULL && handle->queues->pump != NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
   ssize_t result = libssh2_channel_write_ex(
       handle->inner, SSH_EXTENDED_DATA_STDERR, buffer, buffer_len);
   if (result < 0) {
@@ -470,3 +588,160 @@ lv_libssh2_channel_request_x11(lv_libssh2_channel_t *handle,
   int result = libssh2_channel_x11_req(handle->inner, screen_number);
   return lv_libssh2_status_from_result(result);
 }
+
+static lv_libssh2_status_t
+lv_libssh2_channel_ring_start(lv_libssh2_channel_t *handle,
+                              lv_libssh2_ring_t **ring) {
+  if (handle->ring != NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  *ring = malloc(sizeof(lv_libssh2_ring_t));
+  if (*ring == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_channel_ring_create(lv_libssh2_channel_t *handle,
+                                                   const size_t capacity,
+                                                   uint8_t **buffer,
+                                                   size_t *buffer_len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer_len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_ring_t *ring = NULL;
+  lv_libssh2_status_t status = lv_libssh2_channel_ring_start(handle, &ring);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  status = lv_libssh2_ring_allocate(ring, capacity);
+  if (lv_libssh2_status_is_err(status)) {
+    free(ring);
+    return status;
+  }
+  handle->ring = ring;
+  *buffer = ring->data;
+  *buffer_len = ring->capacity;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_channel_ring_register(lv_libssh2_channel_t *handle, uint8_t *buffer,
+                                 const size_t buffer_len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer_len == 0) {
+    return LV_LIBSSH2_STATUS_ERROR_INVALID;
+  }
+  if (!lv_libssh2_ring_is_aligned(buffer)) {
+    return LV_LIBSSH2_STATUS_ERROR_INVALID;
+  }
+  lv_libssh2_ring_t *ring = NULL;
+  lv_libssh2_status_t status = lv_libssh2_channel_ring_start(handle, &ring);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_ring_attach(ring, buffer, buffer_len);
+  handle->ring = ring;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_channel_ring_destroy(lv_libssh2_channel_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->ring != NULL) {
+    lv_libssh2_ring_release(handle->ring);
+    free(handle->ring);
+    handle->ring = NULL;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_channel_ring_fill(lv_libssh2_channel_t *handle,
+                                                 size_t *byte_count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->ring == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  if (handle->queues != NULL && handle->queues->pump != NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  *byte_count = 0;
+  lv_libssh2_ring_t *ring = handle->ring;
+  for (;;) {
+    size_t offset = 0;
+    size_t len = 0;
+    lv_libssh2_ring_write_span(ring, &offset, &len);
+    if (len == 0) {
+      break;
+    }
+    ssize_t result = libssh2_channel_read_ex(
+        handle->inner, 0, (char *)ring->data + offset, len);
+    if (result < 0) {
+      if (*byte_count > 0 && result == LIBSSH2_ERROR_EAGAIN) {
+        break;
+      }
+      return lv_libssh2_status_from_result((int)result);
+    }
+    lv_libssh2_ring_produce(ring, (size_t)result);
+    *byte_count += (size_t)result;
+    /* Only keep reading what has already arrived, so a blocking channel
+     * waits for data at most once per fill. */
+    if (result == 0 || !libssh2_poll_channel_read(handle->inner, 0)) {
+      break;
+    }
+  }
+  lv_libssh2_channel_autotune(handle, *byte_count);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_channel_ring_span(lv_libssh2_channel_t *handle,
+                                                 size_t *offset, size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (offset == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->ring == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  lv_libssh2_ring_read_span(handle->ring, offset, len);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_channel_ring_commit(lv_libssh2_channel_t *handle,
+                               const size_t len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->ring == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  if (len > lv_libssh2_ring_used(handle->ring)) {
+    return LV_LIBSSH2_STATUS_ERROR_OUT_OF_BOUNDARY;
+  }
+  lv_libssh2_ring_consume(handle->ring, len);
+  return LV_LIBSSH2_STATUS_OK;
+}
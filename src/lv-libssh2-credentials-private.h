@@ -0,0 +1,70 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_CREDENTIALS_PRIVATE_H
+#define LV_LIBSSH2_CREDENTIALS_PRIVATE_H
+
+#include <stddef.h>
+
+#include "lv-libssh2.h"
+
+struct _lv_libssh2_credentials {
+  char *username;
+  char *password;
+  char *public_key_path;
+  char *private_key_path;
+  char *passphrase;
+};
+
+/**
+ * Allocates a copy of the credentials.
+ */
+lv_libssh2_status_t
+lv_libssh2_credentials_copy(const lv_libssh2_credentials_t *credentials,
+                            lv_libssh2_credentials_t **copy);
+
+/**
+ * Makes the next authentication call with the credentials, trying the key
+ * before the password. The `step` starts at zero and records the method to
+ * call next, so that a non-blocking session can call this again after
+ * ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN and pick up where it left off.
+ *
+ * Returns the status of the last method tried if the server rejects all of
+ * them, or ::LV_LIBSSH2_STATUS_ERROR_BAD_USE if none are set.
+ */
+lv_libssh2_status_t
+lv_libssh2_credentials_authenticate(lv_libssh2_credentials_t *credentials,
+                                    lv_libssh2_session_t *session,
+                                    size_t *step);
+
+#endif
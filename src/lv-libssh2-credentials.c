@@ -0,0 +1,206 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-credentials-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2.h"
+
+#define STEP_PUBLICKEY 0
+#define STEP_PASSWORD 1
+#define STEP_COUNT 2
+
+/* Replaces a copy of a string, where an empty string clears it. */
+static lv_libssh2_status_t lv_libssh2_credentials_set(char **field,
+                                                      const char *text) {
+  char *copy = NULL;
+  if (text != NULL && text[0] != '\0') {
+    size_t len = strlen(text) + 1;
+    copy = malloc(len);
+    if (copy == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    memcpy(copy, text, len);
+  }
+  free(*field);
+  *field = copy;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_credentials_create(const char *username,
+                              lv_libssh2_credentials_t **handle) {
+  *handle = NULL;
+  if (username == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_credentials_t *credentials =
+      calloc(1, sizeof(lv_libssh2_credentials_t));
+  if (credentials == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  lv_libssh2_status_t status =
+      lv_libssh2_credentials_set(&credentials->username, username);
+  if (lv_libssh2_status_is_err(status)) {
+    free(credentials);
+    return status;
+  }
+  if (credentials->username == NULL) {
+    free(credentials);
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  *handle = credentials;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_credentials_destroy(lv_libssh2_credentials_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  free(handle->username);
+  free(handle->password);
+  free(handle->public_key_path);
+  free(handle->private_key_path);
+  free(handle->passphrase);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_credentials_set_password(lv_libssh2_credentials_t *handle,
+                                    const char *password) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (password == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  return lv_libssh2_credentials_set(&handle->password, password);
+}
+
+lv_libssh2_status_t lv_libssh2_credentials_set_publickey_from_file(
+    lv_libssh2_credentials_t *handle, const char *public_key_path,
+    const char *private_key_path, const char *passphrase) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (public_key_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (private_key_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_status_t status =
+      lv_libssh2_credentials_set(&handle->public_key_path, public_key_path);
+  if (lv_libssh2_status_is_ok(status)) {
+    status =
+        lv_libssh2_credentials_set(&handle->private_key_path, private_key_path);
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_credentials_set(&handle->passphrase, passphrase);
+  }
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_credentials_copy(const lv_libssh2_credentials_t *credentials,
+                            lv_libssh2_credentials_t **copy) {
+  lv_libssh2_credentials_t *duplicate = NULL;
+  lv_libssh2_status_t status =
+      lv_libssh2_credentials_create(credentials->username, &duplicate);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  status = lv_libssh2_credentials_set(&duplicate->password,
+                                      credentials->password);
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_credentials_set(&duplicate->public_key_path,
+                                        credentials->public_key_path);
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_credentials_set(&duplicate->private_key_path,
+                                        credentials->private_key_path);
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_credentials_set(&duplicate->passphrase,
+                                        credentials->passphrase);
+  }
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_credentials_destroy(duplicate);
+    return status;
+  }
+  *copy = duplicate;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_credentials_authenticate(lv_libssh2_credentials_t *credentials,
+                                    lv_libssh2_session_t *session,
+                                    size_t *step) {
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  unsigned int username_len = (unsigned int)strlen(credentials->username);
+  for (; *step < STEP_COUNT; *step += 1) {
+    int result = 0;
+    if (*step == STEP_PUBLICKEY && credentials->private_key_path != NULL) {
+      result = libssh2_userauth_publickey_fromfile_ex(
+          session->inner, credentials->username, username_len,
+          credentials->public_key_path, credentials->private_key_path,
+          credentials->passphrase);
+    } else if (*step == STEP_PASSWORD && credentials->password != NULL) {
+      result = libssh2_userauth_password_ex(
+          session->inner, credentials->username, username_len,
+          credentials->password, (unsigned int)strlen(credentials->password),
+          NULL);
+    } else {
+      continue;
+    }
+    if (result == 0) {
+      return LV_LIBSSH2_STATUS_OK;
+    }
+    status = lv_libssh2_status_from_result(result);
+    /* Only a rejected method moves on to the next one. */
+    if (result != LIBSSH2_ERROR_AUTHENTICATION_FAILED &&
+        result != LIBSSH2_ERROR_PUBLICKEY_UNVERIFIED &&
+        result != LIBSSH2_ERROR_FILE) {
+      return status;
+    }
+  }
+  return status;
+}
@@ -0,0 +1,329 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-exec-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define INITIAL_CAPACITY 4096
+#define READ_SIZE 16384
+#define WAIT_PERIOD 100
+
+static lv_libssh2_status_t
+lv_libssh2_exec_buffer_reserve(lv_libssh2_exec_buffer_t *buffer,
+                               const size_t additional) {
+  if (buffer->capacity - buffer->len >= additional) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  size_t capacity = buffer->capacity == 0 ? INITIAL_CAPACITY : buffer->capacity;
+  while (capacity - buffer->len < additional) {
+    capacity *= 2;
+  }
+  uint8_t *data = realloc(buffer->data, capacity);
+  if (data == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  buffer->data = data;
+  buffer->capacity = capacity;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+/* Reads everything currently available on the stream without blocking. */
+static int lv_libssh2_exec_drain(LIBSSH2_CHANNEL *channel, const int stream,
+                                 lv_libssh2_exec_buffer_t *buffer) {
+  for (;;) {
+    if (lv_libssh2_status_is_err(
+            lv_libssh2_exec_buffer_reserve(buffer, READ_SIZE))) {
+      return LIBSSH2_ERROR_ALLOC;
+    }
+    ssize_t result = libssh2_channel_read_ex(
+        channel, stream, (char *)buffer->data + buffer->len, READ_SIZE);
+    if (result <= 0) {
+      return (int)result;
+    }
+    buffer->len += (size_t)result;
+  }
+}
+
+/* Waits for the session socket, or returns `false` if the deadline passed. */
+static bool lv_libssh2_exec_wait(lv_libssh2_session_t *session,
+                                 const uint64_t start, const int32_t timeout) {
+  uint32_t wait = WAIT_PERIOD;
+  if (timeout >= 0) {
+    uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+    if (elapsed >= (uint64_t)timeout) {
+      return false;
+    }
+    if ((uint64_t)timeout - elapsed < wait) {
+      wait = (uint32_t)((uint64_t)timeout - elapsed);
+    }
+  }
+  lv_libssh2_session_wait(session, wait);
+  return true;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_exec_run(lv_libssh2_session_t *session, const char *command,
+                    const uint64_t start, const int32_t timeout,
+                    lv_libssh2_exec_result_t *result,
+                    LIBSSH2_CHANNEL **opened) {
+  LIBSSH2_CHANNEL *channel = NULL;
+  for (;;) {
+    channel = libssh2_channel_open_session(session->inner);
+    if (channel != NULL) {
+      break;
+    }
+    int error = libssh2_session_last_errno(session->inner);
+    if (error != LIBSSH2_ERROR_EAGAIN) {
+      return lv_libssh2_status_from_result(error);
+    }
+    if (!lv_libssh2_exec_wait(session, start, timeout)) {
+      return LV_LIBSSH2_STATUS_ERROR_TIMEOUT;
+    }
+  }
+  *opened = channel;
+  int code = LIBSSH2_ERROR_EAGAIN;
+  while (code == LIBSSH2_ERROR_EAGAIN) {
+    code = libssh2_channel_exec(channel, command);
+    if (code == LIBSSH2_ERROR_EAGAIN &&
+        !lv_libssh2_exec_wait(session, start, timeout)) {
+      code = LIBSSH2_ERROR_TIMEOUT;
+    }
+  }
+  /* Both streams are drained on every pass, so neither can fill its window
+   * and stall the other while the command is still writing. */
+  while (code == 0) {
+    int out = lv_libssh2_exec_drain(channel, 0, &result->out);
+    int err =
+        lv_libssh2_exec_drain(channel, SSH_EXTENDED_DATA_STDERR, &result->err);
+    if (out < 0 && out != LIBSSH2_ERROR_EAGAIN) {
+      code = out;
+    } else if (err < 0 && err != LIBSSH2_ERROR_EAGAIN) {
+      code = err;
+    } else if (libssh2_channel_eof(channel)) {
+      break;
+    } else if (!lv_libssh2_exec_wait(session, start, timeout)) {
+      code = LIBSSH2_ERROR_TIMEOUT;
+    }
+  }
+  if (code == 0) {
+    code = LIBSSH2_ERROR_EAGAIN;
+  }
+  while (code == LIBSSH2_ERROR_EAGAIN) {
+    code = libssh2_channel_close(channel);
+    if (code == 0) {
+      code = libssh2_channel_wait_closed(channel);
+    }
+    if (code == LIBSSH2_ERROR_EAGAIN &&
+        !lv_libssh2_exec_wait(session, start, timeout)) {
+      code = LIBSSH2_ERROR_TIMEOUT;
+    }
+  }
+  if (code == 0) {
+    result->exit_code = libssh2_channel_get_exit_status(channel);
+    char *signal = NULL;
+    size_t signal_len = 0;
+    libssh2_channel_get_exit_signal(channel, &signal, &signal_len, NULL, NULL,
+                                    NULL, NULL);
+    if (signal != NULL) {
+      result->exit_signal = malloc(signal_len + 1);
+      if (result->exit_signal == NULL) {
+        code = LIBSSH2_ERROR_ALLOC;
+      } else {
+        memcpy(result->exit_signal, signal, signal_len);
+        result->exit_signal[signal_len] = '\0';
+      }
+      libssh2_free(session->inner, signal);
+    }
+  }
+  return lv_libssh2_status_from_result(code);
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_capture(lv_libssh2_session_t *session, const char *command,
+                        const int32_t timeout,
+                        lv_libssh2_exec_result_t **handle) {
+  *handle = NULL;
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (command == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_exec_result_t *result =
+      calloc(1, sizeof(lv_libssh2_exec_result_t));
+  if (result == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  const uint64_t start = lv_libssh2_time_now();
+  const int blocking = libssh2_session_get_blocking(session->inner);
+  libssh2_session_set_blocking(session->inner, 0);
+  LIBSSH2_CHANNEL *channel = NULL;
+  lv_libssh2_status_t status =
+      lv_libssh2_exec_run(session, command, start, timeout, result, &channel);
+  /* Freeing a channel that is still open waits for the server to close it,
+   * which a command that is still running never does, so the free is bounded
+   * by what is left of the timeout. A channel that is not freed by then is
+   * freed with the session. */
+  while (channel != NULL) {
+    int code = libssh2_channel_free(channel);
+    if (code != LIBSSH2_ERROR_EAGAIN ||
+        !lv_libssh2_exec_wait(session, start, timeout)) {
+      break;
+    }
+  }
+  libssh2_session_set_blocking(session->inner, blocking);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_exec_result_destroy(result);
+    return status;
+  }
+  *handle = result;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_destroy(lv_libssh2_exec_result_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  free(handle->out.data);
+  free(handle->err.data);
+  free(handle->exit_signal);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_stdout_len(lv_libssh2_exec_result_t *handle,
+                                  size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *len = handle->out.len;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_stdout(lv_libssh2_exec_result_t *handle,
+                              uint8_t *buffer) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->out.len > 0) {
+    memcpy(buffer, handle->out.data, handle->out.len);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_stderr_len(lv_libssh2_exec_result_t *handle,
+                                  size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *len = handle->err.len;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_stderr(lv_libssh2_exec_result_t *handle,
+                              uint8_t *buffer) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->err.len > 0) {
+    memcpy(buffer, handle->err.data, handle->err.len);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_exit_code(lv_libssh2_exec_result_t *handle,
+                                 int32_t *code) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (code == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *code = handle->exit_code;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_exit_signal_len(lv_libssh2_exec_result_t *handle,
+                                       size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *len = handle->exit_signal == NULL ? 0 : strlen(handle->exit_signal);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_exec_result_exit_signal(lv_libssh2_exec_result_t *handle,
+                                   char *buffer) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->exit_signal != NULL) {
+    memcpy(buffer, handle->exit_signal, strlen(handle->exit_signal));
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
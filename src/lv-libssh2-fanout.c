@@ -0,0 +1,386 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-credentials-private.h"
+#include "lv-libssh2-exec-private.h"
+#include "lv-libssh2-fanout-private.h"
+#include "lv-libssh2-knownhosts-store-private.h"
+#include "lv-libssh2-progress-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define DEFAULT_WORKER_COUNT 16
+#define MAX_WORKER_COUNT 256
+
+typedef struct _lv_libssh2_fanout_host {
+  const char *name;
+  int32_t port;
+  lv_libssh2_status_t status;
+  lv_libssh2_exec_result_t *result;
+  uint32_t elapsed;
+} lv_libssh2_fanout_host_t;
+
+typedef struct _lv_libssh2_fanout_job {
+  lv_libssh2_fanout_host_t *hosts;
+  size_t count;
+  lv_libssh2_credentials_t *credentials;
+  lv_libssh2_knownhosts_store_t *known_hosts;
+  const char *command;
+  int32_t timeout;
+  lv_libssh2_progress_t *progress;
+  lv_libssh2_atomic_t next;
+  lv_libssh2_atomic_t cancelled;
+  lv_libssh2_mutex_t mutex;
+  size_t done;
+} lv_libssh2_fanout_job_t;
+
+/* Gets what is left of the per-host timeout, returning `false` if none is.
+ * A negative timeout is passed through as waiting indefinitely. */
+static bool lv_libssh2_fanout_remaining(const int32_t timeout,
+                                        const uint64_t start,
+                                        int32_t *remaining) {
+  *remaining = timeout;
+  if (timeout < 0) {
+    return true;
+  }
+  uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+  if (elapsed >= (uint64_t)timeout) {
+    return false;
+  }
+  *remaining = (int32_t)((uint64_t)timeout - elapsed);
+  return true;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_fanout_authenticate(lv_libssh2_fanout_job_t *job,
+                               lv_libssh2_session_t *session,
+                               const uint64_t start) {
+  int32_t remaining = 0;
+  if (!lv_libssh2_fanout_remaining(job->timeout, start, &remaining)) {
+    return LV_LIBSSH2_STATUS_ERROR_TIMEOUT;
+  }
+  libssh2_session_set_blocking(session->inner, 1);
+  libssh2_session_set_timeout(session->inner, remaining < 0 ? 0 : remaining);
+  size_t step = 0;
+  lv_libssh2_status_t status =
+      lv_libssh2_credentials_authenticate(job->credentials, session, &step);
+  libssh2_session_set_timeout(session->inner, 0);
+  return status;
+}
+
+/* Connects, verifies, authenticates, and runs the command on one host, all
+ * within the timeout. */
+static void lv_libssh2_fanout_run(lv_libssh2_fanout_job_t *job,
+                                  lv_libssh2_fanout_host_t *host) {
+  const uint64_t start = lv_libssh2_time_now();
+  lv_libssh2_session_t *session = NULL;
+  lv_libssh2_status_t status = lv_libssh2_session_create(&session);
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_session_connect_host(session, host->name, host->port,
+                                             job->timeout, 0);
+  }
+  bool connected = lv_libssh2_status_is_ok(status);
+  if (lv_libssh2_status_is_ok(status) && job->known_hosts != NULL) {
+    status = lv_libssh2_knownhosts_store_verify(job->known_hosts, session,
+                                                host->name, host->port);
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_fanout_authenticate(job, session, start);
+  }
+  int32_t remaining = 0;
+  if (lv_libssh2_status_is_ok(status) &&
+      !lv_libssh2_fanout_remaining(job->timeout, start, &remaining)) {
+    status = LV_LIBSSH2_STATUS_ERROR_TIMEOUT;
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_exec_capture(session, job->command, remaining,
+                                     &host->result);
+  }
+  if (connected) {
+    lv_libssh2_session_disconnect(session, "Command complete");
+  }
+  if (session != NULL) {
+    lv_libssh2_session_destroy(session);
+  }
+  host->status = status;
+  uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+  host->elapsed = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+}
+
+static void lv_libssh2_fanout_work(void *context) {
+  lv_libssh2_fanout_job_t *job = context;
+  for (;;) {
+    int64_t next = lv_libssh2_atomic_add(&job->next, 1) - 1;
+    if ((uint64_t)next >= job->count) {
+      break;
+    }
+    lv_libssh2_fanout_host_t *host = &job->hosts[next];
+    if (lv_libssh2_atomic_load(&job->cancelled) != 0) {
+      host->status = LV_LIBSSH2_STATUS_ERROR_CANCELLED;
+      continue;
+    }
+    lv_libssh2_fanout_run(job, host);
+    lv_libssh2_mutex_lock(&job->mutex);
+    job->done += 1;
+    if (!lv_libssh2_progress_update(job->progress, job->done)) {
+      lv_libssh2_atomic_add(&job->cancelled, 1);
+    }
+    lv_libssh2_mutex_unlock(&job->mutex);
+  }
+}
+
+/* Packs the records and output of every host, in the order of the hosts. */
+static lv_libssh2_status_t
+lv_libssh2_fanout_collect(lv_libssh2_fanout_job_t *job,
+                          lv_libssh2_fanout_result_t **handle) {
+  lv_libssh2_fanout_result_t *fanout =
+      calloc(1, sizeof(lv_libssh2_fanout_result_t));
+  if (fanout == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  fanout->count = job->count;
+  fanout->records = calloc(job->count + 1, sizeof(lv_libssh2_fanout_record_t));
+  if (fanout->records == NULL) {
+    free(fanout);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  for (size_t i = 0; i < job->count; i++) {
+    lv_libssh2_fanout_host_t *host = &job->hosts[i];
+    lv_libssh2_fanout_record_t *record = &fanout->records[i];
+    record->output_offset = fanout->output_len;
+    record->status = (int32_t)host->status;
+    record->elapsed = host->elapsed;
+    if (host->result == NULL) {
+      continue;
+    }
+    /* The lengths are 32-bit, so anything beyond 4 GiB per stream is
+     * dropped. */
+    const char *signal = host->result->exit_signal;
+    size_t signal_len = signal == NULL ? 0 : strlen(signal);
+    record->stdout_len = host->result->out.len > UINT32_MAX
+                             ? UINT32_MAX
+                             : (uint32_t)host->result->out.len;
+    record->stderr_len = host->result->err.len > UINT32_MAX
+                             ? UINT32_MAX
+                             : (uint32_t)host->result->err.len;
+    record->exit_signal_len = (uint32_t)signal_len;
+    record->exit_code = host->result->exit_code;
+    fanout->output_len += (size_t)record->stdout_len + record->stderr_len +
+                          record->exit_signal_len;
+  }
+  fanout->output = malloc(fanout->output_len + 1);
+  if (fanout->output == NULL) {
+    free(fanout->records);
+    free(fanout);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  for (size_t i = 0; i < job->count; i++) {
+    lv_libssh2_exec_result_t *result = job->hosts[i].result;
+    lv_libssh2_fanout_record_t *record = &fanout->records[i];
+    if (result == NULL) {
+      continue;
+    }
+    uint8_t *output = fanout->output + record->output_offset;
+    memcpy(output, result->out.data, record->stdout_len);
+    output += record->stdout_len;
+    memcpy(output, result->err.data, record->stderr_len);
+    output += record->stderr_len;
+    memcpy(output, result->exit_signal, record->exit_signal_len);
+  }
+  *handle = fanout;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_fanout_exec(
+    const char *hosts, const size_t hosts_len, const int32_t *ports,
+    const size_t count, lv_libssh2_credentials_t *credentials,
+    lv_libssh2_knownhosts_store_t *known_hosts, const char *command,
+    const int32_t timeout, const size_t workers,
+    lv_libssh2_progress_t *progress, lv_libssh2_fanout_result_t **handle) {
+  *handle = NULL;
+  if (hosts == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (ports == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (credentials == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (command == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_fanout_job_t job;
+  memset(&job, 0, sizeof(lv_libssh2_fanout_job_t));
+  job.hosts = calloc(count + 1, sizeof(lv_libssh2_fanout_host_t));
+  if (job.hosts == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  /* Every host name must be terminated inside the buffer. */
+  size_t offset = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *end = offset < hosts_len
+                          ? memchr(hosts + offset, '\0', hosts_len - offset)
+                          : NULL;
+    if (end == NULL) {
+      free(job.hosts);
+      return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+    }
+    job.hosts[i].name = hosts + offset;
+    job.hosts[i].port = ports[i];
+    offset = (size_t)(end - hosts) + 1;
+  }
+  job.count = count;
+  job.credentials = credentials;
+  job.known_hosts = known_hosts;
+  job.command = command;
+  job.timeout = timeout;
+  job.progress = progress;
+  lv_libssh2_mutex_init(&job.mutex);
+  lv_libssh2_progress_start(progress, count);
+  size_t wanted = workers == 0 ? DEFAULT_WORKER_COUNT : workers;
+  if (wanted > MAX_WORKER_COUNT) {
+    wanted = MAX_WORKER_COUNT;
+  }
+  if (wanted > count) {
+    wanted = count;
+  }
+  /* The calling thread is one of the workers. */
+  lv_libssh2_thread_t threads[MAX_WORKER_COUNT];
+  size_t started = 0;
+  while (started + 1 < wanted &&
+         lv_libssh2_status_is_ok(lv_libssh2_thread_start(
+             &threads[started], lv_libssh2_fanout_work, &job))) {
+    started++;
+  }
+  lv_libssh2_fanout_work(&job);
+  for (size_t i = 0; i < started; i++) {
+    lv_libssh2_thread_join(threads[i]);
+  }
+  lv_libssh2_mutex_destroy(&job.mutex);
+  lv_libssh2_status_t status = lv_libssh2_fanout_collect(&job, handle);
+  for (size_t i = 0; i < count; i++) {
+    if (job.hosts[i].result != NULL) {
+      lv_libssh2_exec_result_destroy(job.hosts[i].result);
+    }
+  }
+  free(job.hosts);
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_fanout_result_destroy(lv_libssh2_fanout_result_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  free(handle->records);
+  free(handle->output);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_fanout_result_count(lv_libssh2_fanout_result_t *handle,
+                               size_t *count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *count = handle->count;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_fanout_result_records_len(lv_libssh2_fanout_result_t *handle,
+                                     size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *len = handle->count * sizeof(lv_libssh2_fanout_record_t);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_fanout_result_records(lv_libssh2_fanout_result_t *handle,
+                                 uint8_t *buffer) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  memcpy(buffer, handle->records,
+         handle->count * sizeof(lv_libssh2_fanout_record_t));
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_fanout_result_output_len(lv_libssh2_fanout_result_t *handle,
+                                    size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *len = handle->output_len;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_fanout_result_output(lv_libssh2_fanout_result_t *handle,
+                                uint8_t *buffer) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  memcpy(buffer, handle->output, handle->output_len);
+  return LV_LIBSSH2_STATUS_OK;
+}
@@ -0,0 +1,176 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_KNOWNHOSTS_INDEX_PRIVATE_H
+#define LV_LIBSSH2_KNOWNHOSTS_INDEX_PRIVATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+#define LV_LIBSSH2_KNOWNHOSTS_INDEX_DIGEST_LEN 20
+#define LV_LIBSSH2_KNOWNHOSTS_INDEX_SALT_MAX 64
+
+/* A plain host name, or a host name resolved from a hashed entry, and the
+ * base64-encoded key that goes with it. */
+typedef struct _lv_libssh2_knownhosts_index_name {
+  struct _lv_libssh2_knownhosts_index_name *next;
+  uint32_t hash;
+  char *name;
+  const char *key;
+} lv_libssh2_knownhosts_index_name_t;
+
+typedef struct _lv_libssh2_knownhosts_index_table {
+  lv_libssh2_knownhosts_index_name_t **buckets;
+  size_t bucket_count;
+  size_t count;
+} lv_libssh2_knownhosts_index_table_t;
+
+/* A hashed host name, which is the HMAC-SHA1 of the name keyed with the
+ * salt of its group. */
+typedef struct _lv_libssh2_knownhosts_index_hashed {
+  struct _lv_libssh2_knownhosts_index_hashed *next;
+  size_t group;
+  uint8_t digest[LV_LIBSSH2_KNOWNHOSTS_INDEX_DIGEST_LEN];
+  const char *key;
+} lv_libssh2_knownhosts_index_hashed_t;
+
+typedef struct _lv_libssh2_knownhosts_index_group {
+  uint8_t salt[LV_LIBSSH2_KNOWNHOSTS_INDEX_SALT_MAX];
+  size_t salt_len;
+} lv_libssh2_knownhosts_index_group_t;
+
+/* The keys found among the hashed entries for a host name, or none if it
+ * is not there. An entry does not change once it is in the memo. */
+typedef struct _lv_libssh2_knownhosts_index_memo {
+  struct _lv_libssh2_knownhosts_index_memo *next;
+  uint32_t hash;
+  size_t key_count;
+  const char **keys;
+  char *name;
+} lv_libssh2_knownhosts_index_memo_t;
+
+struct _lv_libssh2_knownhosts_index {
+  lv_libssh2_knownhosts_index_table_t names;
+  char **keys;
+  size_t key_count;
+  size_t key_capacity;
+  lv_libssh2_knownhosts_index_group_t *groups;
+  size_t group_count;
+  size_t group_capacity;
+  size_t *salt_slots;
+  size_t salt_slot_count;
+  lv_libssh2_knownhosts_index_hashed_t **digests;
+  size_t digest_bucket_count;
+  size_t hashed_count;
+  /* The buckets of memo entries, allocated by the first hashed lookup.
+   * Entries are only ever pushed onto a bucket with a compare-and-swap and
+   * freed with the index, so lookups never lock. */
+  void *volatile memo;
+  lv_libssh2_atomic_t memo_count;
+};
+
+/**
+ * The hosts and keys of a check of many hosts, with the keys encoded once up
+ * front so that the lookups can run on several threads.
+ */
+typedef struct _lv_libssh2_knownhosts_index_batch {
+  const char **hosts;
+  const int *ports;
+  char **keys;
+  size_t count;
+  lv_libssh2_knownhosts_check_results_t *results;
+  lv_libssh2_knownhosts_index_t *index;
+  lv_libssh2_atomic_t next;
+} lv_libssh2_knownhosts_index_batch_t;
+
+/**
+ * Initializes an empty index.
+ */
+void lv_libssh2_knownhosts_index_init(lv_libssh2_knownhosts_index_t *index);
+
+/**
+ * Frees everything the index holds, but not the index itself.
+ */
+void lv_libssh2_knownhosts_index_free(lv_libssh2_knownhosts_index_t *index);
+
+/**
+ * Adds the entries of one line in the OpenSSH known_hosts format. Blank
+ * lines, comments, marked lines, and RSA1 keys are skipped.
+ */
+lv_libssh2_status_t
+lv_libssh2_knownhosts_index_add_line(lv_libssh2_knownhosts_index_t *index,
+                                     const char *line, const size_t len);
+
+/**
+ * Allocates a NUL-terminated, base64-encoded copy of a host key.
+ */
+lv_libssh2_status_t lv_libssh2_knownhosts_index_encode_key(
+    const uint8_t *key, const size_t key_len,
+    const lv_libssh2_knownhost_key_encodings_t encoding, char **encoded);
+
+/**
+ * Checks a host and base64-encoded key the same way as
+ * `libssh2_knownhost_checkp` with a plain host name, ignoring the key type.
+ */
+void lv_libssh2_knownhosts_index_lookup(
+    lv_libssh2_knownhosts_index_t *index, const char *host, const int port,
+    const char *key, lv_libssh2_knownhosts_check_results_t *result);
+
+/**
+ * Splits the `hosts` buffer of NUL-terminated names and the `keys` buffer
+ * of keys back to back into a batch, returning
+ * ::LV_LIBSSH2_STATUS_ERROR_BAD_USE if either buffer is too short.
+ */
+lv_libssh2_status_t lv_libssh2_knownhosts_index_batch_init(
+    lv_libssh2_knownhosts_index_batch_t *batch, const char *hosts,
+    const size_t hosts_len, const int *ports, const uint8_t *keys,
+    const size_t keys_len, const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding,
+    lv_libssh2_knownhosts_check_results_t *results);
+
+/**
+ * Looks up every host of the batch in the index. The lookups are shared
+ * between the calling thread and up to `threads - 1` other threads, where
+ * zero is the default of 4, but only if the index has hashed entries.
+ */
+void lv_libssh2_knownhosts_index_batch_run(
+    lv_libssh2_knownhosts_index_batch_t *batch,
+    lv_libssh2_knownhosts_index_t *index, const size_t threads);
+
+void lv_libssh2_knownhosts_index_batch_free(
+    lv_libssh2_knownhosts_index_batch_t *batch);
+
+#endif
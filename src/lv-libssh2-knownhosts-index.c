@@ -0,0 +1,885 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-knownhosts-index-private.h"
+#include "lv-libssh2-knownhosts-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+#define MIN_BUCKET_COUNT 1024
+#define MIN_LINE_LEN 1024
+#define MAX_MEMO_ENTRIES 65536
+#define MEMO_BUCKET_COUNT 4096
+#define MAX_MEMO_KEYS 16
+#define DEFAULT_THREAD_COUNT 4
+#define MAX_THREAD_COUNT 32
+/* Long enough for `[` + a 255 character host name + `]:65535`. */
+#define MAX_CANDIDATE_LEN 272
+#define HASHED_PREFIX "|1|"
+
+static uint32_t lv_libssh2_knownhosts_index_hash(const void *data,
+                                                 const size_t len) {
+  const uint8_t *bytes = data;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/* Decodes base64 text into a buffer, returning `false` if the text is not
+ * valid or does not fit. */
+static bool lv_libssh2_knownhosts_index_decode(const char *text,
+                                               const size_t text_len,
+                                               uint8_t *data,
+                                               const size_t capacity,
+                                               size_t *data_len) {
+  if (text_len == 0 || text_len % 4 != 0 || text_len / 4 * 3 > capacity) {
+    return false;
+  }
+  int len = EVP_DecodeBlock(data, (const unsigned char *)text, (int)text_len);
+  if (len < 0) {
+    return false;
+  }
+  /* The decoded length includes the padding, so it is taken back off. */
+  if (text[text_len - 1] == '=') {
+    len -= 1;
+  }
+  if (text[text_len - 2] == '=') {
+    len -= 1;
+  }
+  *data_len = (size_t)len;
+  return true;
+}
+
+static void lv_libssh2_knownhosts_index_table_clear(
+    lv_libssh2_knownhosts_index_table_t *table) {
+  for (size_t i = 0; i < table->bucket_count; i++) {
+    lv_libssh2_knownhosts_index_name_t *entry = table->buckets[i];
+    while (entry != NULL) {
+      lv_libssh2_knownhosts_index_name_t *next = entry->next;
+      free(entry->name);
+      free(entry);
+      entry = next;
+    }
+    table->buckets[i] = NULL;
+  }
+  table->count = 0;
+}
+
+static lv_libssh2_status_t lv_libssh2_knownhosts_index_table_insert(
+    lv_libssh2_knownhosts_index_table_t *table, const char *name,
+    const size_t len, const char *key) {
+  if (table->count >= table->bucket_count) {
+    size_t bucket_count = table->bucket_count == 0 ? MIN_BUCKET_COUNT
+                                                   : table->bucket_count * 2;
+    lv_libssh2_knownhosts_index_name_t **buckets =
+        calloc(bucket_count, sizeof(lv_libssh2_knownhosts_index_name_t *));
+    if (buckets == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    for (size_t i = 0; i < table->bucket_count; i++) {
+      lv_libssh2_knownhosts_index_name_t *entry = table->buckets[i];
+      while (entry != NULL) {
+        lv_libssh2_knownhosts_index_name_t *next = entry->next;
+        size_t bucket = entry->hash & (bucket_count - 1);
+        entry->next = buckets[bucket];
+        buckets[bucket] = entry;
+        entry = next;
+      }
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucket_count = bucket_count;
+  }
+  lv_libssh2_knownhosts_index_name_t *entry =
+      malloc(sizeof(lv_libssh2_knownhosts_index_name_t));
+  if (entry == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  entry->name = malloc(len + 1);
+  if (entry->name == NULL) {
+    free(entry);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  memcpy(entry->name, name, len);
+  entry->name[len] = '\0';
+  entry->hash = lv_libssh2_knownhosts_index_hash(name, len);
+  entry->key = key;
+  size_t bucket = entry->hash & (table->bucket_count - 1);
+  entry->next = table->buckets[bucket];
+  table->buckets[bucket] = entry;
+  table->count += 1;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+/* Returns the first entry in the bucket for the name. Entries with other
+ * names can follow it, so callers still compare names. */
+static lv_libssh2_knownhosts_index_name_t *
+lv_libssh2_knownhosts_index_table_bucket(
+    const lv_libssh2_knownhosts_index_table_t *table, const char *name,
+    uint32_t *hash) {
+  *hash = lv_libssh2_knownhosts_index_hash(name, strlen(name));
+  if (table->bucket_count == 0) {
+    return NULL;
+  }
+  return table->buckets[*hash & (table->bucket_count - 1)];
+}
+
+/* Keeps a copy of the key for the entries of one line to point at. */
+static lv_libssh2_status_t
+lv_libssh2_knownhosts_index_add_key(lv_libssh2_knownhosts_index_t *index,
+                                    const char *key, const size_t len,
+                                    const char **copy) {
+  if (index->key_count == index->key_capacity) {
+    size_t capacity =
+        index->key_capacity == 0 ? MIN_BUCKET_COUNT : index->key_capacity * 2;
+    char **keys = realloc(index->keys, capacity * sizeof(char *));
+    if (keys == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    index->keys = keys;
+    index->key_capacity = capacity;
+  }
+  char *key_copy = malloc(len + 1);
+  if (key_copy == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  memcpy(key_copy, key, len);
+  key_copy[len] = '\0';
+  index->keys[index->key_count] = key_copy;
+  index->key_count += 1;
+  *copy = key_copy;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+/* Finds the group for a salt, adding one if it is new. The salts are kept in
+ * an open-addressed table of group numbers that is only used while
+ * building. */
+static lv_libssh2_status_t
+lv_libssh2_knownhosts_index_find_group(lv_libssh2_knownhosts_index_t *index,
+                                       const uint8_t *salt,
+                                       const size_t salt_len, size_t *group) {
+  if ((index->group_count + 1) * 2 > index->salt_slot_count) {
+    size_t slot_count = index->salt_slot_count == 0
+                            ? MIN_BUCKET_COUNT
+                            : index->salt_slot_count * 2;
+    size_t *slots = malloc(slot_count * sizeof(size_t));
+    if (slots == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    for (size_t i = 0; i < slot_count; i++) {
+      slots[i] = SIZE_MAX;
+    }
+    for (size_t i = 0; i < index->group_count; i++) {
+      lv_libssh2_knownhosts_index_group_t *existing = &index->groups[i];
+      size_t slot =
+          lv_libssh2_knownhosts_index_hash(existing->salt,
+                                           existing->salt_len) &
+          (slot_count - 1);
+      while (slots[slot] != SIZE_MAX) {
+        slot = (slot + 1) & (slot_count - 1);
+      }
+      slots[slot] = i;
+    }
+    free(index->salt_slots);
+    index->salt_slots = slots;
+    index->salt_slot_count = slot_count;
+  }
+  size_t slot = lv_libssh2_knownhosts_index_hash(salt, salt_len) &
+                (index->salt_slot_count - 1);
+  while (index->salt_slots[slot] != SIZE_MAX) {
+    lv_libssh2_knownhosts_index_group_t *existing =
+        &index->groups[index->salt_slots[slot]];
+    if (existing->salt_len == salt_len &&
+        memcmp(existing->salt, salt, salt_len) == 0) {
+      *group = index->salt_slots[slot];
+      return LV_LIBSSH2_STATUS_OK;
+    }
+    slot = (slot + 1) & (index->salt_slot_count - 1);
+  }
+  if (index->group_count == index->group_capacity) {
+    size_t capacity = index->group_capacity == 0 ? MIN_BUCKET_COUNT
+                                                 : index->group_capacity * 2;
+    lv_libssh2_knownhosts_index_group_t *groups = realloc(
+        index->groups, capacity * sizeof(lv_libssh2_knownhosts_index_group_t));
+    if (groups == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    index->groups = groups;
+    index->group_capacity = capacity;
+  }
+  memcpy(index->groups[index->group_count].salt, salt, salt_len);
+  index->groups[index->group_count].salt_len = salt_len;
+  index->salt_slots[slot] = index->group_count;
+  *group = index->group_count;
+  index->group_count += 1;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static uint32_t lv_libssh2_knownhosts_index_digest_hash(const uint8_t *digest) {
+  uint32_t hash = 0;
+  memcpy(&hash, digest, sizeof(hash));
+  return hash;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_knownhosts_index_add_hashed(lv_libssh2_knownhosts_index_t *index,
+                                       const char *pattern, const size_t len,
+                                       const char *key) {
+  const char *salt_text = pattern + strlen(HASHED_PREFIX);
+  const char *end = pattern + len;
+  const char *separator = memchr(salt_text, '|', (size_t)(end - salt_text));
+  if (separator == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_KNOWN_HOSTS;
+  }
+  uint8_t salt[LV_LIBSSH2_KNOWNHOSTS_INDEX_SALT_MAX];
+  size_t salt_len = 0;
+  uint8_t digest[LV_LIBSSH2_KNOWNHOSTS_INDEX_SALT_MAX];
+  size_t digest_len = 0;
+  if (!lv_libssh2_knownhosts_index_decode(
+          salt_text, (size_t)(separator - salt_text), salt, sizeof(salt),
+          &salt_len) ||
+      !lv_libssh2_knownhosts_index_decode(
+          separator + 1, (size_t)(end - separator - 1), digest,
+          sizeof(digest), &digest_len) ||
+      digest_len != LV_LIBSSH2_KNOWNHOSTS_INDEX_DIGEST_LEN) {
+    return LV_LIBSSH2_STATUS_ERROR_KNOWN_HOSTS;
+  }
+  size_t group = 0;
+  lv_libssh2_status_t status =
+      lv_libssh2_knownhosts_index_find_group(index, salt, salt_len, &group);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  if (index->hashed_count >= index->digest_bucket_count) {
+    size_t bucket_count = index->digest_bucket_count == 0
+                              ? MIN_BUCKET_COUNT
+                              : index->digest_bucket_count * 2;
+    lv_libssh2_knownhosts_index_hashed_t **buckets =
+        calloc(bucket_count, sizeof(lv_libssh2_knownhosts_index_hashed_t *));
+    if (buckets == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    for (size_t i = 0; i < index->digest_bucket_count; i++) {
+      lv_libssh2_knownhosts_index_hashed_t *entry = index->digests[i];
+      while (entry != NULL) {
+        lv_libssh2_knownhosts_index_hashed_t *next = entry->next;
+        size_t bucket =
+            lv_libssh2_knownhosts_index_digest_hash(entry->digest) &
+            (bucket_count - 1);
+        entry->next = buckets[bucket];
+        buckets[bucket] = entry;
+        entry = next;
+      }
+    }
+    free(index->digests);
+    index->digests = buckets;
+    index->digest_bucket_count = bucket_count;
+  }
+  lv_libssh2_knownhosts_index_hashed_t *entry =
+      malloc(sizeof(lv_libssh2_knownhosts_index_hashed_t));
+  if (entry == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  entry->group = group;
+  memcpy(entry->digest, digest, LV_LIBSSH2_KNOWNHOSTS_INDEX_DIGEST_LEN);
+  entry->key = key;
+  size_t bucket = lv_libssh2_knownhosts_index_digest_hash(digest) &
+                  (index->digest_bucket_count - 1);
+  entry->next = index->digests[bucket];
+  index->digests[bucket] = entry;
+  index->hashed_count += 1;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+void lv_libssh2_knownhosts_index_init(lv_libssh2_knownhosts_index_t *index) {
+  memset(index, 0, sizeof(lv_libssh2_knownhosts_index_t));
+}
+
+void lv_libssh2_knownhosts_index_free(lv_libssh2_knownhosts_index_t *index) {
+  lv_libssh2_knownhosts_index_table_clear(&index->names);
+  free(index->names.buckets);
+  lv_libssh2_knownhosts_index_memo_t **memo = index->memo;
+  if (memo != NULL) {
+    for (size_t i = 0; i < MEMO_BUCKET_COUNT; i++) {
+      lv_libssh2_knownhosts_index_memo_t *entry = memo[i];
+      while (entry != NULL) {
+        lv_libssh2_knownhosts_index_memo_t *next = entry->next;
+        free(entry);
+        entry = next;
+      }
+    }
+    free(memo);
+  }
+  for (size_t i = 0; i < index->digest_bucket_count; i++) {
+    lv_libssh2_knownhosts_index_hashed_t *entry = index->digests[i];
+    while (entry != NULL) {
+      lv_libssh2_knownhosts_index_hashed_t *next = entry->next;
+      free(entry);
+      entry = next;
+    }
+  }
+  free(index->digests);
+  for (size_t i = 0; i < index->key_count; i++) {
+    free(index->keys[i]);
+  }
+  free(index->keys);
+  free(index->groups);
+  free(index->salt_slots);
+}
+
+lv_libssh2_status_t
+lv_libssh2_knownhosts_index_add_line(lv_libssh2_knownhosts_index_t *index,
+                                     const char *line, const size_t len) {
+  const char *end = line + len;
+  const char *fields[3];
+  size_t field_lens[3];
+  size_t field_count = 0;
+  const char *cursor = line;
+  while (field_count < 3) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+      cursor++;
+    }
+    if (cursor == end || *cursor == '\r' || *cursor == '\n') {
+      break;
+    }
+    if (field_count == 0 && (*cursor == '#' || *cursor == '@')) {
+      return LV_LIBSSH2_STATUS_OK;
+    }
+    fields[field_count] = cursor;
+    while (cursor < end && *cursor != ' ' && *cursor != '\t' &&
+           *cursor != '\r' && *cursor != '\n') {
+      cursor++;
+    }
+    field_lens[field_count] = (size_t)(cursor - fields[field_count]);
+    field_count++;
+  }
+  if (field_count == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  if (field_count < 3) {
+    return LV_LIBSSH2_STATUS_ERROR_KNOWN_HOSTS;
+  }
+  /* An RSA1 key starts with its size in bits instead of a key type. */
+  if (fields[1][0] >= '0' && fields[1][0] <= '9') {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  const char *key = NULL;
+  lv_libssh2_status_t status = lv_libssh2_knownhosts_index_add_key(
+      index, fields[2], field_lens[2], &key);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  const char *hosts_end = fields[0] + field_lens[0];
+  const char *pattern = fields[0];
+  while (pattern < hosts_end) {
+    const char *pattern_end =
+        memchr(pattern, ',', (size_t)(hosts_end - pattern));
+    if (pattern_end == NULL) {
+      pattern_end = hosts_end;
+    }
+    size_t pattern_len = (size_t)(pattern_end - pattern);
+    if (pattern_len > strlen(HASHED_PREFIX) &&
+        memcmp(pattern, HASHED_PREFIX, strlen(HASHED_PREFIX)) == 0) {
+      status = lv_libssh2_knownhosts_index_add_hashed(index, pattern,
+                                                      pattern_len, key);
+    } else if (pattern_len > 0) {
+      status = lv_libssh2_knownhosts_index_table_insert(&index->names, pattern,
+                                                        pattern_len, key);
+    }
+    if (lv_libssh2_status_is_err(status)) {
+      return status;
+    }
+    pattern = pattern_end + 1;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_index_encode_key(
+    const uint8_t *key, const size_t key_len,
+    const lv_libssh2_knownhost_key_encodings_t encoding, char **encoded) {
+  *encoded = NULL;
+  char *text = NULL;
+  switch (encoding) {
+  case LV_LIBSSH2_KNOWNHOST_KEY_ENCODING_RAW:
+    text = malloc((key_len + 2) / 3 * 4 + 1);
+    if (text == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    EVP_EncodeBlock((unsigned char *)text, key, (int)key_len);
+    break;
+  case LV_LIBSSH2_KNOWNHOST_KEY_ENCODING_BASE64:
+    text = malloc(key_len + 1);
+    if (text == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    memcpy(text, key, key_len);
+    text[key_len] = '\0';
+    break;
+  default:
+    return LV_LIBSSH2_STATUS_ERROR_UNKNOWN_KEY_ENCODING;
+  }
+  *encoded = text;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static void lv_libssh2_knownhosts_index_compare(
+    const char *known_key, const char *key,
+    lv_libssh2_knownhosts_check_results_t *result) {
+  if (strcmp(known_key, key) == 0) {
+    *result = LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH;
+  } else if (*result != LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH) {
+    *result = LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MISMATCH;
+  }
+}
+
+/* Compares the key with the memoized entries for the name, returning
+ * `false` if the name has not been resolved against the hashed entries
+ * yet. */
+static bool lv_libssh2_knownhosts_index_match_memo(
+    lv_libssh2_knownhosts_index_t *index, const char *name, const char *key,
+    lv_libssh2_knownhosts_check_results_t *result) {
+  lv_libssh2_knownhosts_index_memo_t **memo =
+      lv_libssh2_atomic_load_pointer(&index->memo);
+  if (memo == NULL) {
+    return false;
+  }
+  uint32_t hash = lv_libssh2_knownhosts_index_hash(name, strlen(name));
+  lv_libssh2_knownhosts_index_memo_t *entry = lv_libssh2_atomic_load_pointer(
+      (void *volatile *)&memo[hash & (MEMO_BUCKET_COUNT - 1)]);
+  for (; entry != NULL; entry = entry->next) {
+    if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+      for (size_t i = 0; i < entry->key_count; i++) {
+        lv_libssh2_knownhosts_index_compare(entry->keys[i], key, result);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Records the keys found for a name among the hashed entries, including
+ * none, so misses are remembered too. Once the memo is full, names are no
+ * longer added, since entries cannot be removed while other threads might
+ * be reading them. Two threads that resolve the same name both add it,
+ * which is harmless because the entries are the same. */
+static void lv_libssh2_knownhosts_index_store_memo(
+    lv_libssh2_knownhosts_index_t *index, const char *name,
+    const char **keys, const size_t key_count) {
+  if (lv_libssh2_atomic_load(&index->memo_count) >= MAX_MEMO_ENTRIES) {
+    return;
+  }
+  lv_libssh2_knownhosts_index_memo_t **memo =
+      lv_libssh2_atomic_load_pointer(&index->memo);
+  if (memo == NULL) {
+    memo = calloc(MEMO_BUCKET_COUNT, sizeof(*memo));
+    if (memo == NULL) {
+      return;
+    }
+    if (!lv_libssh2_atomic_compare_exchange_pointer(&index->memo, NULL,
+                                                    memo)) {
+      free(memo);
+      memo = lv_libssh2_atomic_load_pointer(&index->memo);
+    }
+  }
+  size_t len = strlen(name);
+  lv_libssh2_knownhosts_index_memo_t *entry =
+      malloc(sizeof(lv_libssh2_knownhosts_index_memo_t) +
+             key_count * sizeof(const char *) + len + 1);
+  if (entry == NULL) {
+    return;
+  }
+  entry->hash = lv_libssh2_knownhosts_index_hash(name, len);
+  entry->key_count = key_count;
+  entry->keys = (const char **)(entry + 1);
+  entry->name = (char *)(entry->keys + key_count);
+  memcpy(entry->keys, keys, key_count * sizeof(const char *));
+  memcpy(entry->name, name, len + 1);
+  void *volatile *bucket =
+      (void *volatile *)&memo[entry->hash & (MEMO_BUCKET_COUNT - 1)];
+  do {
+    entry->next = lv_libssh2_atomic_load_pointer(bucket);
+  } while (!lv_libssh2_atomic_compare_exchange_pointer(bucket, entry->next,
+                                                       entry));
+  lv_libssh2_atomic_add(&index->memo_count, 1);
+}
+
+/* Hashes the name once with the salt of each group and looks the digest up
+ * among the hashed entries. */
+static void lv_libssh2_knownhosts_index_match_hashed(
+    lv_libssh2_knownhosts_index_t *index, const char *name, const char *key,
+    lv_libssh2_knownhosts_check_results_t *result) {
+  if (index->hashed_count == 0) {
+    return;
+  }
+  if (lv_libssh2_knownhosts_index_match_memo(index, name, key, result)) {
+    return;
+  }
+  const char *keys[MAX_MEMO_KEYS];
+  size_t key_count = 0;
+  bool memoize = true;
+  size_t name_len = strlen(name);
+  for (size_t group = 0; group < index->group_count; group++) {
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if (HMAC(EVP_sha1(), index->groups[group].salt,
+             (int)index->groups[group].salt_len, (const unsigned char *)name,
+             name_len, digest, &digest_len) == NULL) {
+      memoize = false;
+      continue;
+    }
+    lv_libssh2_knownhosts_index_hashed_t *entry =
+        index->digests[lv_libssh2_knownhosts_index_digest_hash(digest) &
+                       (index->digest_bucket_count - 1)];
+    for (; entry != NULL; entry = entry->next) {
+      if (entry->group == group &&
+          memcmp(entry->digest, digest,
+                 LV_LIBSSH2_KNOWNHOSTS_INDEX_DIGEST_LEN) == 0) {
+        lv_libssh2_knownhosts_index_compare(entry->key, key, result);
+        if (key_count < MAX_MEMO_KEYS) {
+          keys[key_count] = entry->key;
+          key_count++;
+        } else {
+          memoize = false;
+        }
+      }
+    }
+  }
+  if (memoize) {
+    lv_libssh2_knownhosts_index_store_memo(index, name, keys, key_count);
+  }
+}
+
+static void lv_libssh2_knownhosts_index_match(
+    lv_libssh2_knownhosts_index_t *index, const char *name, const char *key,
+    lv_libssh2_knownhosts_check_results_t *result) {
+  uint32_t hash = 0;
+  lv_libssh2_knownhosts_index_name_t *entry =
+      lv_libssh2_knownhosts_index_table_bucket(&index->names, name, &hash);
+  for (; entry != NULL; entry = entry->next) {
+    if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+      lv_libssh2_knownhosts_index_compare(entry->key, key, result);
+    }
+  }
+  lv_libssh2_knownhosts_index_match_hashed(index, name, key, result);
+}
+
+void lv_libssh2_knownhosts_index_lookup(
+    lv_libssh2_knownhosts_index_t *index, const char *host, const int port,
+    const char *key, lv_libssh2_knownhosts_check_results_t *result) {
+  *result = LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_NOT_FOUND;
+  if (port >= 0) {
+    char candidate[MAX_CANDIDATE_LEN];
+    int len = snprintf(candidate, sizeof(candidate), "[%s]:%d", host, port);
+    if (len < 0 || (size_t)len >= sizeof(candidate)) {
+      *result = LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_FAILURE;
+      return;
+    }
+    lv_libssh2_knownhosts_index_match(index, candidate, key, result);
+  }
+  lv_libssh2_knownhosts_index_match(index, host, key, result);
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_index_batch_init(
+    lv_libssh2_knownhosts_index_batch_t *batch, const char *hosts,
+    const size_t hosts_len, const int *ports, const uint8_t *keys,
+    const size_t keys_len, const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding,
+    lv_libssh2_knownhosts_check_results_t *results) {
+  memset(batch, 0, sizeof(lv_libssh2_knownhosts_index_batch_t));
+  batch->ports = ports;
+  batch->results = results;
+  if (count == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  batch->hosts = malloc(count * sizeof(const char *));
+  batch->keys = calloc(count, sizeof(char *));
+  if (batch->hosts == NULL || batch->keys == NULL) {
+    lv_libssh2_knownhosts_index_batch_free(batch);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  batch->count = count;
+  size_t host_offset = 0;
+  size_t key_offset = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *end =
+        host_offset < hosts_len
+            ? memchr(hosts + host_offset, '\0', hosts_len - host_offset)
+            : NULL;
+    if (end == NULL || key_lens[i] > keys_len - key_offset) {
+      lv_libssh2_knownhosts_index_batch_free(batch);
+      return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+    }
+    batch->hosts[i] = hosts + host_offset;
+    host_offset = (size_t)(end - hosts) + 1;
+    lv_libssh2_status_t status = lv_libssh2_knownhosts_index_encode_key(
+        keys + key_offset, key_lens[i], encoding, &batch->keys[i]);
+    if (lv_libssh2_status_is_err(status)) {
+      lv_libssh2_knownhosts_index_batch_free(batch);
+      return status;
+    }
+    key_offset += key_lens[i];
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static void lv_libssh2_knownhosts_index_batch_work(void *context) {
+  lv_libssh2_knownhosts_index_batch_t *batch = context;
+  for (;;) {
+    int64_t next = lv_libssh2_atomic_add(&batch->next, 1) - 1;
+    if ((uint64_t)next >= batch->count) {
+      break;
+    }
+    lv_libssh2_knownhosts_index_lookup(batch->index, batch->hosts[next],
+                                       batch->ports[next], batch->keys[next],
+                                       &batch->results[next]);
+  }
+}
+
+void lv_libssh2_knownhosts_index_batch_run(
+    lv_libssh2_knownhosts_index_batch_t *batch,
+    lv_libssh2_knownhosts_index_t *index, const size_t threads) {
+  batch->index = index;
+  batch->next = 0;
+  /* Plain host names are a hash lookup each, which is not worth a thread. */
+  size_t wanted = threads == 0 ? DEFAULT_THREAD_COUNT : threads;
+  if (wanted > MAX_THREAD_COUNT) {
+    wanted = MAX_THREAD_COUNT;
+  }
+  if (wanted > batch->count) {
+    wanted = batch->count;
+  }
+  if (index->hashed_count == 0) {
+    wanted = 1;
+  }
+  lv_libssh2_thread_t workers[MAX_THREAD_COUNT];
+  size_t started = 0;
+  while (started + 1 < wanted &&
+         lv_libssh2_status_is_ok(lv_libssh2_thread_start(
+             &workers[started], lv_libssh2_knownhosts_index_batch_work,
+             batch))) {
+    started++;
+  }
+  lv_libssh2_knownhosts_index_batch_work(batch);
+  for (size_t i = 0; i < started; i++) {
+    lv_libssh2_thread_join(workers[i]);
+  }
+}
+
+void lv_libssh2_knownhosts_index_batch_free(
+    lv_libssh2_knownhosts_index_batch_t *batch) {
+  if (batch->keys != NULL) {
+    for (size_t i = 0; i < batch->count; i++) {
+      free(batch->keys[i]);
+    }
+  }
+  free(batch->keys);
+  free(batch->hosts);
+  batch->keys = NULL;
+  batch->hosts = NULL;
+  batch->count = 0;
+}
+
+lv_libssh2_status_t
+lv_libssh2_knownhosts_index_create(lv_libssh2_knownhosts_t *knownhosts,
+                                   lv_libssh2_knownhosts_index_t **handle) {
+  *handle = NULL;
+  if (knownhosts == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_knownhosts_index_t *index =
+      malloc(sizeof(lv_libssh2_knownhosts_index_t));
+  if (index == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  lv_libssh2_knownhosts_index_init(index);
+  size_t capacity = MIN_LINE_LEN;
+  char *line = malloc(capacity);
+  if (line == NULL) {
+    lv_libssh2_knownhosts_index_free(index);
+    free(index);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  /* The salts of hashed entries are not exposed through
+   * `libssh2_knownhost_get`, so every entry is written back out as a line
+   * and parsed the same way as a file. */
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  struct libssh2_knownhost *previous = NULL;
+  struct libssh2_knownhost *node = NULL;
+  int result = 0;
+  while ((result = libssh2_knownhost_get(knownhosts->inner, &node,
+                                         previous)) == 0) {
+    size_t len = 0;
+    result = libssh2_knownhost_writeline(knownhosts->inner, node, line,
+                                         capacity, &len,
+                                         LIBSSH2_KNOWNHOST_FILE_OPENSSH);
+    if (result == LIBSSH2_ERROR_BUFFER_TOO_SMALL) {
+      char *larger = realloc(line, capacity * 2);
+      if (larger == NULL) {
+        status = LV_LIBSSH2_STATUS_ERROR_MALLOC;
+        break;
+      }
+      line = larger;
+      capacity *= 2;
+      continue;
+    }
+    if (result != 0) {
+      break;
+    }
+    status = lv_libssh2_knownhosts_index_add_line(index, line, len);
+    if (lv_libssh2_status_is_err(status)) {
+      break;
+    }
+    previous = node;
+  }
+  free(line);
+  if (lv_libssh2_status_is_ok(status) && result < 0) {
+    status = lv_libssh2_status_from_result(result);
+  }
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_knownhosts_index_free(index);
+    free(index);
+    return status;
+  }
+  *handle = index;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_knownhosts_index_destroy(lv_libssh2_knownhosts_index_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_knownhosts_index_free(handle);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_index_check(
+    lv_libssh2_knownhosts_index_t *handle, const char *host, const int port,
+    const uint8_t *key, const size_t key_len,
+    const lv_libssh2_knownhost_key_encodings_t encoding,
+    lv_libssh2_knownhosts_check_results_t *result) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (host == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (key == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (result == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  char *encoded = NULL;
+  lv_libssh2_status_t status =
+      lv_libssh2_knownhosts_index_encode_key(key, key_len, encoding, &encoded);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_knownhosts_index_lookup(handle, host, port, encoded, result);
+  free(encoded);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_index_statistics(
+    lv_libssh2_knownhosts_index_t *handle, size_t *name_count,
+    size_t *hashed_count, size_t *salt_count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (name_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (hashed_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (salt_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *name_count = handle->names.count;
+  *hashed_count = handle->hashed_count;
+  *salt_count = handle->group_count;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_index_check_many(
+    lv_libssh2_knownhosts_index_t *handle, const char *hosts,
+    const size_t hosts_len, const int *ports, const uint8_t *keys,
+    const size_t keys_len, const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding, const size_t threads,
+    lv_libssh2_knownhosts_check_results_t *results) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (hosts == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (ports == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (keys == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (key_lens == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (results == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_knownhosts_index_batch_t batch;
+  lv_libssh2_status_t status = lv_libssh2_knownhosts_index_batch_init(
+      &batch, hosts, hosts_len, ports, keys, keys_len, key_lens, count,
+      encoding, results);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_knownhosts_index_batch_run(&batch, handle, threads);
+  lv_libssh2_knownhosts_index_batch_free(&batch);
+  return LV_LIBSSH2_STATUS_OK;
+}
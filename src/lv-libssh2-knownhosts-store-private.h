@@ -0,0 +1,91 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_KNOWNHOSTS_STORE_PRIVATE_H
+#define LV_LIBSSH2_KNOWNHOSTS_STORE_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2-knownhosts-index-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+/**
+ * Readers find the current index without taking a lock. A reader counts
+ * itself in the counter for the epoch it entered in, and a reload swaps the
+ * index, starts a new epoch, and frees the old index once the count for the
+ * previous epoch drops to zero.
+ *
+ * Reloads happen on the thread of the store, or on a caller of
+ * lv_libssh2_knownhosts_store_reload, so that a check never touches the file
+ * or waits for other readers.
+ */
+struct _lv_libssh2_knownhosts_store {
+  char *path;
+  void *volatile current;
+  lv_libssh2_atomic_t epoch;
+  lv_libssh2_atomic_t readers[2];
+  lv_libssh2_atomic_t reload_count;
+  /* Only used while holding the reload mutex. */
+  lv_libssh2_mutex_t reload_mutex;
+  uint64_t size;
+  uint64_t mtime;
+  lv_libssh2_thread_t thread;
+  lv_libssh2_mutex_t refresh_mutex;
+  lv_libssh2_condition_t refresh_condition;
+  bool stopping;
+};
+
+/**
+ * Enters a read of the store, returning the current index. The index stays
+ * valid until lv_libssh2_knownhosts_store_leave is called with the epoch.
+ */
+lv_libssh2_knownhosts_index_t *
+lv_libssh2_knownhosts_store_enter(lv_libssh2_knownhosts_store_t *store,
+                                  int64_t *epoch);
+
+void lv_libssh2_knownhosts_store_leave(lv_libssh2_knownhosts_store_t *store,
+                                       const int64_t epoch);
+
+/**
+ * Checks the host key of a session after its handshake, returning
+ * ::LV_LIBSSH2_STATUS_ERROR_HOST_KEY_UNKNOWN or
+ * ::LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH if it does not match.
+ */
+lv_libssh2_status_t
+lv_libssh2_knownhosts_store_verify(lv_libssh2_knownhosts_store_t *store,
+                                   lv_libssh2_session_t *session,
+                                   const char *host, const int32_t port);
+
+#endif
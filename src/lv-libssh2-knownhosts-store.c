@@ -0,0 +1,414 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-knownhosts-index-private.h"
+#include "lv-libssh2-knownhosts-store-private.h"
+#include "lv-libssh2-mapping-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+/* How often the thread of the store looks at the file for changes, in
+ * milliseconds. */
+#define REFRESH_INTERVAL 1000
+
+static bool lv_libssh2_knownhosts_store_local_stat(const char *path,
+                                                   uint64_t *size,
+                                                   uint64_t *mtime) {
+#ifdef _WIN32
+  struct _stat64 info;
+  int result = _stat64(path, &info);
+#else
+  struct stat info;
+  int result = stat(path, &info);
+#endif
+  *size = 0;
+  *mtime = 0;
+  if (result != 0) {
+    return false;
+  }
+  *size = (uint64_t)info.st_size;
+  *mtime = (uint64_t)info.st_mtime;
+  return true;
+}
+
+/* Builds an index from the lines of the file, which is mapped into memory
+ * as a whole rather than read into a buffer. */
+static lv_libssh2_status_t
+lv_libssh2_knownhosts_store_load(const char *path,
+                                 lv_libssh2_knownhosts_index_t **handle) {
+  *handle = NULL;
+  lv_libssh2_mapping_t mapping;
+  lv_libssh2_status_t status = lv_libssh2_mapping_open_read(&mapping, path);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  if (mapping.size > SIZE_MAX) {
+    lv_libssh2_mapping_close(&mapping);
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  uint8_t *data = NULL;
+  size_t len = 0;
+  status =
+      lv_libssh2_mapping_map(&mapping, 0, (size_t)mapping.size, &data, &len);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_mapping_close(&mapping);
+    return status;
+  }
+  lv_libssh2_knownhosts_index_t *index =
+      malloc(sizeof(lv_libssh2_knownhosts_index_t));
+  if (index == NULL) {
+    lv_libssh2_mapping_close(&mapping);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  lv_libssh2_knownhosts_index_init(index);
+  const char *line = (const char *)data;
+  const char *end = line + len;
+  while (line < end && lv_libssh2_status_is_ok(status)) {
+    const char *line_end = memchr(line, '\n', (size_t)(end - line));
+    if (line_end == NULL) {
+      line_end = end;
+    }
+    status = lv_libssh2_knownhosts_index_add_line(index, line,
+                                                  (size_t)(line_end - line));
+    line = line_end + 1;
+  }
+  lv_libssh2_mapping_close(&mapping);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_knownhosts_index_free(index);
+    free(index);
+    return status;
+  }
+  *handle = index;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_knownhosts_index_t *
+lv_libssh2_knownhosts_store_enter(lv_libssh2_knownhosts_store_t *store,
+                                  int64_t *epoch) {
+  for (;;) {
+    int64_t current = lv_libssh2_atomic_load(&store->epoch);
+    lv_libssh2_atomic_add(&store->readers[current & 1], 1);
+    /* A reload started a new epoch before this reader was counted, so it
+     * might not wait for this reader. */
+    if (lv_libssh2_atomic_load(&store->epoch) == current) {
+      *epoch = current;
+      break;
+    }
+    lv_libssh2_atomic_add(&store->readers[current & 1], -1);
+  }
+  return lv_libssh2_atomic_load_pointer(&store->current);
+}
+
+void lv_libssh2_knownhosts_store_leave(lv_libssh2_knownhosts_store_t *store,
+                                       const int64_t epoch) {
+  lv_libssh2_atomic_add(&store->readers[epoch & 1], -1);
+}
+
+/* Replaces the index and frees the old one once no reader is using it. The
+ * reload mutex must be held. */
+static void
+lv_libssh2_knownhosts_store_publish(lv_libssh2_knownhosts_store_t *store,
+                                    lv_libssh2_knownhosts_index_t *index) {
+  lv_libssh2_knownhosts_index_t *previous =
+      lv_libssh2_atomic_exchange_pointer(&store->current, index);
+  int64_t epoch = lv_libssh2_atomic_add(&store->epoch, 1) - 1;
+  while (lv_libssh2_atomic_load(&store->readers[epoch & 1]) != 0) {
+    lv_libssh2_thread_sleep(1);
+  }
+  lv_libssh2_knownhosts_index_free(previous);
+  free(previous);
+  lv_libssh2_atomic_add(&store->reload_count, 1);
+}
+
+/* Reloads the file if its size or modification time changed since it was
+ * last loaded. A file that fails to load is not tried again until it
+ * changes, and the previous index stays in use. */
+static lv_libssh2_status_t
+lv_libssh2_knownhosts_store_update(lv_libssh2_knownhosts_store_t *store,
+                                   bool *reloaded) {
+  *reloaded = false;
+  lv_libssh2_mutex_lock(&store->reload_mutex);
+  uint64_t size = 0;
+  uint64_t mtime = 0;
+  if (!lv_libssh2_knownhosts_store_local_stat(store->path, &size, &mtime)) {
+    lv_libssh2_mutex_unlock(&store->reload_mutex);
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  if (size == store->size && mtime == store->mtime) {
+    lv_libssh2_mutex_unlock(&store->reload_mutex);
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  store->size = size;
+  store->mtime = mtime;
+  lv_libssh2_knownhosts_index_t *index = NULL;
+  lv_libssh2_status_t status =
+      lv_libssh2_knownhosts_store_load(store->path, &index);
+  if (lv_libssh2_status_is_ok(status)) {
+    lv_libssh2_knownhosts_store_publish(store, index);
+    *reloaded = true;
+  }
+  lv_libssh2_mutex_unlock(&store->reload_mutex);
+  return status;
+}
+
+/* Looks for changes to the file each interval until the store is
+ * destroyed, so the checks carry on with the current index meanwhile. */
+static void lv_libssh2_knownhosts_store_run(void *context) {
+  lv_libssh2_knownhosts_store_t *store = context;
+  lv_libssh2_mutex_lock(&store->refresh_mutex);
+  while (!store->stopping) {
+    lv_libssh2_condition_timed_wait(&store->refresh_condition,
+                                    &store->refresh_mutex, REFRESH_INTERVAL);
+    if (store->stopping) {
+      break;
+    }
+    lv_libssh2_mutex_unlock(&store->refresh_mutex);
+    bool reloaded = false;
+    lv_libssh2_knownhosts_store_update(store, &reloaded);
+    lv_libssh2_mutex_lock(&store->refresh_mutex);
+  }
+  lv_libssh2_mutex_unlock(&store->refresh_mutex);
+}
+
+lv_libssh2_status_t
+lv_libssh2_knownhosts_store_verify(lv_libssh2_knownhosts_store_t *store,
+                                   lv_libssh2_session_t *session,
+                                   const char *host, const int32_t port) {
+  size_t len = 0;
+  int type = 0;
+  const char *key = libssh2_session_hostkey(session->inner, &len, &type);
+  if (key == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_HOST_KEY_INITIALIZE;
+  }
+  lv_libssh2_knownhosts_check_results_t result =
+      LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_FAILURE;
+  lv_libssh2_status_t status = lv_libssh2_knownhosts_store_check(
+      store, host, port, (const uint8_t *)key, len,
+      LV_LIBSSH2_KNOWNHOST_KEY_ENCODING_RAW, &result);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  switch (result) {
+  case LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH:
+    return LV_LIBSSH2_STATUS_OK;
+  case LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MISMATCH:
+    return LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH;
+  case LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_NOT_FOUND:
+    return LV_LIBSSH2_STATUS_ERROR_HOST_KEY_UNKNOWN;
+  default:
+    return LV_LIBSSH2_STATUS_ERROR_KNOWN_HOSTS;
+  }
+}
+
+lv_libssh2_status_t
+lv_libssh2_knownhosts_store_create(const char *path,
+                                   lv_libssh2_knownhosts_store_t **handle) {
+  *handle = NULL;
+  if (path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  uint64_t size = 0;
+  uint64_t mtime = 0;
+  if (!lv_libssh2_knownhosts_store_local_stat(path, &size, &mtime)) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  lv_libssh2_knownhosts_index_t *index = NULL;
+  lv_libssh2_status_t status = lv_libssh2_knownhosts_store_load(path, &index);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_knownhosts_store_t *store =
+      malloc(sizeof(lv_libssh2_knownhosts_store_t));
+  if (store == NULL) {
+    lv_libssh2_knownhosts_index_free(index);
+    free(index);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  memset(store, 0, sizeof(lv_libssh2_knownhosts_store_t));
+  store->path = malloc(strlen(path) + 1);
+  if (store->path == NULL) {
+    lv_libssh2_knownhosts_index_free(index);
+    free(index);
+    free(store);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  strcpy(store->path, path);
+  store->current = index;
+  lv_libssh2_mutex_init(&store->reload_mutex);
+  store->size = size;
+  store->mtime = mtime;
+  lv_libssh2_mutex_init(&store->refresh_mutex);
+  lv_libssh2_condition_init(&store->refresh_condition);
+  status = lv_libssh2_thread_start(&store->thread,
+                                   lv_libssh2_knownhosts_store_run, store);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_condition_destroy(&store->refresh_condition);
+    lv_libssh2_mutex_destroy(&store->refresh_mutex);
+    lv_libssh2_mutex_destroy(&store->reload_mutex);
+    lv_libssh2_knownhosts_index_free(index);
+    free(index);
+    free(store->path);
+    free(store);
+    return status;
+  }
+  *handle = store;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_knownhosts_store_destroy(lv_libssh2_knownhosts_store_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->refresh_mutex);
+  handle->stopping = true;
+  lv_libssh2_condition_broadcast(&handle->refresh_condition);
+  lv_libssh2_mutex_unlock(&handle->refresh_mutex);
+  lv_libssh2_thread_join(handle->thread);
+  lv_libssh2_condition_destroy(&handle->refresh_condition);
+  lv_libssh2_mutex_destroy(&handle->refresh_mutex);
+  lv_libssh2_knownhosts_index_t *index = handle->current;
+  lv_libssh2_knownhosts_index_free(index);
+  free(index);
+  lv_libssh2_mutex_destroy(&handle->reload_mutex);
+  free(handle->path);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_store_check(
+    lv_libssh2_knownhosts_store_t *handle, const char *host, const int port,
+    const uint8_t *key, const size_t key_len,
+    const lv_libssh2_knownhost_key_encodings_t encoding,
+    lv_libssh2_knownhosts_check_results_t *result) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (host == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (key == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (result == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  char *encoded = NULL;
+  lv_libssh2_status_t status =
+      lv_libssh2_knownhosts_index_encode_key(key, key_len, encoding, &encoded);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  int64_t epoch = 0;
+  lv_libssh2_knownhosts_index_t *index =
+      lv_libssh2_knownhosts_store_enter(handle, &epoch);
+  lv_libssh2_knownhosts_index_lookup(index, host, port, encoded, result);
+  lv_libssh2_knownhosts_store_leave(handle, epoch);
+  free(encoded);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_store_check_many(
+    lv_libssh2_knownhosts_store_t *handle, const char *hosts,
+    const size_t hosts_len, const int *ports, const uint8_t *keys,
+    const size_t keys_len, const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding, const size_t threads,
+    lv_libssh2_knownhosts_check_results_t *results) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (hosts == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (ports == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (keys == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (key_lens == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (results == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_knownhosts_index_batch_t batch;
+  lv_libssh2_status_t status = lv_libssh2_knownhosts_index_batch_init(
+      &batch, hosts, hosts_len, ports, keys, keys_len, key_lens, count,
+      encoding, results);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  int64_t epoch = 0;
+  lv_libssh2_knownhosts_index_t *index =
+      lv_libssh2_knownhosts_store_enter(handle, &epoch);
+  lv_libssh2_knownhosts_index_batch_run(&batch, index, threads);
+  lv_libssh2_knownhosts_store_leave(handle, epoch);
+  lv_libssh2_knownhosts_index_batch_free(&batch);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_knownhosts_store_reload(lv_libssh2_knownhosts_store_t *handle,
+                                   bool *reloaded) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (reloaded == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  return lv_libssh2_knownhosts_store_update(handle, reloaded);
+}
+
+lv_libssh2_status_t lv_libssh2_knownhosts_store_reload_count(
+    lv_libssh2_knownhosts_store_t *handle, uint64_t *count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *count = (uint64_t)lv_libssh2_atomic_load(&handle->reload_count);
+  return LV_LIBSSH2_STATUS_OK;
+}
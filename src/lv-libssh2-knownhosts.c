@@ -37,6 +37,7 @@
 #include "libssh2.h"
 
 #include "lv-libssh2-knownhost-private.h"
+#include "lv-libssh2-knownhosts-index-private.h"
 #include "lv-libssh2-knownhosts-private.h"
 #include "lv-libssh2-session-private.h"
 #include "lv-libssh2-status-private.h"
@@ -395,3 +396,46 @@ lv_libssh2_status_t lv_libssh2_knownhosts_next(
     return lv_libssh2_status_from_result(inner_result);
   }
 }
+
+lv_libssh2_status_t lv_libssh2_knownhosts_check_many(
+    lv_libssh2_knownhosts_t *handle, const char *hosts, const size_t hosts_len,
+    const int *ports, const uint8_t *keys, const size_t keys_len,
+    const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding, const size_t threads,
+    lv_libssh2_knownhosts_check_results_t *results) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (hosts == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (ports == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (keys == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (key_lens == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (results == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_knownhosts_index_batch_t batch;
+  lv_libssh2_status_t status = lv_libssh2_knownhosts_index_batch_init(
+      &batch, hosts, hosts_len, ports, keys, keys_len, key_lens, count,
+      encoding, results);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  /* Indexing the entries once is cheaper than walking all of them for each
+   * host, which is what libssh2_knownhost_checkp does. */
+  lv_libssh2_knownhosts_index_t *index = NULL;
+  status = lv_libssh2_knownhosts_index_create(handle, &index);
+  if (lv_libssh2_status_is_ok(status)) {
+    lv_libssh2_knownhosts_index_batch_run(&batch, index, threads);
+    lv_libssh2_knownhosts_index_destroy(index);
+  }
+  lv_libssh2_knownhosts_index_batch_free(&batch);
+  return status;
+}
@@ -0,0 +1,107 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_MAPPING_PRIVATE_H
+#define LV_LIBSSH2_MAPPING_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/* The size of the views that whole-file transfers map at a time, 64 MiB. */
+#define LV_LIBSSH2_MAPPING_VIEW_SIZE 67108864
+
+/**
+ * A local file accessed through a memory-mapped view.
+ *
+ * Only one view of the file is mapped at a time, so files larger than the
+ * address space of a 32-bit process can still be moved through it.
+ */
+typedef struct _lv_libssh2_mapping {
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE map;
+#else
+  int file;
+#endif
+  bool writable;
+  uint64_t size;
+  uint8_t *view;
+  uint64_t view_offset;
+  size_t view_len;
+} lv_libssh2_mapping_t;
+
+/**
+ * Opens an existing file for reading.
+ */
+lv_libssh2_status_t lv_libssh2_mapping_open_read(lv_libssh2_mapping_t *mapping,
+                                                 const char *path);
+
+/**
+ * Opens or creates a file for writing and sets its size in bytes, keeping
+ * any existing content within that size.
+ */
+lv_libssh2_status_t
+lv_libssh2_mapping_open_write(lv_libssh2_mapping_t *mapping, const char *path,
+                              const uint64_t size);
+
+/**
+ * Maps the bytes from the offset, replacing the previous view. The length is
+ * at most `max_len` and short only at the end of the file.
+ */
+lv_libssh2_status_t lv_libssh2_mapping_map(lv_libssh2_mapping_t *mapping,
+                                           const uint64_t offset,
+                                           const size_t max_len,
+                                           uint8_t **data, size_t *len);
+
+/**
+ * Changes the size of a file opened for writing, unmapping the view.
+ *
+ * The disk space for the new size is reserved, so a full disk or quota is
+ * reported as ::LV_LIBSSH2_STATUS_ERROR_FILE here instead of failing a write
+ * through a view.
+ */
+lv_libssh2_status_t lv_libssh2_mapping_resize(lv_libssh2_mapping_t *mapping,
+                                              const uint64_t size);
+
+/**
+ * Unmaps the view and closes the file.
+ */
+lv_libssh2_status_t lv_libssh2_mapping_close(lv_libssh2_mapping_t *mapping);
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "lv-libssh2-mapping-private.h"
+#include "lv-libssh2.h"
+
+/* Views start on a multiple of this, which covers both the page size and
+ * the 64 KiB allocation granularity of Windows. */
+#define VIEW_ALIGNMENT 65536
+
+static void lv_libssh2_mapping_unmap(lv_libssh2_mapping_t *mapping) {
+  if (mapping->view != NULL) {
+#ifdef _WIN32
+    UnmapViewOfFile(mapping->view);
+#else
+    munmap(mapping->view, mapping->view_len);
+#endif
+  }
+  mapping->view = NULL;
+  mapping->view_offset = 0;
+  mapping->view_len = 0;
+}
+
+#ifdef _WIN32
+static void lv_libssh2_mapping_release(lv_libssh2_mapping_t *mapping) {
+  lv_libssh2_mapping_unmap(mapping);
+  if (mapping->map != NULL) {
+    CloseHandle(mapping->map);
+    mapping->map = NULL;
+  }
+}
+
+static lv_libssh2_status_t lv_libssh2_mapping_open(
+    lv_libssh2_mapping_t *mapping, const char *path, const bool writable) {
+  mapping->file = CreateFileA(
+      path, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+      writable ? OPEN_ALWAYS : OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (mapping->file == INVALID_HANDLE_VALUE) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  mapping->map = NULL;
+  mapping->writable = writable;
+  mapping->size = 0;
+  mapping->view = NULL;
+  mapping->view_offset = 0;
+  mapping->view_len = 0;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_mapping_open_read(lv_libssh2_mapping_t *mapping,
+                                                 const char *path) {
+  lv_libssh2_status_t status = lv_libssh2_mapping_open(mapping, path, false);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(mapping->file, &size)) {
+    CloseHandle(mapping->file);
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  mapping->size = (uint64_t)size.QuadPart;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_mapping_resize(lv_libssh2_mapping_t *mapping,
+                                              const uint64_t size) {
+  /* The file cannot change size while a mapping object is open on it. Unless
+   * the file is marked sparse, which it never is here, setting the end of
+   * the file allocates its blocks, so running out of space fails here rather
+   * than when a view is written. */
+  lv_libssh2_mapping_release(mapping);
+  LARGE_INTEGER position;
+  position.QuadPart = (LONGLONG)size;
+  if (!SetFilePointerEx(mapping->file, position, NULL, FILE_BEGIN) ||
+      !SetEndOfFile(mapping->file)) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  mapping->size = size;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static uint8_t *lv_libssh2_mapping_view(lv_libssh2_mapping_t *mapping,
+                                        const uint64_t offset,
+                                        const size_t len) {
+  if (mapping->map == NULL) {
+    mapping->map =
+        CreateFileMappingA(mapping->file, NULL,
+                           mapping->writable ? PAGE_READWRITE : PAGE_READONLY,
+                           0, 0, NULL);
+    if (mapping->map == NULL) {
+      return NULL;
+    }
+  }
+  return MapViewOfFile(mapping->map,
+                       mapping->writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                       (DWORD)(offset >> 32), (DWORD)(offset & 0xFFFFFFFF),
+                       len);
+}
+
+lv_libssh2_status_t lv_libssh2_mapping_close(lv_libssh2_mapping_t *mapping) {
+  lv_libssh2_mapping_release(mapping);
+  if (!CloseHandle(mapping->file)) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+#else
+static lv_libssh2_status_t lv_libssh2_mapping_open(
+    lv_libssh2_mapping_t *mapping, const char *path, const bool writable) {
+  mapping->file =
+      writable ? open(path, O_RDWR | O_CREAT, 0666) : open(path, O_RDONLY);
+  if (mapping->file < 0) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  mapping->writable = writable;
+  mapping->size = 0;
+  mapping->view = NULL;
+  mapping->view_offset = 0;
+  mapping->view_len = 0;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_mapping_open_read(lv_libssh2_mapping_t *mapping,
+                                                 const char *path) {
+  lv_libssh2_status_t status = lv_libssh2_mapping_open(mapping, path, false);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  struct stat info;
+  if (fstat(mapping->file, &info) != 0) {
+    close(mapping->file);
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  mapping->size = (uint64_t)info.st_size;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+/* Allocates the blocks of the range, so that writing through a view cannot
+ * run out of space and raise SIGBUS. Returns zero on success. */
+static int lv_libssh2_mapping_reserve(const int file, const uint64_t offset,
+                                      const uint64_t len) {
+#ifdef __APPLE__
+  fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, (off_t)len, 0};
+  if (fcntl(file, F_PREALLOCATE, &store) == -1) {
+    store.fst_flags = F_ALLOCATEALL;
+    if (fcntl(file, F_PREALLOCATE, &store) == -1) {
+      return -1;
+    }
+  }
+  (void)offset;
+  return 0;
+#else
+  return posix_fallocate(file, (off_t)offset, (off_t)len);
+#endif
+}
+
+lv_libssh2_status_t lv_libssh2_mapping_resize(lv_libssh2_mapping_t *mapping,
+                                              const uint64_t size) {
+  lv_libssh2_mapping_unmap(mapping);
+  /* Only the part beyond the known size is reserved. The known size is zero
+   * when the file was just opened, so holes in existing content are filled
+   * as well. */
+  const uint64_t reserved = mapping->size < size ? mapping->size : size;
+  if (ftruncate(mapping->file, (off_t)size) != 0 ||
+      (size > reserved &&
+       lv_libssh2_mapping_reserve(mapping->file, reserved, size - reserved) !=
+           0)) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  mapping->size = size;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static uint8_t *lv_libssh2_mapping_view(lv_libssh2_mapping_t *mapping,
+                                        const uint64_t offset,
+                                        const size_t len) {
+  void *view = mmap(NULL, len,
+                    mapping->writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                    MAP_SHARED, mapping->file, (off_t)offset);
+  if (view == MAP_FAILED) {
+    return NULL;
+  }
+  /* The view is walked once from front to back. */
+  madvise(view, len, MADV_SEQUENTIAL);
+  return view;
+}
+
+lv_libssh2_status_t lv_libssh2_mapping_close(lv_libssh2_mapping_t *mapping) {
+  lv_libssh2_mapping_unmap(mapping);
+  if (close(mapping->file) != 0) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+#endif
+
+lv_libssh2_status_t
+lv_libssh2_mapping_open_write(lv_libssh2_mapping_t *mapping, const char *path,
+                              const uint64_t size) {
+  lv_libssh2_status_t status = lv_libssh2_mapping_open(mapping, path, true);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  status = lv_libssh2_mapping_resize(mapping, size);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_mapping_close(mapping);
+  }
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_mapping_map(lv_libssh2_mapping_t *mapping,
+                                           const uint64_t offset,
+                                           const size_t max_len,
+                                           uint8_t **data, size_t *len) {
+  *data = NULL;
+  *len = 0;
+  if (offset >= mapping->size || max_len == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  const uint64_t aligned = offset - offset % VIEW_ALIGNMENT;
+  uint64_t end = offset + max_len;
+  if (end > mapping->size) {
+    end = mapping->size;
+  }
+  lv_libssh2_mapping_unmap(mapping);
+  uint8_t *view =
+      lv_libssh2_mapping_view(mapping, aligned, (size_t)(end - aligned));
+  if (view == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  mapping->view = view;
+  mapping->view_offset = aligned;
+  mapping->view_len = (size_t)(end - aligned);
+  *data = view + (offset - aligned);
+  *len = (size_t)(end - offset);
+  return LV_LIBSSH2_STATUS_OK;
+}
@@ -0,0 +1,374 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-channel-private.h"
+#include "lv-libssh2-poller-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-socket-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define INITIAL_CAPACITY 16
+
+static lv_libssh2_status_t
+lv_libssh2_poller_reserve(lv_libssh2_poller_t *poller) {
+  if (poller->item_count < poller->item_capacity) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  size_t capacity = poller->item_capacity == 0 ? INITIAL_CAPACITY
+                                               : poller->item_capacity * 2;
+  lv_libssh2_poller_item_t *items =
+      realloc(poller->items, capacity * sizeof(lv_libssh2_poller_item_t));
+  if (items == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  poller->items = items;
+  struct pollfd *descriptors =
+      realloc(poller->descriptors, capacity * sizeof(struct pollfd));
+  if (descriptors == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  poller->descriptors = descriptors;
+  lv_libssh2_session_t **sessions =
+      realloc(poller->sessions, capacity * sizeof(lv_libssh2_session_t *));
+  if (sessions == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  poller->sessions = sessions;
+  size_t *ready = realloc(poller->ready, capacity * sizeof(size_t));
+  if (ready == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  poller->ready = ready;
+  poller->item_capacity = capacity;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_poller_append(lv_libssh2_poller_t *poller,
+                         lv_libssh2_session_t *session,
+                         lv_libssh2_channel_t *channel, const uint32_t events) {
+  for (size_t i = 0; i < poller->item_count; i++) {
+    if (poller->items[i].session == session &&
+        poller->items[i].channel == channel) {
+      poller->items[i].events = events;
+      return LV_LIBSSH2_STATUS_OK;
+    }
+  }
+  lv_libssh2_status_t status = lv_libssh2_poller_reserve(poller);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_poller_item_t *item = &poller->items[poller->item_count];
+  item->session = session;
+  item->channel = channel;
+  item->events = events;
+  item->ready = 0;
+  poller->item_count += 1;
+  poller->ready_count = 0;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static void lv_libssh2_poller_erase(lv_libssh2_poller_t *poller,
+                                    lv_libssh2_session_t *session,
+                                    lv_libssh2_channel_t *channel) {
+  size_t count = 0;
+  for (size_t i = 0; i < poller->item_count; i++) {
+    lv_libssh2_poller_item_t *item = &poller->items[i];
+    if (item->session == session && item->channel == channel) {
+      continue;
+    }
+    poller->items[count] = *item;
+    count += 1;
+  }
+  poller->item_count = count;
+  poller->ready_count = 0;
+}
+
+/* Processes the packets already received for each session with channels, so
+ * the channel state reflects everything the server has sent. */
+static void lv_libssh2_poller_pump(lv_libssh2_poller_t *poller) {
+  size_t session_count = 0;
+  for (size_t i = 0; i < poller->item_count; i++) {
+    lv_libssh2_poller_item_t *item = &poller->items[i];
+    if (item->channel == NULL) {
+      continue;
+    }
+    bool pumped = false;
+    for (size_t j = 0; j < session_count; j++) {
+      if (poller->sessions[j] == item->session) {
+        pumped = true;
+        break;
+      }
+    }
+    if (pumped) {
+      continue;
+    }
+    poller->sessions[session_count] = item->session;
+    session_count += 1;
+    LIBSSH2_SESSION *inner = item->session->inner;
+    const int blocking = libssh2_session_get_blocking(inner);
+    libssh2_session_set_blocking(inner, 0);
+    char empty = 0;
+    libssh2_channel_read_ex(item->channel->inner, 0, &empty, 0);
+    libssh2_session_set_blocking(inner, blocking);
+  }
+}
+
+static uint32_t
+lv_libssh2_poller_channel_ready(lv_libssh2_channel_t *channel) {
+  uint32_t ready = 0;
+  if (libssh2_poll_channel_read(channel->inner, 0) ||
+      libssh2_poll_channel_read(channel->inner, 1)) {
+    ready |= LV_LIBSSH2_POLLER_EVENT_READ;
+  }
+  if (libssh2_channel_window_write_ex(channel->inner, NULL) > 0) {
+    ready |= LV_LIBSSH2_POLLER_EVENT_WRITE;
+  }
+  if (libssh2_channel_eof(channel->inner) == 1) {
+    ready |= LV_LIBSSH2_POLLER_EVENT_EOF;
+  }
+  return ready;
+}
+
+static size_t lv_libssh2_poller_collect(lv_libssh2_poller_t *poller) {
+  size_t count = 0;
+  for (size_t i = 0; i < poller->item_count; i++) {
+    lv_libssh2_poller_item_t *item = &poller->items[i];
+    if (item->channel != NULL) {
+      item->ready = lv_libssh2_poller_channel_ready(item->channel) &
+                    (item->events | LV_LIBSSH2_POLLER_EVENT_EOF);
+    }
+    if (item->ready != 0) {
+      poller->ready[count] = i;
+      count += 1;
+    }
+  }
+  return count;
+}
+
+/* Polls each distinct session socket once and marks the session items whose
+ * socket became ready. */
+static lv_libssh2_status_t lv_libssh2_poller_poll(lv_libssh2_poller_t *poller,
+                                                  const int32_t milliseconds) {
+  size_t count = 0;
+  for (size_t i = 0; i < poller->item_count; i++) {
+    lv_libssh2_session_t *session = poller->items[i].session;
+    if (session->socket == LV_LIBSSH2_SOCKET_INVALID) {
+      continue;
+    }
+    size_t index = 0;
+    while (index < count && poller->sessions[index] != session) {
+      index += 1;
+    }
+    if (index == count) {
+      poller->sessions[count] = session;
+      poller->descriptors[count].fd = session->socket;
+      poller->descriptors[count].events = POLLIN;
+      poller->descriptors[count].revents = 0;
+      count += 1;
+    }
+    int directions = libssh2_session_block_directions(session->inner);
+    if (directions & LIBSSH2_SESSION_BLOCK_OUTBOUND) {
+      poller->descriptors[index].events |= POLLOUT;
+    }
+  }
+  if (count == 0) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  if (lv_libssh2_socket_poll(poller->descriptors, count, milliseconds) < 0) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_SOCKET;
+  }
+  for (size_t i = 0; i < poller->item_count; i++) {
+    lv_libssh2_poller_item_t *item = &poller->items[i];
+    if (item->channel != NULL) {
+      continue;
+    }
+    for (size_t j = 0; j < count; j++) {
+      if (poller->sessions[j] == item->session) {
+        short revents = poller->descriptors[j].revents;
+        if (revents & (POLLIN | POLLERR | POLLHUP)) {
+          item->ready |= LV_LIBSSH2_POLLER_EVENT_READ;
+        }
+        if (revents & POLLOUT) {
+          item->ready |= LV_LIBSSH2_POLLER_EVENT_WRITE;
+        }
+        break;
+      }
+    }
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_poller_create(lv_libssh2_poller_t **handle) {
+  *handle = NULL;
+  lv_libssh2_poller_t *poller = calloc(1, sizeof(lv_libssh2_poller_t));
+  if (poller == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  *handle = poller;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_poller_destroy(lv_libssh2_poller_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  free(handle->items);
+  free(handle->descriptors);
+  free(handle->sessions);
+  free(handle->ready);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_poller_add_session(lv_libssh2_poller_t *handle,
+                              lv_libssh2_session_t *session) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  return lv_libssh2_poller_append(handle, session, NULL,
+                                  LV_LIBSSH2_POLLER_EVENT_READ |
+                                      LV_LIBSSH2_POLLER_EVENT_WRITE);
+}
+
+lv_libssh2_status_t
+lv_libssh2_poller_remove_session(lv_libssh2_poller_t *handle,
+                                 lv_libssh2_session_t *session) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_poller_erase(handle, session, NULL);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_poller_add_channel(lv_libssh2_poller_t *handle,
+                                                  lv_libssh2_channel_t *channel,
+                                                  const uint32_t events) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (channel == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  return lv_libssh2_poller_append(handle, channel->session, channel, events);
+}
+
+lv_libssh2_status_t
+lv_libssh2_poller_remove_channel(lv_libssh2_poller_t *handle,
+                                 lv_libssh2_channel_t *channel) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (channel == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_poller_erase(handle, channel->session, channel);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_poller_wait(lv_libssh2_poller_t *handle,
+                                           const int32_t timeout,
+                                           size_t *ready_count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (ready_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *ready_count = 0;
+  handle->ready_count = 0;
+  for (size_t i = 0; i < handle->item_count; i++) {
+    handle->items[i].ready = 0;
+  }
+  const uint64_t start = lv_libssh2_time_now();
+  for (;;) {
+    lv_libssh2_poller_pump(handle);
+    handle->ready_count = lv_libssh2_poller_collect(handle);
+    *ready_count = handle->ready_count;
+    if (*ready_count > 0) {
+      return LV_LIBSSH2_STATUS_OK;
+    }
+    int32_t wait = -1;
+    if (timeout >= 0) {
+      uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+      if (elapsed >= (uint64_t)timeout) {
+        return LV_LIBSSH2_STATUS_OK;
+      }
+      wait = (int32_t)((uint64_t)timeout - elapsed);
+    }
+    lv_libssh2_status_t status = lv_libssh2_poller_poll(handle, wait);
+    if (lv_libssh2_status_is_err(status)) {
+      return status;
+    }
+  }
+}
+
+lv_libssh2_status_t lv_libssh2_poller_ready(lv_libssh2_poller_t *handle,
+                                            const size_t index,
+                                            lv_libssh2_session_t **session,
+                                            lv_libssh2_channel_t **channel,
+                                            uint32_t *events) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (channel == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (events == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (index >= handle->ready_count) {
+    return LV_LIBSSH2_STATUS_ERROR_OUT_OF_BOUNDARY;
+  }
+  lv_libssh2_poller_item_t *item = &handle->items[handle->ready[index]];
+  *session = item->session;
+  *channel = item->channel;
+  *events = item->ready;
+  return LV_LIBSSH2_STATUS_OK;
+}
@@ -0,0 +1,70 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_POOL_PRIVATE_H
+#define LV_LIBSSH2_POOL_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+typedef struct _lv_libssh2_pool_entry {
+  char *host;
+  int32_t port;
+  char *user;
+  char *fingerprint;
+  lv_libssh2_session_t *session;
+  lv_libssh2_channel_t *lease;
+  bool leased;
+  /* Set while the reaper sends a keepalive without holding the lock. */
+  bool pinging;
+  uint64_t last_used;
+} lv_libssh2_pool_entry_t;
+
+struct _lv_libssh2_pool {
+  lv_libssh2_mutex_t mutex;
+  lv_libssh2_condition_t changed;
+  lv_libssh2_pool_entry_t **entries;
+  size_t entry_count;
+  size_t entry_capacity;
+  uint32_t idle_timeout;
+  uint64_t hit_count;
+  uint64_t miss_count;
+  uint64_t evicted_count;
+  lv_libssh2_thread_t reaper;
+  bool stopping;
+};
+
+#endif
@@ -0,0 +1,428 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-channel-private.h"
+#include "lv-libssh2-pool-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define KEEPALIVE_INTERVAL 30
+#define REAPER_PERIOD 1000
+
+static char *lv_libssh2_pool_copy(const char *text) {
+  size_t len = strlen(text) + 1;
+  char *copy = malloc(len);
+  if (copy != NULL) {
+    memcpy(copy, text, len);
+  }
+  return copy;
+}
+
+static bool lv_libssh2_pool_matches(const lv_libssh2_pool_entry_t *entry,
+                                    const char *host, const int32_t port,
+                                    const char *user,
+                                    const char *fingerprint) {
+  return entry->port == port && strcmp(entry->host, host) == 0 &&
+         strcmp(entry->user, user) == 0 &&
+         strcmp(entry->fingerprint, fingerprint) == 0;
+}
+
+static void lv_libssh2_pool_entry_free(lv_libssh2_pool_entry_t *entry) {
+  free(entry->host);
+  free(entry->user);
+  free(entry->fingerprint);
+  free(entry);
+}
+
+static void lv_libssh2_pool_discard(lv_libssh2_pool_entry_t *entry) {
+  if (entry->lease != NULL) {
+    lv_libssh2_channel_destroy(entry->lease);
+  }
+  lv_libssh2_session_disconnect(entry->session, "Evicted from pool");
+  lv_libssh2_session_destroy(entry->session);
+  lv_libssh2_pool_entry_free(entry);
+}
+
+static lv_libssh2_pool_entry_t *
+lv_libssh2_pool_remove(lv_libssh2_pool_t *pool, const size_t index) {
+  lv_libssh2_pool_entry_t *entry = pool->entries[index];
+  pool->entry_count -= 1;
+  pool->entries[index] = pool->entries[pool->entry_count];
+  pool->evicted_count += 1;
+  return entry;
+}
+
+/* Sends a keepalive if one is due. A keepalive that is not due returns
+ * success without touching the socket, so a session that already failed on
+ * its socket is also taken as dead. */
+static bool lv_libssh2_pool_alive(lv_libssh2_session_t *session) {
+  int next = 0;
+  if (libssh2_keepalive_send(session->inner, &next) != 0) {
+    return false;
+  }
+  switch (libssh2_session_last_errno(session->inner)) {
+  case LIBSSH2_ERROR_SOCKET_DISCONNECT:
+  case LIBSSH2_ERROR_SOCKET_SEND:
+  case LIBSSH2_ERROR_SOCKET_RECV:
+  case LIBSSH2_ERROR_SOCKET_TIMEOUT:
+    return false;
+  default:
+    return true;
+  }
+}
+
+static void lv_libssh2_pool_reap(void *context) {
+  lv_libssh2_pool_t *pool = context;
+  lv_libssh2_mutex_lock(&pool->mutex);
+  while (!pool->stopping) {
+    lv_libssh2_condition_timed_wait(&pool->changed, &pool->mutex,
+                                    REAPER_PERIOD);
+    size_t index = 0;
+    while (!pool->stopping && index < pool->entry_count) {
+      lv_libssh2_pool_entry_t *entry = pool->entries[index];
+      if (entry->leased || entry->pinging) {
+        index += 1;
+        continue;
+      }
+      bool expired = pool->idle_timeout > 0 &&
+                     lv_libssh2_time_elapsed(entry->last_used) / 1000 >=
+                         pool->idle_timeout;
+      if (!expired) {
+        /* The entry stays in the pool but cannot be leased or evicted while
+         * the keepalive is sent without the lock. */
+        entry->pinging = true;
+        lv_libssh2_mutex_unlock(&pool->mutex);
+        bool alive = lv_libssh2_pool_alive(entry->session);
+        lv_libssh2_mutex_lock(&pool->mutex);
+        entry->pinging = false;
+        lv_libssh2_condition_broadcast(&pool->changed);
+        if (alive) {
+          index += 1;
+          continue;
+        }
+        /* Other entries might have moved while the lock was released. */
+        for (index = 0; pool->entries[index] != entry; index++) {
+        }
+      }
+      lv_libssh2_pool_remove(pool, index);
+      lv_libssh2_mutex_unlock(&pool->mutex);
+      lv_libssh2_pool_discard(entry);
+      lv_libssh2_mutex_lock(&pool->mutex);
+    }
+  }
+  lv_libssh2_mutex_unlock(&pool->mutex);
+}
+
+lv_libssh2_status_t lv_libssh2_pool_create(const uint32_t idle_timeout,
+                                           lv_libssh2_pool_t **handle) {
+  *handle = NULL;
+  lv_libssh2_pool_t *pool = calloc(1, sizeof(lv_libssh2_pool_t));
+  if (pool == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  pool->idle_timeout = idle_timeout;
+  lv_libssh2_mutex_init(&pool->mutex);
+  lv_libssh2_condition_init(&pool->changed);
+  lv_libssh2_status_t status =
+      lv_libssh2_thread_start(&pool->reaper, lv_libssh2_pool_reap, pool);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_condition_destroy(&pool->changed);
+    lv_libssh2_mutex_destroy(&pool->mutex);
+    free(pool);
+    return status;
+  }
+  *handle = pool;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_pool_destroy(lv_libssh2_pool_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  handle->stopping = true;
+  lv_libssh2_condition_broadcast(&handle->changed);
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  lv_libssh2_thread_join(handle->reaper);
+  for (size_t i = 0; i < handle->entry_count; i++) {
+    lv_libssh2_pool_discard(handle->entries[i]);
+  }
+  free(handle->entries);
+  lv_libssh2_condition_destroy(&handle->changed);
+  lv_libssh2_mutex_destroy(&handle->mutex);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_pool_add(lv_libssh2_pool_t *handle,
+                                        const char *host, const int32_t port,
+                                        const char *user,
+                                        const char *fingerprint,
+                                        lv_libssh2_session_t *session) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (host == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (user == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (fingerprint == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (!libssh2_userauth_authenticated(session->inner)) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  lv_libssh2_pool_entry_t *entry = calloc(1, sizeof(lv_libssh2_pool_entry_t));
+  if (entry == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  entry->host = lv_libssh2_pool_copy(host);
+  entry->user = lv_libssh2_pool_copy(user);
+  entry->fingerprint = lv_libssh2_pool_copy(fingerprint);
+  if (entry->host == NULL || entry->user == NULL ||
+      entry->fingerprint == NULL) {
+    lv_libssh2_pool_entry_free(entry);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  entry->port = port;
+  entry->session = session;
+  entry->last_used = lv_libssh2_time_now();
+  libssh2_session_set_blocking(session->inner, 1);
+  libssh2_keepalive_config(session->inner, 0, KEEPALIVE_INTERVAL);
+  lv_libssh2_mutex_lock(&handle->mutex);
+  if (handle->entry_count == handle->entry_capacity) {
+    size_t capacity =
+        handle->entry_capacity == 0 ? 4 : handle->entry_capacity * 2;
+    lv_libssh2_pool_entry_t **entries =
+        realloc(handle->entries, capacity * sizeof(lv_libssh2_pool_entry_t *));
+    if (entries == NULL) {
+      lv_libssh2_mutex_unlock(&handle->mutex);
+      lv_libssh2_pool_entry_free(entry);
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    handle->entries = entries;
+    handle->entry_capacity = capacity;
+  }
+  handle->entries[handle->entry_count] = entry;
+  handle->entry_count += 1;
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_pool_channel_open(
+    lv_libssh2_pool_t *handle, const char *host, const int32_t port,
+    const char *user, const char *fingerprint, lv_libssh2_channel_t **channel) {
+  *channel = NULL;
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (host == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (user == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (fingerprint == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  for (;;) {
+    lv_libssh2_pool_entry_t *entry = NULL;
+    bool pinging = false;
+    for (size_t i = 0; i < handle->entry_count; i++) {
+      lv_libssh2_pool_entry_t *candidate = handle->entries[i];
+      if (candidate->leased ||
+          !lv_libssh2_pool_matches(candidate, host, port, user, fingerprint)) {
+        continue;
+      }
+      if (candidate->pinging) {
+        pinging = true;
+        continue;
+      }
+      entry = candidate;
+      break;
+    }
+    if (entry == NULL && pinging) {
+      /* A matching session is only briefly busy with a keepalive. */
+      lv_libssh2_condition_wait(&handle->changed, &handle->mutex);
+      continue;
+    }
+    if (entry == NULL) {
+      handle->miss_count += 1;
+      lv_libssh2_mutex_unlock(&handle->mutex);
+      return LV_LIBSSH2_STATUS_ERROR_POOL_MISS;
+    }
+    entry->leased = true;
+    lv_libssh2_mutex_unlock(&handle->mutex);
+    lv_libssh2_channel_t *opened = NULL;
+    lv_libssh2_status_t status =
+        lv_libssh2_channel_create(entry->session, &opened);
+    lv_libssh2_mutex_lock(&handle->mutex);
+    if (lv_libssh2_status_is_ok(status)) {
+      entry->lease = opened;
+      handle->hit_count += 1;
+      lv_libssh2_mutex_unlock(&handle->mutex);
+      *channel = opened;
+      return LV_LIBSSH2_STATUS_OK;
+    }
+    /* The server dropped the connection while it was idle. */
+    for (size_t i = 0; i < handle->entry_count; i++) {
+      if (handle->entries[i] == entry) {
+        lv_libssh2_pool_remove(handle, i);
+        break;
+      }
+    }
+    lv_libssh2_mutex_unlock(&handle->mutex);
+    lv_libssh2_pool_discard(entry);
+    lv_libssh2_mutex_lock(&handle->mutex);
+  }
+}
+
+lv_libssh2_status_t
+lv_libssh2_pool_channel_release(lv_libssh2_pool_t *handle,
+                                lv_libssh2_channel_t *channel) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (channel == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  lv_libssh2_pool_entry_t *entry = NULL;
+  for (size_t i = 0; i < handle->entry_count; i++) {
+    if (handle->entries[i]->lease == channel) {
+      entry = handle->entries[i];
+      break;
+    }
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  if (entry == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  int result = lv_libssh2_channel_free(channel);
+  lv_libssh2_mutex_lock(&handle->mutex);
+  entry->lease = NULL;
+  if (result == 0) {
+    entry->leased = false;
+    entry->last_used = lv_libssh2_time_now();
+    lv_libssh2_mutex_unlock(&handle->mutex);
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  for (size_t i = 0; i < handle->entry_count; i++) {
+    if (handle->entries[i] == entry) {
+      lv_libssh2_pool_remove(handle, i);
+      break;
+    }
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  lv_libssh2_pool_discard(entry);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_pool_evict_idle(lv_libssh2_pool_t *handle,
+                                               size_t *evicted) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (evicted == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *evicted = 0;
+  lv_libssh2_mutex_lock(&handle->mutex);
+  size_t index = 0;
+  while (index < handle->entry_count) {
+    lv_libssh2_pool_entry_t *entry = handle->entries[index];
+    if (entry->leased || entry->pinging) {
+      index += 1;
+      continue;
+    }
+    lv_libssh2_pool_remove(handle, index);
+    *evicted += 1;
+    lv_libssh2_mutex_unlock(&handle->mutex);
+    lv_libssh2_pool_discard(entry);
+    lv_libssh2_mutex_lock(&handle->mutex);
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_pool_statistics(lv_libssh2_pool_t *handle,
+                                               size_t *idle, size_t *leased,
+                                               uint64_t *hits,
+                                               uint64_t *misses,
+                                               uint64_t *evictions) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (idle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (leased == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (hits == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (misses == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (evictions == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  *leased = 0;
+  for (size_t i = 0; i < handle->entry_count; i++) {
+    if (handle->entries[i]->leased) {
+      *leased += 1;
+    }
+  }
+  *idle = handle->entry_count - *leased;
+  *hits = handle->hit_count;
+  *misses = handle->miss_count;
+  *evictions = handle->evicted_count;
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
@@ -0,0 +1,64 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_PROGRESS_PRIVATE_H
+#define LV_LIBSSH2_PROGRESS_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+struct _lv_libssh2_progress {
+  lv_libssh2_mutex_t mutex;
+  uint64_t byte_count;
+  uint64_t total;
+  bool cancelled;
+};
+
+/**
+ * Resets the byte count and sets the total for a new transfer. Does nothing
+ * if the progress is `NULL`.
+ */
+void lv_libssh2_progress_start(lv_libssh2_progress_t *progress,
+                               const uint64_t total);
+
+/**
+ * Sets the byte count, returning `false` if the transfer has been cancelled.
+ * Does nothing and returns `true` if the progress is `NULL`.
+ */
+bool lv_libssh2_progress_update(lv_libssh2_progress_t *progress,
+                                const uint64_t byte_count);
+
+#endif
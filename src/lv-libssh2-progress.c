@@ -0,0 +1,114 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "lv-libssh2-progress-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+lv_libssh2_status_t lv_libssh2_progress_create(lv_libssh2_progress_t **handle) {
+  *handle = NULL;
+  lv_libssh2_progress_t *progress = malloc(sizeof(lv_libssh2_progress_t));
+  if (progress == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  lv_libssh2_mutex_init(&progress->mutex);
+  progress->byte_count = 0;
+  progress->total = 0;
+  progress->cancelled = false;
+  *handle = progress;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_progress_destroy(lv_libssh2_progress_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_destroy(&handle->mutex);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_progress_get(lv_libssh2_progress_t *handle,
+                                            uint64_t *byte_count,
+                                            uint64_t *total) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (total == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  *byte_count = handle->byte_count;
+  *total = handle->total;
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_progress_cancel(lv_libssh2_progress_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  handle->cancelled = true;
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+void lv_libssh2_progress_start(lv_libssh2_progress_t *progress,
+                               const uint64_t total) {
+  if (progress == NULL) {
+    return;
+  }
+  lv_libssh2_mutex_lock(&progress->mutex);
+  progress->byte_count = 0;
+  progress->total = total;
+  lv_libssh2_mutex_unlock(&progress->mutex);
+}
+
+bool lv_libssh2_progress_update(lv_libssh2_progress_t *progress,
+                                const uint64_t byte_count) {
+  if (progress == NULL) {
+    return true;
+  }
+  lv_libssh2_mutex_lock(&progress->mutex);
+  progress->byte_count = byte_count;
+  bool cancelled = progress->cancelled;
+  lv_libssh2_mutex_unlock(&progress->mutex);
+  return !cancelled;
+}
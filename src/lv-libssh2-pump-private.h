@@ -0,0 +1,105 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_PUMP_PRIVATE_H
+#define LV_LIBSSH2_PUMP_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2-ring-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+typedef struct _lv_libssh2_pump lv_libssh2_pump_t;
+
+/**
+ * The queues of a pumped channel.
+ *
+ * The pump is `NULL` once the pump has stopped, after which the remaining
+ * incoming data is still read from the queues before reading the channel
+ * directly again.
+ */
+typedef struct _lv_libssh2_channel_queues {
+  lv_libssh2_pump_t *pump;
+  lv_libssh2_ring_t incoming;
+  lv_libssh2_ring_t incoming_stderr;
+  lv_libssh2_ring_t outgoing;
+  bool paused;
+  bool eof;
+  int error;
+} lv_libssh2_channel_queues_t;
+
+struct _lv_libssh2_pump {
+  lv_libssh2_session_t *session;
+  lv_libssh2_mutex_t mutex;
+  lv_libssh2_condition_t changed;
+  lv_libssh2_thread_t thread;
+  lv_libssh2_channel_t **channels;
+  size_t channel_count;
+  size_t channel_capacity;
+  size_t queue_capacity;
+  size_t high_watermark;
+  size_t low_watermark;
+  int blocking;
+  bool stopping;
+};
+
+/**
+ * Reads from the queue of the stream instead of the channel.
+ *
+ * Returns `false` if the channel should be read directly, because the pump
+ * has stopped and its queues are empty.
+ */
+bool lv_libssh2_pump_read(lv_libssh2_channel_t *channel, const int stream,
+                          char *buffer, const size_t buffer_len,
+                          size_t *byte_count, lv_libssh2_status_t *status);
+
+/**
+ * Writes to the outgoing queue instead of the channel.
+ *
+ * Returns `false` if the channel should be written directly, because the pump
+ * has stopped.
+ */
+bool lv_libssh2_pump_write(lv_libssh2_channel_t *channel, const char *buffer,
+                           const size_t buffer_len, size_t *byte_count,
+                           lv_libssh2_status_t *status);
+
+/**
+ * Removes the channel from its pump, frees the inner channel while no pump
+ * can use the session, and frees the queues. Returns the result of freeing
+ * the inner channel.
+ */
+int lv_libssh2_pump_release(lv_libssh2_channel_t *channel);
+
+#endif
@@ -0,0 +1,467 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-channel-private.h"
+#include "lv-libssh2-pump-private.h"
+#include "lv-libssh2-ring-private.h"
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-socket-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+#define DEFAULT_QUEUE_CAPACITY 262144
+#define WAIT_PERIOD 10
+#define IDLE_PERIOD 100
+
+static size_t lv_libssh2_pump_copy_out(lv_libssh2_ring_t *ring, char *buffer,
+                                       const size_t buffer_len) {
+  size_t copied = 0;
+  while (copied < buffer_len) {
+    size_t offset = 0;
+    size_t len = 0;
+    lv_libssh2_ring_read_span(ring, &offset, &len);
+    if (len == 0) {
+      break;
+    }
+    if (len > buffer_len - copied) {
+      len = buffer_len - copied;
+    }
+    memcpy(buffer + copied, ring->data + offset, len);
+    lv_libssh2_ring_consume(ring, len);
+    copied += len;
+  }
+  return copied;
+}
+
+static size_t lv_libssh2_pump_copy_in(lv_libssh2_ring_t *ring,
+                                      const char *buffer,
+                                      const size_t buffer_len) {
+  size_t copied = 0;
+  while (copied < buffer_len) {
+    size_t offset = 0;
+    size_t len = 0;
+    lv_libssh2_ring_write_span(ring, &offset, &len);
+    if (len == 0) {
+      break;
+    }
+    if (len > buffer_len - copied) {
+      len = buffer_len - copied;
+    }
+    memcpy(ring->data + offset, buffer + copied, len);
+    lv_libssh2_ring_produce(ring, len);
+    copied += len;
+  }
+  return copied;
+}
+
+static void lv_libssh2_pump_queues_free(lv_libssh2_channel_queues_t *queues) {
+  lv_libssh2_ring_release(&queues->incoming);
+  lv_libssh2_ring_release(&queues->incoming_stderr);
+  lv_libssh2_ring_release(&queues->outgoing);
+  free(queues);
+}
+
+/* Reads the stream into its queue until the queue is full or the channel has
+ * nothing more to give without blocking. */
+static bool lv_libssh2_pump_fill(lv_libssh2_channel_t *channel,
+                                 const int stream, lv_libssh2_ring_t *ring) {
+  bool progressed = false;
+  for (;;) {
+    size_t offset = 0;
+    size_t len = 0;
+    lv_libssh2_ring_write_span(ring, &offset, &len);
+    if (len == 0) {
+      break;
+    }
+    ssize_t result = libssh2_channel_read_ex(
+        channel->inner, stream, (char *)ring->data + offset, len);
+    if (result <= 0) {
+      if (result < 0 && result != LIBSSH2_ERROR_EAGAIN) {
+        channel->queues->error = (int)result;
+      }
+      break;
+    }
+    lv_libssh2_ring_produce(ring, (size_t)result);
+    lv_libssh2_channel_autotune(channel, (size_t)result);
+    progressed = true;
+  }
+  return progressed;
+}
+
+static bool lv_libssh2_pump_drain(lv_libssh2_channel_t *channel) {
+  lv_libssh2_channel_queues_t *queues = channel->queues;
+  bool progressed = false;
+  while (queues->error == 0) {
+    size_t offset = 0;
+    size_t len = 0;
+    lv_libssh2_ring_read_span(&queues->outgoing, &offset, &len);
+    if (len == 0) {
+      break;
+    }
+    ssize_t result = libssh2_channel_write_ex(
+        channel->inner, 0, (const char *)queues->outgoing.data + offset, len);
+    if (result < 0) {
+      if (result != LIBSSH2_ERROR_EAGAIN) {
+        queues->error = (int)result;
+      }
+      break;
+    }
+    lv_libssh2_ring_consume(&queues->outgoing, (size_t)result);
+    progressed = true;
+  }
+  return progressed;
+}
+
+static bool lv_libssh2_pump_channel(lv_libssh2_pump_t *pump,
+                                    lv_libssh2_channel_t *channel) {
+  lv_libssh2_channel_queues_t *queues = channel->queues;
+  bool progressed = false;
+  if (queues->error == 0 && !queues->eof && !queues->paused) {
+    progressed |= lv_libssh2_pump_fill(channel, 0, &queues->incoming);
+    progressed |= lv_libssh2_pump_fill(channel, SSH_EXTENDED_DATA_STDERR,
+                                       &queues->incoming_stderr);
+    if (lv_libssh2_ring_used(&queues->incoming) >= pump->high_watermark) {
+      /* Leaving the data unread stops the receive window from being
+       * replenished, which in turn stops the server from sending. */
+      queues->paused = true;
+    }
+    if (libssh2_channel_eof(channel->inner) == 1) {
+      queues->eof = true;
+      progressed = true;
+    }
+  }
+  progressed |= lv_libssh2_pump_drain(channel);
+  return progressed || queues->error != 0;
+}
+
+static bool lv_libssh2_pump_busy(lv_libssh2_pump_t *pump) {
+  for (size_t i = 0; i < pump->channel_count; i++) {
+    lv_libssh2_channel_queues_t *queues = pump->channels[i]->queues;
+    if (queues->error != 0) {
+      continue;
+    }
+    if ((!queues->eof && !queues->paused) ||
+        lv_libssh2_ring_used(&queues->outgoing) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void lv_libssh2_pump_run(void *context) {
+  lv_libssh2_pump_t *pump = context;
+  lv_libssh2_session_t *session = pump->session;
+  lv_libssh2_mutex_lock(&pump->mutex);
+  while (!pump->stopping) {
+    bool progressed = false;
+    for (size_t i = 0; i < pump->channel_count; i++) {
+      progressed |= lv_libssh2_pump_channel(pump, pump->channels[i]);
+    }
+    if (progressed) {
+      lv_libssh2_condition_broadcast(&pump->changed);
+      continue;
+    }
+    if (!lv_libssh2_pump_busy(pump)) {
+      lv_libssh2_condition_timed_wait(&pump->changed, &pump->mutex,
+                                      IDLE_PERIOD);
+      continue;
+    }
+    int directions = libssh2_session_block_directions(session->inner);
+    lv_libssh2_mutex_unlock(&pump->mutex);
+    lv_libssh2_socket_wait(session->socket, true,
+                           (directions & LIBSSH2_SESSION_BLOCK_OUTBOUND) != 0,
+                           WAIT_PERIOD);
+    lv_libssh2_mutex_lock(&pump->mutex);
+  }
+  lv_libssh2_mutex_unlock(&pump->mutex);
+}
+
+bool lv_libssh2_pump_read(lv_libssh2_channel_t *channel, const int stream,
+                          char *buffer, const size_t buffer_len,
+                          size_t *byte_count, lv_libssh2_status_t *status) {
+  lv_libssh2_channel_queues_t *queues = channel->queues;
+  lv_libssh2_pump_t *pump = queues->pump;
+  lv_libssh2_ring_t *ring =
+      stream == 0 ? &queues->incoming : &queues->incoming_stderr;
+  *status = LV_LIBSSH2_STATUS_OK;
+  if (pump == NULL) {
+    *byte_count = lv_libssh2_pump_copy_out(ring, buffer, buffer_len);
+    if (*byte_count > 0) {
+      return true;
+    }
+    if (lv_libssh2_ring_used(&queues->incoming) == 0 &&
+        lv_libssh2_ring_used(&queues->incoming_stderr) == 0) {
+      channel->queues = NULL;
+      lv_libssh2_pump_queues_free(queues);
+    }
+    return false;
+  }
+  lv_libssh2_mutex_lock(&pump->mutex);
+  while (lv_libssh2_ring_used(ring) == 0 && !queues->eof &&
+         queues->error == 0 && pump->blocking) {
+    lv_libssh2_condition_wait(&pump->changed, &pump->mutex);
+  }
+  *byte_count = lv_libssh2_pump_copy_out(ring, buffer, buffer_len);
+  if (*byte_count == 0 && queues->error != 0) {
+    *status = lv_libssh2_status_from_result(queues->error);
+  } else if (*byte_count == 0 && !queues->eof) {
+    *status = LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+  }
+  if (queues->paused &&
+      lv_libssh2_ring_used(&queues->incoming) <= pump->low_watermark) {
+    queues->paused = false;
+    lv_libssh2_condition_broadcast(&pump->changed);
+  }
+  lv_libssh2_mutex_unlock(&pump->mutex);
+  return true;
+}
+
+bool lv_libssh2_pump_write(lv_libssh2_channel_t *channel, const char *buffer,
+                           const size_t buffer_len, size_t *byte_count,
+                           lv_libssh2_status_t *status) {
+  lv_libssh2_channel_queues_t *queues = channel->queues;
+  lv_libssh2_pump_t *pump = queues->pump;
+  *status = LV_LIBSSH2_STATUS_OK;
+  if (pump == NULL) {
+    return false;
+  }
+  lv_libssh2_mutex_lock(&pump->mutex);
+  while (lv_libssh2_ring_available(&queues->outgoing) == 0 &&
+         queues->error == 0 && pump->blocking) {
+    lv_libssh2_condition_wait(&pump->changed, &pump->mutex);
+  }
+  if (queues->error != 0) {
+    *byte_count = 0;
+    *status = lv_libssh2_status_from_result(queues->error);
+  } else {
+    *byte_count =
+        lv_libssh2_pump_copy_in(&queues->outgoing, buffer, buffer_len);
+    if (*byte_count == 0 && buffer_len > 0) {
+      *status = LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+    }
+  }
+  lv_libssh2_mutex_unlock(&pump->mutex);
+  return true;
+}
+
+int lv_libssh2_pump_release(lv_libssh2_channel_t *channel) {
+  lv_libssh2_channel_queues_t *queues = channel->queues;
+  lv_libssh2_pump_t *pump = queues->pump;
+  int result = 0;
+  if (pump == NULL) {
+    result = libssh2_channel_free(channel->inner);
+  } else {
+    lv_libssh2_mutex_lock(&pump->mutex);
+    for (size_t i = 0; i < pump->channel_count; i++) {
+      if (pump->channels[i] == channel) {
+        pump->channel_count -= 1;
+        pump->channels[i] = pump->channels[pump->channel_count];
+        break;
+      }
+    }
+    LIBSSH2_SESSION *session = pump->session->inner;
+    libssh2_session_set_blocking(session, 1);
+    result = libssh2_channel_free(channel->inner);
+    libssh2_session_set_blocking(session, 0);
+    lv_libssh2_mutex_unlock(&pump->mutex);
+  }
+  channel->queues = NULL;
+  lv_libssh2_pump_queues_free(queues);
+  return result;
+}
+
+lv_libssh2_status_t lv_libssh2_session_pump_start(lv_libssh2_session_t *handle,
+                                                  const size_t queue_capacity,
+                                                  const size_t high_watermark,
+                                                  const size_t low_watermark) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->pump != NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  if (handle->socket == LV_LIBSSH2_SOCKET_INVALID) {
+    return LV_LIBSSH2_STATUS_ERROR_SOCKET_NONE;
+  }
+  lv_libssh2_pump_t *pump = calloc(1, sizeof(lv_libssh2_pump_t));
+  if (pump == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  pump->session = handle;
+  pump->queue_capacity =
+      queue_capacity == 0 ? DEFAULT_QUEUE_CAPACITY : queue_capacity;
+  pump->high_watermark = high_watermark == 0 ? pump->queue_capacity
+                                             : high_watermark;
+  pump->low_watermark =
+      low_watermark == 0 ? pump->high_watermark / 2 : low_watermark;
+  if (pump->low_watermark >= pump->high_watermark) {
+    free(pump);
+    return LV_LIBSSH2_STATUS_ERROR_INVALID;
+  }
+  pump->blocking = libssh2_session_get_blocking(handle->inner);
+  lv_libssh2_mutex_init(&pump->mutex);
+  lv_libssh2_condition_init(&pump->changed);
+  libssh2_session_set_blocking(handle->inner, 0);
+  lv_libssh2_status_t status =
+      lv_libssh2_thread_start(&pump->thread, lv_libssh2_pump_run, pump);
+  if (lv_libssh2_status_is_err(status)) {
+    libssh2_session_set_blocking(handle->inner, pump->blocking);
+    lv_libssh2_condition_destroy(&pump->changed);
+    lv_libssh2_mutex_destroy(&pump->mutex);
+    free(pump);
+    return status;
+  }
+  handle->pump = pump;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_session_pump_stop(lv_libssh2_session_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_pump_t *pump = handle->pump;
+  if (pump == NULL) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  lv_libssh2_mutex_lock(&pump->mutex);
+  pump->stopping = true;
+  lv_libssh2_condition_broadcast(&pump->changed);
+  lv_libssh2_mutex_unlock(&pump->mutex);
+  lv_libssh2_thread_join(pump->thread);
+  libssh2_session_set_blocking(handle->inner, 1);
+  for (size_t i = 0; i < pump->channel_count; i++) {
+    lv_libssh2_channel_t *channel = pump->channels[i];
+    lv_libssh2_pump_drain(channel);
+    channel->queues->pump = NULL;
+  }
+  libssh2_session_set_blocking(handle->inner, pump->blocking);
+  free(pump->channels);
+  lv_libssh2_condition_destroy(&pump->changed);
+  lv_libssh2_mutex_destroy(&pump->mutex);
+  free(pump);
+  handle->pump = NULL;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_channel_pump(lv_libssh2_channel_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_pump_t *pump = handle->session->pump;
+  if (pump == NULL || handle->queues != NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  lv_libssh2_channel_queues_t *queues =
+      calloc(1, sizeof(lv_libssh2_channel_queues_t));
+  if (queues == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  if (lv_libssh2_status_is_err(lv_libssh2_ring_allocate(
+          &queues->incoming, pump->queue_capacity)) ||
+      lv_libssh2_status_is_err(lv_libssh2_ring_allocate(
+          &queues->incoming_stderr, pump->queue_capacity)) ||
+      lv_libssh2_status_is_err(
+          lv_libssh2_ring_allocate(&queues->outgoing, pump->queue_capacity))) {
+    lv_libssh2_pump_queues_free(queues);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  queues->pump = pump;
+  lv_libssh2_mutex_lock(&pump->mutex);
+  if (pump->channel_count == pump->channel_capacity) {
+    size_t capacity =
+        pump->channel_capacity == 0 ? 4 : pump->channel_capacity * 2;
+    lv_libssh2_channel_t **channels =
+        realloc(pump->channels, capacity * sizeof(lv_libssh2_channel_t *));
+    if (channels == NULL) {
+      lv_libssh2_mutex_unlock(&pump->mutex);
+      lv_libssh2_pump_queues_free(queues);
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    pump->channels = channels;
+    pump->channel_capacity = capacity;
+  }
+  handle->queues = queues;
+  pump->channels[pump->channel_count] = handle;
+  pump->channel_count += 1;
+  lv_libssh2_condition_broadcast(&pump->changed);
+  lv_libssh2_mutex_unlock(&pump->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_channel_pump_depth(lv_libssh2_channel_t *handle,
+                                                  size_t *read_depth,
+                                                  size_t *stderr_depth,
+                                                  size_t *write_depth,
+                                                  bool *paused) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (read_depth == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (stderr_depth == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (write_depth == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (paused == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_channel_queues_t *queues = handle->queues;
+  if (queues == NULL) {
+    *read_depth = 0;
+    *stderr_depth = 0;
+    *write_depth = 0;
+    *paused = false;
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  if (queues->pump != NULL) {
+    lv_libssh2_mutex_lock(&queues->pump->mutex);
+  }
+  *read_depth = lv_libssh2_ring_used(&queues->incoming);
+  *stderr_depth = lv_libssh2_ring_used(&queues->incoming_stderr);
+  *write_depth = lv_libssh2_ring_used(&queues->outgoing);
+  *paused = queues->paused;
+  if (queues->pump != NULL) {
+    lv_libssh2_mutex_unlock(&queues->pump->mutex);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
@@ -0,0 +1,96 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_RING_PRIVATE_H
+#define LV_LIBSSH2_RING_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2.h"
+
+/**
+ * A single-producer, single-consumer byte ring over a contiguous buffer.
+ *
+ * The head and tail only ever increase, so the used size is their
+ * difference, and positions are reduced modulo the capacity when indexing.
+ */
+typedef struct _lv_libssh2_ring {
+  uint8_t *data;
+  size_t capacity;
+  uint64_t head;
+  uint64_t tail;
+  bool owned;
+} lv_libssh2_ring_t;
+
+/**
+ * Allocates a page-aligned buffer of at least the capacity, rounded up to a
+ * whole number of pages.
+ */
+lv_libssh2_status_t lv_libssh2_ring_allocate(lv_libssh2_ring_t *ring,
+                                             const size_t capacity);
+
+/**
+ * Checks that the buffer starts on a page boundary.
+ */
+bool lv_libssh2_ring_is_aligned(const uint8_t *buffer);
+
+/**
+ * Uses the caller's buffer, which must outlive the ring.
+ */
+void lv_libssh2_ring_attach(lv_libssh2_ring_t *ring, uint8_t *buffer,
+                            const size_t capacity);
+
+void lv_libssh2_ring_release(lv_libssh2_ring_t *ring);
+
+size_t lv_libssh2_ring_used(const lv_libssh2_ring_t *ring);
+
+size_t lv_libssh2_ring_available(const lv_libssh2_ring_t *ring);
+
+/**
+ * Gets the contiguous free region at the head.
+ */
+void lv_libssh2_ring_write_span(const lv_libssh2_ring_t *ring, size_t *offset,
+                                size_t *len);
+
+void lv_libssh2_ring_produce(lv_libssh2_ring_t *ring, const size_t len);
+
+/**
+ * Gets the contiguous used region at the tail.
+ */
+void lv_libssh2_ring_read_span(const lv_libssh2_ring_t *ring, size_t *offset,
+                               size_t *len);
+
+void lv_libssh2_ring_consume(lv_libssh2_ring_t *ring, const size_t len);
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "lv-libssh2-ring-private.h"
+#include "lv-libssh2.h"
+
+static size_t lv_libssh2_ring_page_size() {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (size_t)info.dwPageSize;
+#else
+  long size = sysconf(_SC_PAGESIZE);
+  return size > 0 ? (size_t)size : 4096;
+#endif
+}
+
+lv_libssh2_status_t lv_libssh2_ring_allocate(lv_libssh2_ring_t *ring,
+                                             const size_t capacity) {
+  const size_t page = lv_libssh2_ring_page_size();
+  size_t rounded = ((capacity + page - 1) / page) * page;
+  if (rounded == 0) {
+    rounded = page;
+  }
+  void *data = NULL;
+#ifdef _WIN32
+  data = _aligned_malloc(rounded, page);
+#else
+  if (posix_memalign(&data, page, rounded) != 0) {
+    data = NULL;
+  }
+#endif
+  if (data == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  ring->data = data;
+  ring->capacity = rounded;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->owned = true;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+bool lv_libssh2_ring_is_aligned(const uint8_t *buffer) {
+  return (uintptr_t)buffer % lv_libssh2_ring_page_size() == 0;
+}
+
+void lv_libssh2_ring_attach(lv_libssh2_ring_t *ring, uint8_t *buffer,
+                            const size_t capacity) {
+  ring->data = buffer;
+  ring->capacity = capacity;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->owned = false;
+}
+
+void lv_libssh2_ring_release(lv_libssh2_ring_t *ring) {
+  if (ring->owned) {
+#ifdef _WIN32
+    _aligned_free(ring->data);
+#else
+    free(ring->data);
+#endif
+  }
+  ring->data = NULL;
+  ring->capacity = 0;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->owned = false;
+}
+
+size_t lv_libssh2_ring_used(const lv_libssh2_ring_t *ring) {
+  return (size_t)(ring->head - ring->tail);
+}
+
+size_t lv_libssh2_ring_available(const lv_libssh2_ring_t *ring) {
+  return ring->capacity - lv_libssh2_ring_used(ring);
+}
+
+void lv_libssh2_ring_write_span(const lv_libssh2_ring_t *ring, size_t *offset,
+                                size_t *len) {
+  *offset = (size_t)(ring->head % ring->capacity);
+  size_t contiguous = ring->capacity - *offset;
+  size_t available = lv_libssh2_ring_available(ring);
+  *len = available < contiguous ? available : contiguous;
+}
+
+void lv_libssh2_ring_produce(lv_libssh2_ring_t *ring, const size_t len) {
+  ring->head += len;
+}
+
+void lv_libssh2_ring_read_span(const lv_libssh2_ring_t *ring, size_t *offset,
+                               size_t *len) {
+  *offset = (size_t)(ring->tail % ring->capacity);
+  size_t contiguous = ring->capacity - *offset;
+  size_t used = lv_libssh2_ring_used(ring);
+  *len = used < contiguous ? used : contiguous;
+}
+
+void lv_libssh2_ring_consume(lv_libssh2_ring_t *ring, const size_t len) {
+  ring->tail += len;
+}
@@ -38,10 +38,14 @@
 
 #include "lv-libssh2-channel-private.h"
 #include "lv-libssh2-fileinfo-private.h"
+#include "lv-libssh2-mapping-private.h"
+#include "lv-libssh2-progress-private.h"
 #include "lv-libssh2-session-private.h"
 #include "lv-libssh2-status-private.h"
 #include "lv-libssh2.h"
 
+#define DOWNLOAD_WINDOW_ADJUSTMENT 16777216
+
 lv_libssh2_status_t lv_libssh2_scp_send(lv_libssh2_session_t *session,
                                         const char *path, const int permissions,
                                         const size_t file_size,
@@ -59,14 +63,7 @@ lv_libssh2_status_t lv_libssh2_scp_send(lv_libssh2_session_t *session,
     return lv_libssh2_status_from_result(
         libssh2_session_last_errno(session->inner));
   }
-  lv_libssh2_channel_t *channel = malloc(sizeof(lv_libssh2_channel_t));
-  if (channel == NULL) {
-    libssh2_channel_free(inner);
-    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
-  }
-  channel->inner = inner;
-  *handle = channel;
-  return LV_LIBSSH2_STATUS_OK;
+  return lv_libssh2_channel_wrap(session, inner, handle);
 }
 
 lv_libssh2_status_t lv_libssh2_scp_receive(lv_libssh2_session_t *session,
@@ -89,12 +86,266 @@ lv_libssh2_status_t lv_libssh2_scp_receive(lv_libssh2_session_t *session,
     return lv_libssh2_status_from_result(
         libssh2_session_last_errno(session->inner));
   }
-  lv_libssh2_channel_t *channel = malloc(sizeof(lv_libssh2_channel_t));
+  return lv_libssh2_channel_wrap(session, inner, handle);
+}
+
+/* Writes the whole local file to the channel, straight from mapped views. */
+static lv_libssh2_status_t lv_libssh2_scp_write_mapping(
+    LIBSSH2_CHANNEL *channel, lv_libssh2_mapping_t *local,
+    lv_libssh2_progress_t *progress, uint64_t *byte_count) {
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  uint8_t *view = NULL;
+  size_t view_len = 0;
+  size_t start = 0;
+  while (lv_libssh2_status_is_ok(status)) {
+    if (start == view_len) {
+      status = lv_libssh2_mapping_map(local, *byte_count,
+                                      LV_LIBSSH2_MAPPING_VIEW_SIZE, &view,
+                                      &view_len);
+      if (lv_libssh2_status_is_err(status) || view_len == 0) {
+        break;
+      }
+      start = 0;
+    }
+    ssize_t count = libssh2_channel_write(channel, (const char *)view + start,
+                                          view_len - start);
+    if (count < 0) {
+      status = lv_libssh2_status_from_result((int)count);
+      break;
+    }
+    start += (size_t)count;
+    *byte_count += (uint64_t)count;
+    if (!lv_libssh2_progress_update(progress, *byte_count)) {
+      status = LV_LIBSSH2_STATUS_ERROR_CANCELLED;
+    }
+  }
+  return status;
+}
+
+/* Reads exactly the size of the file from the channel into mapped views of
+ * the local file. The channel carries a status byte after the file, so
+ * reading up to the end of the channel would take it as data. */
+static lv_libssh2_status_t
+lv_libssh2_scp_read_mapping(LIBSSH2_CHANNEL *channel,
+                            lv_libssh2_channel_t *owner,
+                            lv_libssh2_mapping_t *local, const uint64_t size,
+                            lv_libssh2_progress_t *progress,
+                            uint64_t *byte_count) {
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  uint8_t *view = NULL;
+  size_t view_len = 0;
+  size_t start = 0;
+  while (lv_libssh2_status_is_ok(status) && *byte_count < size) {
+    if (start == view_len) {
+      status = lv_libssh2_mapping_map(local, *byte_count,
+                                      LV_LIBSSH2_MAPPING_VIEW_SIZE, &view,
+                                      &view_len);
+      if (lv_libssh2_status_is_err(status)) {
+        break;
+      }
+      start = 0;
+    }
+    ssize_t count =
+        libssh2_channel_read(channel, (char *)view + start, view_len - start);
+    if (count < 0) {
+      status = lv_libssh2_status_from_result((int)count);
+      break;
+    }
+    if (count == 0) {
+      if (libssh2_channel_eof(channel)) {
+        status = LV_LIBSSH2_STATUS_ERROR_SCP_PROTOCOL;
+      }
+      continue;
+    }
+    if (owner != NULL) {
+      lv_libssh2_channel_autotune(owner, (size_t)count);
+    }
+    start += (size_t)count;
+    *byte_count += (uint64_t)count;
+    if (!lv_libssh2_progress_update(progress, *byte_count)) {
+      status = LV_LIBSSH2_STATUS_ERROR_CANCELLED;
+    }
+  }
+  return status;
+}
+
+/* Closes a local file written by a transfer, cutting it to the data that
+ * arrived, and returns the first error. */
+static lv_libssh2_status_t
+lv_libssh2_scp_close_mapping(lv_libssh2_mapping_t *local,
+                             const uint64_t byte_count,
+                             lv_libssh2_status_t status) {
+  lv_libssh2_status_t result = LV_LIBSSH2_STATUS_OK;
+  if (local->size != byte_count) {
+    result = lv_libssh2_mapping_resize(local, byte_count);
+  }
+  if (lv_libssh2_status_is_ok(result)) {
+    result = lv_libssh2_mapping_close(local);
+  } else {
+    lv_libssh2_mapping_close(local);
+  }
+  return lv_libssh2_status_is_ok(status) ? result : status;
+}
+
+lv_libssh2_status_t lv_libssh2_scp_send_file(lv_libssh2_channel_t *handle,
+                                             const char *local_path,
+                                             uint64_t *byte_count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *byte_count = 0;
+  lv_libssh2_mapping_t local;
+  lv_libssh2_status_t status =
+      lv_libssh2_mapping_open_read(&local, local_path);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  /* The transfer runs natively, so the session blocks until it completes. */
+  LIBSSH2_SESSION *session = handle->session->inner;
+  int blocking = libssh2_session_get_blocking(session);
+  libssh2_session_set_blocking(session, 1);
+  status =
+      lv_libssh2_scp_write_mapping(handle->inner, &local, NULL, byte_count);
+  libssh2_session_set_blocking(session, blocking);
+  lv_libssh2_mapping_close(&local);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_scp_receive_file(
+    lv_libssh2_channel_t *handle, lv_libssh2_fileinfo_t *file_info,
+    const char *local_path, uint64_t *byte_count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (file_info == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *byte_count = 0;
+  const uint64_t size = (uint64_t)file_info->inner->st_size;
+  lv_libssh2_mapping_t local;
+  lv_libssh2_status_t status =
+      lv_libssh2_mapping_open_write(&local, local_path, size);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  LIBSSH2_SESSION *session = handle->session->inner;
+  int blocking = libssh2_session_get_blocking(session);
+  libssh2_session_set_blocking(session, 1);
+  status = lv_libssh2_scp_read_mapping(handle->inner, handle, &local, size,
+                                       NULL, byte_count);
+  libssh2_session_set_blocking(session, blocking);
+  return lv_libssh2_scp_close_mapping(&local, *byte_count, status);
+}
+
+lv_libssh2_status_t lv_libssh2_scp_upload_file(
+    lv_libssh2_session_t *session, const char *local_path,
+    const char *remote_path, const int32_t permissions,
+    lv_libssh2_progress_t *progress, uint64_t *byte_count) {
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *byte_count = 0;
+  lv_libssh2_mapping_t local;
+  lv_libssh2_status_t status =
+      lv_libssh2_mapping_open_read(&local, local_path);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_progress_start(progress, local.size);
+  int blocking = libssh2_session_get_blocking(session->inner);
+  libssh2_session_set_blocking(session->inner, 1);
+  LIBSSH2_CHANNEL *channel = libssh2_scp_send64(
+      session->inner, remote_path, permissions, (libssh2_int64_t)local.size, 0,
+      0);
   if (channel == NULL) {
-    libssh2_channel_free(inner);
-    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    status = lv_libssh2_status_from_result(
+        libssh2_session_last_errno(session->inner));
+  } else {
+    status =
+        lv_libssh2_scp_write_mapping(channel, &local, progress, byte_count);
+    /* The server only acknowledges the file once the channel is closed. */
+    if (lv_libssh2_status_is_ok(status)) {
+      int result = libssh2_channel_send_eof(channel);
+      if (result == 0) {
+        result = libssh2_channel_wait_eof(channel);
+      }
+      if (result == 0) {
+        result = libssh2_channel_wait_closed(channel);
+      }
+      if (result != 0) {
+        status = lv_libssh2_status_from_result(result);
+      }
+    }
+    libssh2_channel_free(channel);
+  }
+  libssh2_session_set_blocking(session->inner, blocking);
+  lv_libssh2_mapping_close(&local);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_scp_download_file(
+    lv_libssh2_session_t *session, const char *remote_path,
+    const char *local_path, lv_libssh2_progress_t *progress,
+    uint64_t *byte_count) {
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *byte_count = 0;
+  int blocking = libssh2_session_get_blocking(session->inner);
+  libssh2_session_set_blocking(session->inner, 1);
+  libssh2_struct_stat info;
+  LIBSSH2_CHANNEL *channel =
+      libssh2_scp_recv2(session->inner, remote_path, &info);
+  if (channel == NULL) {
+    int error = libssh2_session_last_errno(session->inner);
+    libssh2_session_set_blocking(session->inner, blocking);
+    return lv_libssh2_status_from_result(error);
+  }
+  const uint64_t size = (uint64_t)info.st_size;
+  lv_libssh2_progress_start(progress, size);
+  /* Growing the receive window past the libssh2 default keeps more of the
+   * file in flight on links with a high bandwidth-delay product. */
+  libssh2_channel_receive_window_adjust2(channel, DOWNLOAD_WINDOW_ADJUSTMENT,
+                                         0, NULL);
+  lv_libssh2_mapping_t local;
+  lv_libssh2_status_t status =
+      lv_libssh2_mapping_open_write(&local, local_path, size);
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_scp_read_mapping(channel, NULL, &local, size,
+                                         progress, byte_count);
+    status = lv_libssh2_scp_close_mapping(&local, *byte_count, status);
   }
-  channel->inner = inner;
-  *handle = channel;
-  return LV_LIBSSH2_STATUS_OK;
+  libssh2_channel_free(channel);
+  libssh2_session_set_blocking(session->inner, blocking);
+  return status;
 }
@@ -34,10 +34,27 @@
 #ifndef LV_LIBSSH2_SESSION_PRIVATE_H
 #define LV_LIBSSH2_SESSION_PRIVATE_H
 
+#include <stdbool.h>
+
+#include "lv-libssh2-socket-private.h"
 #include "lv-libssh2.h"
 
 struct _lv_libssh2_session {
   LIBSSH2_SESSION *inner;
+  lv_libssh2_socket_t socket;
+  bool owns_socket;
+  int32_t send_buffer_size;
+  int32_t receive_buffer_size;
+  struct _lv_libssh2_pump *pump;
 };
 
+/**
+ * Waits at most the number of milliseconds for the session socket to be
+ * ready in the directions the session last blocked on.
+ *
+ * Used to drive non-blocking calls that returned `LIBSSH2_ERROR_EAGAIN`.
+ */
+void lv_libssh2_session_wait(lv_libssh2_session_t *session,
+                             const uint32_t milliseconds);
+
 #endif
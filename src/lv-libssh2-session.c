@@ -37,7 +37,9 @@
 #include "libssh2.h"
 
 #include "lv-libssh2-session-private.h"
+#include "lv-libssh2-socket-private.h"
 #include "lv-libssh2-status-private.h"
+#include "lv-libssh2-time-private.h"
 #include "lv-libssh2.h"
 
 #define BLOCK_DIRECTIONS_BOTH 3
@@ -54,6 +56,11 @@ lv_libssh2_status_t lv_libssh2_session_create(lv_libssh2_session_t **handle) {
     return LV_LIBSSH2_STATUS_ERROR_MALLOC;
   }
   session->inner = inner;
+  session->socket = LV_LIBSSH2_SOCKET_INVALID;
+  session->owns_socket = false;
+  session->send_buffer_size = 0;
+  session->receive_buffer_size = 0;
+  session->pump = NULL;
   *handle = session;
   return LV_LIBSSH2_STATUS_OK;
 }
@@ -62,8 +69,15 @@ lv_libssh2_status_t lv_libssh2_session_destroy(lv_libssh2_session_t *handle) {
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_session_pump_stop(handle);
   libssh2_session_set_blocking(handle->inner, LV_LIBSSH2_SESSION_MODE_BLOCKING);
   int result = libssh2_session_free(handle->inner);
+  /* The socket is closed even if the session could not be freed, so that it
+   * is not leaked, and only once if the destroy is tried again. */
+  if (handle->owns_socket) {
+    lv_libssh2_socket_close(handle->socket);
+    handle->owns_socket = false;
+  }
   if (result != 0) {
     return LV_LIBSSH2_STATUS_ERROR_FREE;
   }
@@ -78,9 +92,83 @@ lv_libssh2_status_t lv_libssh2_session_connect(lv_libssh2_session_t *handle,
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
   int result = libssh2_session_handshake(handle->inner, socket);
+  if (result == 0) {
+    handle->socket = (lv_libssh2_socket_t)socket;
+    handle->owns_socket = false;
+  }
   return lv_libssh2_status_from_result(result);
 }
 
+lv_libssh2_status_t
+lv_libssh2_session_connect_host(lv_libssh2_session_t *handle, const char *host,
+                                const int32_t port, const int32_t timeout,
+                                const uint32_t options) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (host == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->socket != LV_LIBSSH2_SOCKET_INVALID) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  const uint64_t start = lv_libssh2_time_now();
+  lv_libssh2_socket_t socket = LV_LIBSSH2_SOCKET_INVALID;
+  lv_libssh2_status_t status = lv_libssh2_socket_connect(
+      host, port, timeout, options, handle->send_buffer_size,
+      handle->receive_buffer_size, &socket);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  const long previous_timeout = libssh2_session_get_timeout(handle->inner);
+  if (timeout >= 0) {
+    uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+    long remaining =
+        elapsed >= (uint64_t)timeout ? 1 : (long)((uint64_t)timeout - elapsed);
+    if (previous_timeout == 0 || remaining < previous_timeout) {
+      libssh2_session_set_timeout(handle->inner, remaining);
+    }
+  }
+  /* The handshake runs to completion, bounded by the timeout, so that a
+   * non-blocking session does not give up the socket it just connected. */
+  int blocking = libssh2_session_get_blocking(handle->inner);
+  libssh2_session_set_blocking(handle->inner, 1);
+  int result = libssh2_session_handshake(handle->inner, socket);
+  libssh2_session_set_blocking(handle->inner, blocking);
+  libssh2_session_set_timeout(handle->inner, previous_timeout);
+  if (result != 0) {
+    lv_libssh2_socket_close(socket);
+    return lv_libssh2_status_from_result(result);
+  }
+  handle->socket = socket;
+  handle->owns_socket = true;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+void lv_libssh2_session_wait(lv_libssh2_session_t *session,
+                             const uint32_t milliseconds) {
+  int directions = libssh2_session_block_directions(session->inner);
+  if (session->socket == LV_LIBSSH2_SOCKET_INVALID || directions == 0) {
+    return;
+  }
+  lv_libssh2_socket_wait(session->socket,
+                         (directions & LIBSSH2_SESSION_BLOCK_INBOUND) != 0,
+                         (directions & LIBSSH2_SESSION_BLOCK_OUTBOUND) != 0,
+                         milliseconds);
+}
+
+lv_libssh2_status_t
+lv_libssh2_session_set_socket_buffers(lv_libssh2_session_t *handle,
+                                      const int32_t send_buffer_size,
+                                      const int32_t receive_buffer_size) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  handle->send_buffer_size = send_buffer_size;
+  handle->receive_buffer_size = receive_buffer_size;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
 lv_libssh2_status_t lv_libssh2_session_disconnect(lv_libssh2_session_t *handle,
                                                   const char *description) {
   if (handle == NULL) {
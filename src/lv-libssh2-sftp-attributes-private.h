@@ -40,4 +40,7 @@ struct _lv_libssh2_sftp_attributes {
   LIBSSH2_SFTP_ATTRIBUTES *inner;
 };
 
+lv_libssh2_file_types_t
+lv_libssh2_sftp_attributes_type_from_permissions(unsigned long permissions);
+
 #endif
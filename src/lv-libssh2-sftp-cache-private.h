@@ -0,0 +1,107 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_SFTP_CACHE_PRIVATE_H
+#define LV_LIBSSH2_SFTP_CACHE_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2.h"
+
+typedef enum _lv_libssh2_sftp_cache_kinds {
+  LV_LIBSSH2_SFTP_CACHE_KIND_LINK_STATUS = 0,
+  LV_LIBSSH2_SFTP_CACHE_KIND_LISTING = 1,
+  LV_LIBSSH2_SFTP_CACHE_KIND_STATUS = 2,
+} lv_libssh2_sftp_cache_kinds_t;
+
+typedef struct _lv_libssh2_sftp_cache_entry {
+  struct _lv_libssh2_sftp_cache_entry *next;
+  uint32_t hash;
+  lv_libssh2_sftp_cache_kinds_t kind;
+  char *path;
+  uint64_t expires;
+  lv_libssh2_status_t status;
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  lv_libssh2_sftp_listing_t *listing;
+} lv_libssh2_sftp_cache_entry_t;
+
+typedef struct _lv_libssh2_sftp_cache {
+  lv_libssh2_sftp_cache_entry_t **buckets;
+  size_t count;
+  uint64_t ttl;
+  uint64_t hits;
+  uint64_t misses;
+} lv_libssh2_sftp_cache_t;
+
+lv_libssh2_status_t lv_libssh2_sftp_cache_create(const uint32_t ttl,
+                                                 lv_libssh2_sftp_cache_t **cache);
+
+void lv_libssh2_sftp_cache_destroy(lv_libssh2_sftp_cache_t *cache);
+
+void lv_libssh2_sftp_cache_clear(lv_libssh2_sftp_cache_t *cache);
+
+/* The lookups count a hit or a miss and copy out the cached result. A NULL
+ * cache always misses without counting. */
+bool lv_libssh2_sftp_cache_find_attributes(
+    lv_libssh2_sftp_cache_t *cache, const lv_libssh2_sftp_cache_kinds_t kind,
+    const char *path, LIBSSH2_SFTP_ATTRIBUTES *attributes,
+    lv_libssh2_status_t *status);
+
+bool lv_libssh2_sftp_cache_find_listing(lv_libssh2_sftp_cache_t *cache,
+                                        const char *path,
+                                        lv_libssh2_sftp_listing_t **listing);
+
+/* Only results that describe the remote file system, a success or a missing
+ * file, are stored. Storing into a NULL cache does nothing. */
+void lv_libssh2_sftp_cache_store_attributes(
+    lv_libssh2_sftp_cache_t *cache, const lv_libssh2_sftp_cache_kinds_t kind,
+    const char *path, const LIBSSH2_SFTP_ATTRIBUTES *attributes,
+    const lv_libssh2_status_t status);
+
+void lv_libssh2_sftp_cache_store_listing(lv_libssh2_sftp_cache_t *cache,
+                                         const char *path,
+                                         lv_libssh2_sftp_listing_t *listing);
+
+/* Drops the entries for the path and the listing of its parent directory. */
+void lv_libssh2_sftp_cache_invalidate(lv_libssh2_sftp_cache_t *cache,
+                                      const char *path);
+
+/* Also drops the entries for everything below the path. */
+void lv_libssh2_sftp_cache_invalidate_tree(lv_libssh2_sftp_cache_t *cache,
+                                           const char *path);
+
+#endif
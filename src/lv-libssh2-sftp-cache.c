@@ -0,0 +1,339 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-sftp-cache-private.h"
+#include "lv-libssh2-sftp-listing-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define BUCKET_COUNT 1024
+#define MAX_ENTRIES 8192
+
+/* Trailing separators are ignored, so `dir` and `dir/` share entries. */
+static size_t lv_libssh2_sftp_cache_key_len(const char *path,
+                                            const size_t len) {
+  size_t key_len = len;
+  while (key_len > 1 && path[key_len - 1] == '/') {
+    key_len -= 1;
+  }
+  return key_len;
+}
+
+static uint32_t
+lv_libssh2_sftp_cache_hash(const lv_libssh2_sftp_cache_kinds_t kind,
+                           const char *path, const size_t len) {
+  uint32_t hash = 2166136261u ^ (uint32_t)kind;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (uint8_t)path[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/* Returns the link that points at the matching entry, or at the end of the
+ * bucket when there is none. */
+static lv_libssh2_sftp_cache_entry_t **
+lv_libssh2_sftp_cache_lookup(lv_libssh2_sftp_cache_t *cache,
+                             const lv_libssh2_sftp_cache_kinds_t kind,
+                             const char *path, const size_t len) {
+  uint32_t hash = lv_libssh2_sftp_cache_hash(kind, path, len);
+  lv_libssh2_sftp_cache_entry_t **link =
+      &cache->buckets[hash % BUCKET_COUNT];
+  while (*link != NULL) {
+    lv_libssh2_sftp_cache_entry_t *entry = *link;
+    if (entry->hash == hash && entry->kind == kind &&
+        strlen(entry->path) == len && memcmp(entry->path, path, len) == 0) {
+      break;
+    }
+    link = &entry->next;
+  }
+  return link;
+}
+
+static void lv_libssh2_sftp_cache_remove(lv_libssh2_sftp_cache_t *cache,
+                                         lv_libssh2_sftp_cache_entry_t **link) {
+  lv_libssh2_sftp_cache_entry_t *entry = *link;
+  *link = entry->next;
+  if (entry->listing != NULL) {
+    lv_libssh2_sftp_listing_destroy(entry->listing);
+  }
+  free(entry->path);
+  free(entry);
+  cache->count -= 1;
+}
+
+static void lv_libssh2_sftp_cache_drop(lv_libssh2_sftp_cache_t *cache,
+                                       const lv_libssh2_sftp_cache_kinds_t kind,
+                                       const char *path, const size_t len) {
+  lv_libssh2_sftp_cache_entry_t **link =
+      lv_libssh2_sftp_cache_lookup(cache, kind, path, len);
+  if (*link != NULL) {
+    lv_libssh2_sftp_cache_remove(cache, link);
+  }
+}
+
+/* Finds an entry that has not expired, removing it if it has. */
+static lv_libssh2_sftp_cache_entry_t *
+lv_libssh2_sftp_cache_find(lv_libssh2_sftp_cache_t *cache,
+                           const lv_libssh2_sftp_cache_kinds_t kind,
+                           const char *path) {
+  size_t len = lv_libssh2_sftp_cache_key_len(path, strlen(path));
+  lv_libssh2_sftp_cache_entry_t **link =
+      lv_libssh2_sftp_cache_lookup(cache, kind, path, len);
+  if (*link != NULL && (*link)->expires <= lv_libssh2_time_now()) {
+    /* The link now points at the next entry in the bucket, which is for
+     * another path. */
+    lv_libssh2_sftp_cache_remove(cache, link);
+    cache->misses += 1;
+    return NULL;
+  }
+  if (*link == NULL) {
+    cache->misses += 1;
+    return NULL;
+  }
+  cache->hits += 1;
+  return *link;
+}
+
+/* Replaces any entry for the path with a new, empty one. */
+static lv_libssh2_sftp_cache_entry_t *
+lv_libssh2_sftp_cache_insert(lv_libssh2_sftp_cache_t *cache,
+                             const lv_libssh2_sftp_cache_kinds_t kind,
+                             const char *path) {
+  const uint64_t now = lv_libssh2_time_now();
+  if (cache->count >= MAX_ENTRIES) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+      lv_libssh2_sftp_cache_entry_t **link = &cache->buckets[i];
+      while (*link != NULL) {
+        if ((*link)->expires <= now) {
+          lv_libssh2_sftp_cache_remove(cache, link);
+        } else {
+          link = &(*link)->next;
+        }
+      }
+    }
+    /* Still full of live entries, so start over rather than track which
+     * were used least. */
+    if (cache->count >= MAX_ENTRIES) {
+      lv_libssh2_sftp_cache_clear(cache);
+    }
+  }
+  size_t len = lv_libssh2_sftp_cache_key_len(path, strlen(path));
+  lv_libssh2_sftp_cache_drop(cache, kind, path, len);
+  lv_libssh2_sftp_cache_entry_t *entry =
+      calloc(1, sizeof(lv_libssh2_sftp_cache_entry_t));
+  if (entry == NULL) {
+    return NULL;
+  }
+  entry->path = malloc(len + 1);
+  if (entry->path == NULL) {
+    free(entry);
+    return NULL;
+  }
+  memcpy(entry->path, path, len);
+  entry->path[len] = '\0';
+  entry->hash = lv_libssh2_sftp_cache_hash(kind, path, len);
+  entry->kind = kind;
+  entry->expires = now + cache->ttl;
+  entry->next = cache->buckets[entry->hash % BUCKET_COUNT];
+  cache->buckets[entry->hash % BUCKET_COUNT] = entry;
+  cache->count += 1;
+  return entry;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_cache_create(const uint32_t ttl,
+                             lv_libssh2_sftp_cache_t **cache) {
+  *cache = NULL;
+  lv_libssh2_sftp_cache_t *created = calloc(1, sizeof(lv_libssh2_sftp_cache_t));
+  if (created == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  created->buckets =
+      calloc(BUCKET_COUNT, sizeof(lv_libssh2_sftp_cache_entry_t *));
+  if (created->buckets == NULL) {
+    free(created);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  created->ttl = (uint64_t)ttl * 1000;
+  *cache = created;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+void lv_libssh2_sftp_cache_destroy(lv_libssh2_sftp_cache_t *cache) {
+  if (cache == NULL) {
+    return;
+  }
+  lv_libssh2_sftp_cache_clear(cache);
+  free(cache->buckets);
+  free(cache);
+}
+
+void lv_libssh2_sftp_cache_clear(lv_libssh2_sftp_cache_t *cache) {
+  if (cache == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    while (cache->buckets[i] != NULL) {
+      lv_libssh2_sftp_cache_remove(cache, &cache->buckets[i]);
+    }
+  }
+}
+
+bool lv_libssh2_sftp_cache_find_attributes(
+    lv_libssh2_sftp_cache_t *cache, const lv_libssh2_sftp_cache_kinds_t kind,
+    const char *path, LIBSSH2_SFTP_ATTRIBUTES *attributes,
+    lv_libssh2_status_t *status) {
+  if (cache == NULL) {
+    return false;
+  }
+  lv_libssh2_sftp_cache_entry_t *entry =
+      lv_libssh2_sftp_cache_find(cache, kind, path);
+  if (entry == NULL) {
+    return false;
+  }
+  *attributes = entry->attributes;
+  *status = entry->status;
+  return true;
+}
+
+bool lv_libssh2_sftp_cache_find_listing(lv_libssh2_sftp_cache_t *cache,
+                                        const char *path,
+                                        lv_libssh2_sftp_listing_t **listing) {
+  if (cache == NULL) {
+    return false;
+  }
+  lv_libssh2_sftp_cache_entry_t *entry = lv_libssh2_sftp_cache_find(
+      cache, LV_LIBSSH2_SFTP_CACHE_KIND_LISTING, path);
+  if (entry == NULL) {
+    return false;
+  }
+  /* A listing that cannot be copied is read again instead. */
+  return lv_libssh2_status_is_ok(
+      lv_libssh2_sftp_listing_clone(entry->listing, listing));
+}
+
+void lv_libssh2_sftp_cache_store_attributes(
+    lv_libssh2_sftp_cache_t *cache, const lv_libssh2_sftp_cache_kinds_t kind,
+    const char *path, const LIBSSH2_SFTP_ATTRIBUTES *attributes,
+    const lv_libssh2_status_t status) {
+  if (cache == NULL || (lv_libssh2_status_is_err(status) &&
+                        status != LV_LIBSSH2_STATUS_ERROR_SFTP_NO_SUCH_FILE)) {
+    return;
+  }
+  lv_libssh2_sftp_cache_entry_t *entry =
+      lv_libssh2_sftp_cache_insert(cache, kind, path);
+  if (entry != NULL) {
+    entry->attributes = *attributes;
+    entry->status = status;
+  }
+}
+
+void lv_libssh2_sftp_cache_store_listing(lv_libssh2_sftp_cache_t *cache,
+                                         const char *path,
+                                         lv_libssh2_sftp_listing_t *listing) {
+  if (cache == NULL) {
+    return;
+  }
+  lv_libssh2_sftp_listing_t *copy = NULL;
+  if (lv_libssh2_status_is_err(lv_libssh2_sftp_listing_clone(listing, &copy))) {
+    return;
+  }
+  lv_libssh2_sftp_cache_entry_t *entry = lv_libssh2_sftp_cache_insert(
+      cache, LV_LIBSSH2_SFTP_CACHE_KIND_LISTING, path);
+  if (entry == NULL) {
+    lv_libssh2_sftp_listing_destroy(copy);
+    return;
+  }
+  entry->listing = copy;
+  entry->status = LV_LIBSSH2_STATUS_OK;
+}
+
+void lv_libssh2_sftp_cache_invalidate(lv_libssh2_sftp_cache_t *cache,
+                                      const char *path) {
+  if (cache == NULL) {
+    return;
+  }
+  size_t len = lv_libssh2_sftp_cache_key_len(path, strlen(path));
+  lv_libssh2_sftp_cache_drop(cache, LV_LIBSSH2_SFTP_CACHE_KIND_LINK_STATUS,
+                             path, len);
+  lv_libssh2_sftp_cache_drop(cache, LV_LIBSSH2_SFTP_CACHE_KIND_STATUS, path,
+                             len);
+  lv_libssh2_sftp_cache_drop(cache, LV_LIBSSH2_SFTP_CACHE_KIND_LISTING, path,
+                             len);
+  size_t parent_len = len;
+  while (parent_len > 0 && path[parent_len - 1] != '/') {
+    parent_len -= 1;
+  }
+  if (parent_len == 0) {
+    /* A relative name lives in the starting directory of the server. */
+    lv_libssh2_sftp_cache_drop(cache, LV_LIBSSH2_SFTP_CACHE_KIND_LISTING, ".",
+                               1);
+    lv_libssh2_sftp_cache_drop(cache, LV_LIBSSH2_SFTP_CACHE_KIND_LISTING, "",
+                               0);
+    return;
+  }
+  lv_libssh2_sftp_cache_drop(
+      cache, LV_LIBSSH2_SFTP_CACHE_KIND_LISTING, path,
+      lv_libssh2_sftp_cache_key_len(path, parent_len));
+}
+
+void lv_libssh2_sftp_cache_invalidate_tree(lv_libssh2_sftp_cache_t *cache,
+                                           const char *path) {
+  if (cache == NULL) {
+    return;
+  }
+  lv_libssh2_sftp_cache_invalidate(cache, path);
+  size_t len = lv_libssh2_sftp_cache_key_len(path, strlen(path));
+  /* The root already ends with the separator. */
+  bool root = len == 1 && path[0] == '/';
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    lv_libssh2_sftp_cache_entry_t **link = &cache->buckets[i];
+    while (*link != NULL) {
+      const char *entry_path = (*link)->path;
+      if (strncmp(entry_path, path, len) == 0 &&
+          (root || entry_path[len] == '/')) {
+        lv_libssh2_sftp_cache_remove(cache, link);
+      } else {
+        link = &(*link)->next;
+      }
+    }
+  }
+}
@@ -0,0 +1,73 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_SFTP_LISTING_PRIVATE_H
+#define LV_LIBSSH2_SFTP_LISTING_PRIVATE_H
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2.h"
+
+/* Large enough for any name a server returns from a directory read. */
+#define LV_LIBSSH2_SFTP_NAME_BUFFER_SIZE 4096
+
+struct _lv_libssh2_sftp_listing {
+  lv_libssh2_sftp_listing_record_t *records;
+  size_t count;
+  size_t capacity;
+  char *names;
+  size_t names_len;
+  size_t names_capacity;
+};
+
+/**
+ * Fills every field of the record from the attributes except the name.
+ */
+void lv_libssh2_sftp_listing_fill_record(
+    lv_libssh2_sftp_listing_record_t *record,
+    const LIBSSH2_SFTP_ATTRIBUTES *attributes);
+
+/**
+ * Adds a record and its name, which is kept with a terminator in the names.
+ */
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_append(lv_libssh2_sftp_listing_t *listing,
+                               const char *name, const size_t name_len,
+                               const LIBSSH2_SFTP_ATTRIBUTES *attributes);
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_clone(const lv_libssh2_sftp_listing_t *listing,
+                              lv_libssh2_sftp_listing_t **copy);
+
+#endif
@@ -0,0 +1,285 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-sftp-attributes-private.h"
+#include "lv-libssh2-sftp-cache-private.h"
+#include "lv-libssh2-sftp-listing-private.h"
+#include "lv-libssh2-sftp-private.h"
+#include "lv-libssh2.h"
+
+#define INITIAL_RECORD_CAPACITY 64
+#define INITIAL_NAMES_CAPACITY 4096
+
+/* LabVIEW unflattens the records with a fixed cluster of 40 bytes, so the
+ * layout must not change without it. */
+typedef char lv_libssh2_sftp_listing_record_size_check
+    [sizeof(lv_libssh2_sftp_listing_record_t) == 40 ? 1 : -1];
+
+void lv_libssh2_sftp_listing_fill_record(
+    lv_libssh2_sftp_listing_record_t *record,
+    const LIBSSH2_SFTP_ATTRIBUTES *attributes) {
+  record->size = attributes->filesize;
+  record->flags = (uint32_t)attributes->flags;
+  record->permissions = (uint32_t)attributes->permissions;
+  record->uid = (uint32_t)attributes->uid;
+  record->gid = (uint32_t)attributes->gid;
+  record->mtime = (uint32_t)attributes->mtime;
+  record->type =
+      (attributes->flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) != 0
+          ? (uint32_t)lv_libssh2_sftp_attributes_type_from_permissions(
+                attributes->permissions)
+          : (uint32_t)LV_LIBSSH2_FILE_TYPE_UNKNOWN;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_append(lv_libssh2_sftp_listing_t *listing,
+                               const char *name, const size_t name_len,
+                               const LIBSSH2_SFTP_ATTRIBUTES *attributes) {
+  if (listing->count == listing->capacity) {
+    size_t capacity = listing->capacity == 0 ? INITIAL_RECORD_CAPACITY
+                                             : listing->capacity * 2;
+    lv_libssh2_sftp_listing_record_t *records = realloc(
+        listing->records, capacity * sizeof(lv_libssh2_sftp_listing_record_t));
+    if (records == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    listing->records = records;
+    listing->capacity = capacity;
+  }
+  /* Each name keeps its terminator, so it can also be used as a C string. */
+  if (listing->names_capacity - listing->names_len < name_len + 1) {
+    size_t capacity = listing->names_capacity == 0 ? INITIAL_NAMES_CAPACITY
+                                                   : listing->names_capacity;
+    while (capacity - listing->names_len < name_len + 1) {
+      capacity *= 2;
+    }
+    char *names = realloc(listing->names, capacity);
+    if (names == NULL) {
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    listing->names = names;
+    listing->names_capacity = capacity;
+  }
+  lv_libssh2_sftp_listing_record_t *record = &listing->records[listing->count];
+  lv_libssh2_sftp_listing_fill_record(record, attributes);
+  record->name_offset = (uint32_t)listing->names_len;
+  record->name_len = (uint32_t)name_len;
+  memcpy(listing->names + listing->names_len, name, name_len);
+  listing->names[listing->names_len + name_len] = '\0';
+  listing->names_len += name_len + 1;
+  listing->count += 1;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_clone(const lv_libssh2_sftp_listing_t *listing,
+                              lv_libssh2_sftp_listing_t **copy) {
+  *copy = NULL;
+  lv_libssh2_sftp_listing_t *clone =
+      calloc(1, sizeof(lv_libssh2_sftp_listing_t));
+  if (clone == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  if (listing->count > 0) {
+    size_t records_len =
+        listing->count * sizeof(lv_libssh2_sftp_listing_record_t);
+    clone->records = malloc(records_len);
+    clone->names = malloc(listing->names_len);
+    if (clone->records == NULL || clone->names == NULL) {
+      lv_libssh2_sftp_listing_destroy(clone);
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    memcpy(clone->records, listing->records, records_len);
+    memcpy(clone->names, listing->names, listing->names_len);
+    clone->count = listing->count;
+    clone->capacity = listing->count;
+    clone->names_len = listing->names_len;
+    clone->names_capacity = listing->names_len;
+  }
+  *copy = clone;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_list_directory(lv_libssh2_sftp_t *sftp, const char *path,
+                               lv_libssh2_sftp_listing_t **handle) {
+  *handle = NULL;
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (lv_libssh2_sftp_cache_find_listing(sftp->cache, path, handle)) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  lv_libssh2_sftp_listing_t *listing =
+      calloc(1, sizeof(lv_libssh2_sftp_listing_t));
+  if (listing == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  char *name = malloc(LV_LIBSSH2_SFTP_NAME_BUFFER_SIZE);
+  if (name == NULL) {
+    free(listing);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  /* The listing is read natively, so the session blocks until it
+   * completes. */
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  LIBSSH2_SFTP_HANDLE *directory =
+      libssh2_sftp_open_ex(sftp->inner, path, (unsigned int)strlen(path), 0, 0,
+                           LIBSSH2_SFTP_OPENDIR);
+  if (directory == NULL) {
+    status = lv_libssh2_sftp_status_from_result(
+        sftp->inner, libssh2_session_last_errno(sftp->session));
+  }
+  while (lv_libssh2_status_is_ok(status)) {
+    LIBSSH2_SFTP_ATTRIBUTES attributes;
+    int result = libssh2_sftp_readdir_ex(directory, name,
+                                         LV_LIBSSH2_SFTP_NAME_BUFFER_SIZE, NULL,
+                                         0, &attributes);
+    if (result < 0) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, result);
+      break;
+    }
+    if (result == 0) {
+      break;
+    }
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+      continue;
+    }
+    status = lv_libssh2_sftp_listing_append(listing, name, (size_t)result,
+                                            &attributes);
+  }
+  if (directory != NULL) {
+    libssh2_sftp_close_handle(directory);
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  free(name);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_sftp_listing_destroy(listing);
+    return status;
+  }
+  lv_libssh2_sftp_cache_store_listing(sftp->cache, path, listing);
+  *handle = listing;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_destroy(lv_libssh2_sftp_listing_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  free(handle->records);
+  free(handle->names);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_count(lv_libssh2_sftp_listing_t *handle,
+                              size_t *count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *count = handle->count;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_records_len(lv_libssh2_sftp_listing_t *handle,
+                                    size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *len = handle->count * sizeof(lv_libssh2_sftp_listing_record_t);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_records(lv_libssh2_sftp_listing_t *handle,
+                                uint8_t *buffer) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->count > 0) {
+    memcpy(buffer, handle->records,
+           handle->count * sizeof(lv_libssh2_sftp_listing_record_t));
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_names_len(lv_libssh2_sftp_listing_t *handle,
+                                  size_t *len) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (len == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *len = handle->names_len;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_listing_names(lv_libssh2_sftp_listing_t *handle,
+                              uint8_t *buffer) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->names_len > 0) {
+    memcpy(buffer, handle->names, handle->names_len);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
@@ -0,0 +1,611 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-sftp-listing-private.h"
+#include "lv-libssh2-sftp-mirror-private.h"
+#include "lv-libssh2-sftp-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2-transfer-queue-private.h"
+#include "lv-libssh2.h"
+
+#define DIRECTORY_PERMISSIONS 0755
+#define INITIAL_JOB_CAPACITY 64
+#define INITIAL_STACK_CAPACITY 16
+
+/* Directories still to be walked, relative to the roots. */
+typedef struct _lv_libssh2_sftp_mirror_stack {
+  char **paths;
+  size_t count;
+  size_t capacity;
+} lv_libssh2_sftp_mirror_stack_t;
+
+static char *lv_libssh2_sftp_mirror_join(const char *base, const char *name) {
+  size_t base_len = strlen(base);
+  size_t name_len = strlen(name);
+  size_t separator_len =
+      base_len > 0 && name_len > 0 && base[base_len - 1] != '/' ? 1 : 0;
+  char *path = malloc(base_len + separator_len + name_len + 1);
+  if (path == NULL) {
+    return NULL;
+  }
+  memcpy(path, base, base_len);
+  if (separator_len > 0) {
+    path[base_len] = '/';
+  }
+  memcpy(path + base_len + separator_len, name, name_len + 1);
+  return path;
+}
+
+static bool lv_libssh2_sftp_mirror_is_dot(const char *name) {
+  return strcmp(name, ".") == 0 || strcmp(name, "..") == 0;
+}
+
+/* Takes ownership of the path, freeing it if it cannot be pushed. */
+static bool lv_libssh2_sftp_mirror_push(lv_libssh2_sftp_mirror_stack_t *stack,
+                                        char *path) {
+  if (stack->count == stack->capacity) {
+    size_t capacity = stack->capacity == 0 ? INITIAL_STACK_CAPACITY
+                                           : stack->capacity * 2;
+    char **paths = realloc(stack->paths, capacity * sizeof(char *));
+    if (paths == NULL) {
+      free(path);
+      return false;
+    }
+    stack->paths = paths;
+    stack->capacity = capacity;
+  }
+  stack->paths[stack->count] = path;
+  stack->count += 1;
+  return true;
+}
+
+static bool lv_libssh2_sftp_mirror_cancelled(lv_libssh2_sftp_mirror_t *mirror) {
+  lv_libssh2_mutex_lock(&mirror->queue->mutex);
+  bool cancel = mirror->cancel;
+  lv_libssh2_mutex_unlock(&mirror->queue->mutex);
+  return cancel;
+}
+
+/* Keeps the first error of the walk. */
+static void lv_libssh2_sftp_mirror_fail(lv_libssh2_sftp_mirror_t *mirror,
+                                        const lv_libssh2_status_t status) {
+  lv_libssh2_mutex_lock(&mirror->queue->mutex);
+  if (lv_libssh2_status_is_ok(mirror->walk_status)) {
+    mirror->walk_status = status;
+  }
+  lv_libssh2_mutex_unlock(&mirror->queue->mutex);
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_mirror_record(lv_libssh2_sftp_mirror_t *mirror,
+                              const size_t job) {
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  lv_libssh2_mutex_lock(&mirror->queue->mutex);
+  if (mirror->job_count == mirror->job_capacity) {
+    size_t capacity = mirror->job_capacity == 0 ? INITIAL_JOB_CAPACITY
+                                                : mirror->job_capacity * 2;
+    size_t *jobs = realloc(mirror->jobs, capacity * sizeof(size_t));
+    if (jobs == NULL) {
+      status = LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    } else {
+      mirror->jobs = jobs;
+      mirror->job_capacity = capacity;
+    }
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    mirror->jobs[mirror->job_count] = job;
+    mirror->job_count += 1;
+  }
+  lv_libssh2_mutex_unlock(&mirror->queue->mutex);
+  return status;
+}
+
+/* Queues a file or pushes a directory found while scanning the `relative`
+ * directory. */
+static lv_libssh2_status_t
+lv_libssh2_sftp_mirror_visit(lv_libssh2_sftp_mirror_t *mirror,
+                             lv_libssh2_sftp_mirror_stack_t *stack,
+                             const char *relative, const char *name,
+                             const bool directory) {
+  char *path = lv_libssh2_sftp_mirror_join(relative, name);
+  if (path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  if (directory) {
+    return lv_libssh2_sftp_mirror_push(stack, path)
+               ? LV_LIBSSH2_STATUS_OK
+               : LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  char *remote = lv_libssh2_sftp_mirror_join(mirror->remote_path, path);
+  char *local = lv_libssh2_sftp_mirror_join(mirror->local_path, path);
+  free(path);
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  if (remote != NULL && local != NULL) {
+    size_t job = 0;
+    status = lv_libssh2_transfer_queue_add_to_group(
+        mirror->queue, remote, local, mirror->direction, &mirror->group, &job);
+    if (lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_mirror_record(mirror, job);
+    }
+  }
+  free(remote);
+  free(local);
+  return status;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_mirror_make_remote(lv_libssh2_sftp_mirror_t *mirror,
+                                   const char *path) {
+  LIBSSH2_SFTP *sftp = mirror->sftp->inner;
+  unsigned int path_len = (unsigned int)strlen(path);
+  int result =
+      libssh2_sftp_mkdir_ex(sftp, path, path_len, DIRECTORY_PERMISSIONS);
+  if (result == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  lv_libssh2_status_t status = lv_libssh2_sftp_status_from_result(sftp, result);
+  /* Servers differ in how they report an existing directory, so look for
+   * one instead. */
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  if (libssh2_sftp_stat_ex(sftp, path, path_len, LIBSSH2_SFTP_STAT,
+                           &attributes) == 0 &&
+      (attributes.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) != 0 &&
+      LIBSSH2_SFTP_S_ISDIR(attributes.permissions)) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  return status;
+}
+
+static lv_libssh2_status_t lv_libssh2_sftp_mirror_make_local(const char *path) {
+#ifdef _WIN32
+  int result = _mkdir(path);
+#else
+  int result = mkdir(path, DIRECTORY_PERMISSIONS);
+#endif
+  if (result == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  if (errno != EEXIST) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  /* Something is already at the path, which is only fine if it is a
+   * directory. */
+#ifdef _WIN32
+  DWORD attributes = GetFileAttributesA(path);
+  bool is_directory = attributes != INVALID_FILE_ATTRIBUTES &&
+                      (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+  struct stat info;
+  bool is_directory = stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+  return is_directory ? LV_LIBSSH2_STATUS_OK : LV_LIBSSH2_STATUS_ERROR_FILE;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_mirror_scan_remote(lv_libssh2_sftp_mirror_t *mirror,
+                                   lv_libssh2_sftp_mirror_stack_t *stack,
+                                   const char *relative, const char *path) {
+  LIBSSH2_SFTP *sftp = mirror->sftp->inner;
+  LIBSSH2_SFTP_HANDLE *directory = libssh2_sftp_open_ex(
+      sftp, path, (unsigned int)strlen(path), 0, 0, LIBSSH2_SFTP_OPENDIR);
+  if (directory == NULL) {
+    return lv_libssh2_sftp_status_from_result(
+        sftp, libssh2_session_last_errno(mirror->sftp->session));
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  char name[LV_LIBSSH2_SFTP_NAME_BUFFER_SIZE];
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  while (!lv_libssh2_sftp_mirror_cancelled(mirror)) {
+    int result = libssh2_sftp_readdir_ex(directory, name, sizeof(name), NULL,
+                                         0, &attributes);
+    if (result < 0) {
+      status = lv_libssh2_sftp_status_from_result(sftp, result);
+      break;
+    }
+    if (result == 0) {
+      break;
+    }
+    if (lv_libssh2_sftp_mirror_is_dot(name)) {
+      continue;
+    }
+    if ((attributes.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) == 0 ||
+        LIBSSH2_SFTP_S_ISLNK(attributes.permissions)) {
+      /* Links to files are copied as files. Links to directories are skipped
+       * so that a loop cannot be walked forever. */
+      char *target = lv_libssh2_sftp_mirror_join(path, name);
+      if (target == NULL) {
+        status = LV_LIBSSH2_STATUS_ERROR_MALLOC;
+        break;
+      }
+      result = libssh2_sftp_stat_ex(sftp, target, (unsigned int)strlen(target),
+                                    LIBSSH2_SFTP_STAT, &attributes);
+      free(target);
+      if (result != 0 ||
+          (attributes.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) == 0 ||
+          !LIBSSH2_SFTP_S_ISREG(attributes.permissions)) {
+        continue;
+      }
+    }
+    bool is_directory = LIBSSH2_SFTP_S_ISDIR(attributes.permissions);
+    if (!is_directory && !LIBSSH2_SFTP_S_ISREG(attributes.permissions)) {
+      continue;
+    }
+    status = lv_libssh2_sftp_mirror_visit(mirror, stack, relative, name,
+                                          is_directory);
+    if (lv_libssh2_status_is_err(status)) {
+      break;
+    }
+  }
+  libssh2_sftp_close_handle(directory);
+  return status;
+}
+
+#ifdef _WIN32
+static lv_libssh2_status_t
+lv_libssh2_sftp_mirror_scan_local(lv_libssh2_sftp_mirror_t *mirror,
+                                  lv_libssh2_sftp_mirror_stack_t *stack,
+                                  const char *relative, const char *path) {
+  char *pattern = lv_libssh2_sftp_mirror_join(path, "*");
+  if (pattern == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  WIN32_FIND_DATAA data;
+  HANDLE find = FindFirstFileA(pattern, &data);
+  free(pattern);
+  if (find == INVALID_HANDLE_VALUE) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  do {
+    if (lv_libssh2_sftp_mirror_is_dot(data.cFileName)) {
+      continue;
+    }
+    bool is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    /* Junctions and directory links are skipped so that a loop cannot be
+     * walked forever. */
+    if (is_directory &&
+        (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) {
+      continue;
+    }
+    status = lv_libssh2_sftp_mirror_visit(mirror, stack, relative,
+                                          data.cFileName, is_directory);
+  } while (lv_libssh2_status_is_ok(status) &&
+           !lv_libssh2_sftp_mirror_cancelled(mirror) &&
+           FindNextFileA(find, &data));
+  FindClose(find);
+  return status;
+}
+#else
+static lv_libssh2_status_t
+lv_libssh2_sftp_mirror_scan_local(lv_libssh2_sftp_mirror_t *mirror,
+                                  lv_libssh2_sftp_mirror_stack_t *stack,
+                                  const char *relative, const char *path) {
+  DIR *directory = opendir(path);
+  if (directory == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  struct dirent *entry = NULL;
+  while (!lv_libssh2_sftp_mirror_cancelled(mirror) &&
+         (entry = readdir(directory)) != NULL) {
+    if (lv_libssh2_sftp_mirror_is_dot(entry->d_name)) {
+      continue;
+    }
+    char *child = lv_libssh2_sftp_mirror_join(path, entry->d_name);
+    if (child == NULL) {
+      status = LV_LIBSSH2_STATUS_ERROR_MALLOC;
+      break;
+    }
+    struct stat info;
+    int result = lstat(child, &info);
+    if (result == 0 && S_ISLNK(info.st_mode)) {
+      /* Links to files are copied as files. Links to directories are skipped
+       * so that a loop cannot be walked forever. */
+      result = stat(child, &info);
+      if (result == 0 && !S_ISREG(info.st_mode)) {
+        result = -1;
+      }
+    }
+    free(child);
+    if (result != 0 || !(S_ISDIR(info.st_mode) || S_ISREG(info.st_mode))) {
+      continue;
+    }
+    status = lv_libssh2_sftp_mirror_visit(mirror, stack, relative,
+                                          entry->d_name, S_ISDIR(info.st_mode));
+    if (lv_libssh2_status_is_err(status)) {
+      break;
+    }
+  }
+  closedir(directory);
+  return status;
+}
+#endif
+
+/* Creates the destination directory and scans the source directory. */
+static lv_libssh2_status_t
+lv_libssh2_sftp_mirror_directory(lv_libssh2_sftp_mirror_t *mirror,
+                                 lv_libssh2_sftp_mirror_stack_t *stack,
+                                 const char *relative) {
+  char *remote = lv_libssh2_sftp_mirror_join(mirror->remote_path, relative);
+  char *local = lv_libssh2_sftp_mirror_join(mirror->local_path, relative);
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  if (remote != NULL && local != NULL) {
+    if (mirror->direction == LV_LIBSSH2_TRANSFER_DIRECTION_UPLOAD) {
+      status = lv_libssh2_sftp_mirror_make_remote(mirror, remote);
+      if (lv_libssh2_status_is_ok(status)) {
+        status =
+            lv_libssh2_sftp_mirror_scan_local(mirror, stack, relative, local);
+      }
+    } else {
+      status = lv_libssh2_sftp_mirror_make_local(local);
+      if (lv_libssh2_status_is_ok(status)) {
+        status =
+            lv_libssh2_sftp_mirror_scan_remote(mirror, stack, relative, remote);
+      }
+    }
+  }
+  free(remote);
+  free(local);
+  if (lv_libssh2_status_is_ok(status)) {
+    lv_libssh2_mutex_lock(&mirror->queue->mutex);
+    mirror->directory_count += 1;
+    lv_libssh2_mutex_unlock(&mirror->queue->mutex);
+  }
+  return status;
+}
+
+static void lv_libssh2_sftp_mirror_walk(void *context) {
+  lv_libssh2_sftp_mirror_t *mirror = context;
+  int blocking = libssh2_session_get_blocking(mirror->sftp->session);
+  libssh2_session_set_blocking(mirror->sftp->session, 1);
+  lv_libssh2_sftp_mirror_stack_t stack = {NULL, 0, 0};
+  char *root = lv_libssh2_sftp_mirror_join("", "");
+  if (root == NULL || !lv_libssh2_sftp_mirror_push(&stack, root)) {
+    lv_libssh2_sftp_mirror_fail(mirror, LV_LIBSSH2_STATUS_ERROR_MALLOC);
+  }
+  while (stack.count > 0 && !lv_libssh2_sftp_mirror_cancelled(mirror)) {
+    stack.count -= 1;
+    char *relative = stack.paths[stack.count];
+    lv_libssh2_status_t status =
+        lv_libssh2_sftp_mirror_directory(mirror, &stack, relative);
+    free(relative);
+    /* A directory that cannot be created or read is skipped along with its
+     * contents, so the rest of the tree is still mirrored. */
+    if (lv_libssh2_status_is_err(status)) {
+      lv_libssh2_sftp_mirror_fail(mirror, status);
+      if (status == LV_LIBSSH2_STATUS_ERROR_MALLOC) {
+        break;
+      }
+    }
+  }
+  for (size_t i = 0; i < stack.count; i++) {
+    free(stack.paths[i]);
+  }
+  free(stack.paths);
+  libssh2_session_set_blocking(mirror->sftp->session, blocking);
+  lv_libssh2_mutex_lock(&mirror->queue->mutex);
+  mirror->scanning = false;
+  lv_libssh2_condition_broadcast(&mirror->queue->changed);
+  lv_libssh2_mutex_unlock(&mirror->queue->mutex);
+}
+
+static void lv_libssh2_sftp_mirror_join_walk(lv_libssh2_sftp_mirror_t *mirror) {
+  lv_libssh2_mutex_lock(&mirror->queue->mutex);
+  mirror->cancel = true;
+  lv_libssh2_mutex_unlock(&mirror->queue->mutex);
+  if (mirror->started) {
+    lv_libssh2_thread_join(mirror->thread);
+    mirror->started = false;
+  }
+}
+
+static void lv_libssh2_sftp_mirror_free(lv_libssh2_sftp_mirror_t *mirror) {
+  free(mirror->remote_path);
+  free(mirror->local_path);
+  free(mirror->jobs);
+  free(mirror);
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_mirror(
+    lv_libssh2_sftp_t *sftp, lv_libssh2_transfer_queue_t *queue,
+    const char *remote_path, const char *local_path,
+    const lv_libssh2_transfer_directions_t direction,
+    lv_libssh2_sftp_mirror_t **handle) {
+  *handle = NULL;
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (queue == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  switch (direction) {
+  case LV_LIBSSH2_TRANSFER_DIRECTION_DOWNLOAD:
+  case LV_LIBSSH2_TRANSFER_DIRECTION_UPLOAD:
+    break;
+  default:
+    return LV_LIBSSH2_STATUS_ERROR_INVALID;
+  }
+  lv_libssh2_sftp_mirror_t *mirror =
+      calloc(1, sizeof(lv_libssh2_sftp_mirror_t));
+  if (mirror == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  mirror->sftp = sftp;
+  mirror->queue = queue;
+  mirror->direction = direction;
+  mirror->remote_path = lv_libssh2_sftp_mirror_join(remote_path, "");
+  mirror->local_path = lv_libssh2_sftp_mirror_join(local_path, "");
+  if (mirror->remote_path == NULL || mirror->local_path == NULL) {
+    lv_libssh2_sftp_mirror_free(mirror);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  mirror->walk_status = LV_LIBSSH2_STATUS_OK;
+  mirror->scanning = true;
+  lv_libssh2_status_t status = lv_libssh2_thread_start(
+      &mirror->thread, lv_libssh2_sftp_mirror_walk, mirror);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_sftp_mirror_free(mirror);
+    return status;
+  }
+  mirror->started = true;
+  *handle = mirror;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_mirror_destroy(lv_libssh2_sftp_mirror_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_sftp_mirror_join_walk(handle);
+  /* The jobs stay in the queue, so they must stop counting toward the
+   * mirror before it is freed. */
+  lv_libssh2_transfer_queue_t *queue = handle->queue;
+  lv_libssh2_mutex_lock(&queue->mutex);
+  for (size_t i = 0; i < handle->job_count; i++) {
+    queue->jobs[handle->jobs[i]].group = NULL;
+  }
+  lv_libssh2_mutex_unlock(&queue->mutex);
+  lv_libssh2_sftp_mirror_free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_mirror_cancel(lv_libssh2_sftp_mirror_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_sftp_mirror_join_walk(handle);
+  for (size_t i = 0; i < handle->job_count; i++) {
+    lv_libssh2_transfer_queue_cancel(handle->queue, handle->jobs[i]);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_mirror_wait(lv_libssh2_sftp_mirror_t *handle,
+                            const int32_t timeout) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_transfer_queue_t *queue = handle->queue;
+  const uint64_t start = lv_libssh2_time_now();
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  lv_libssh2_mutex_lock(&queue->mutex);
+  while (handle->scanning || handle->group.remaining > 0) {
+    if (!handle->scanning && queue->active_workers == 0) {
+      status = LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+      break;
+    }
+    if (timeout < 0) {
+      lv_libssh2_condition_wait(&queue->changed, &queue->mutex);
+      continue;
+    }
+    uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+    if (elapsed >= (uint64_t)timeout) {
+      status = LV_LIBSSH2_STATUS_ERROR_TIMEOUT;
+      break;
+    }
+    lv_libssh2_condition_timed_wait(&queue->changed, &queue->mutex,
+                                    (uint32_t)((uint64_t)timeout - elapsed));
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = handle->walk_status;
+  }
+  lv_libssh2_mutex_unlock(&queue->mutex);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_mirror_status(
+    lv_libssh2_sftp_mirror_t *handle, bool *scanning, size_t *directories,
+    size_t *files, size_t *completed, size_t *failed, uint64_t *byte_count,
+    lv_libssh2_status_t *walk_status) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (scanning == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (directories == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (files == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (completed == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (failed == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (walk_status == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->queue->mutex);
+  *scanning = handle->scanning;
+  *directories = handle->directory_count;
+  *files = handle->job_count;
+  *completed = handle->group.completed;
+  *failed = handle->group.failed;
+  *byte_count = handle->group.byte_count;
+  *walk_status = handle->walk_status;
+  lv_libssh2_mutex_unlock(&handle->queue->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
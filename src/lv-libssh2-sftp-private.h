@@ -34,16 +34,25 @@
 #ifndef LV_LIBSSH2_SFTP_PRIVATE_H
 #define LV_LIBSSH2_SFTP_PRIVATE_H
 
+#include "lv-libssh2-sftp-cache-private.h"
+#include "lv-libssh2-sftp-read-ahead-private.h"
+#include "lv-libssh2-sftp-write-back-private.h"
 #include "lv-libssh2.h"
 
 struct _lv_libssh2_sftp {
   LIBSSH2_SFTP *inner;
   LIBSSH2_SESSION *session;
+  lv_libssh2_session_t *owner;
+  lv_libssh2_sftp_cache_t *cache;
 };
 
 struct _lv_libssh2_sftp_file {
   LIBSSH2_SFTP_HANDLE *inner;
   LIBSSH2_SFTP *sftp;
+  lv_libssh2_sftp_t *owner;
+  char *path;
+  lv_libssh2_sftp_read_ahead_t read_ahead;
+  lv_libssh2_sftp_write_back_t write_back;
 };
 
 struct _lv_libssh2_sftp_directory {
@@ -51,4 +60,7 @@ struct _lv_libssh2_sftp_directory {
   LIBSSH2_SFTP *sftp;
 };
 
+lv_libssh2_status_t lv_libssh2_sftp_status_from_result(LIBSSH2_SFTP *sftp,
+                                                       int result);
+
 #endif
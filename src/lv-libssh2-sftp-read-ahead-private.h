@@ -0,0 +1,101 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_SFTP_READ_AHEAD_PRIVATE_H
+#define LV_LIBSSH2_SFTP_READ_AHEAD_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2.h"
+
+/**
+ * Data read from a remote file ahead of the caller.
+ *
+ * The bytes from `start` to `end` of the buffer are the next bytes of the
+ * file at `offset + start`. While any are buffered, the libssh2 handle is
+ * positioned after them rather than at the position seen by the caller.
+ */
+typedef struct _lv_libssh2_sftp_read_ahead {
+  uint8_t *buffer;
+  size_t capacity;
+  size_t start;
+  size_t end;
+  uint64_t offset;
+  size_t depth;
+  size_t max_depth;
+  bool sequential;
+} lv_libssh2_sftp_read_ahead_t;
+
+void lv_libssh2_sftp_read_ahead_init(lv_libssh2_sftp_read_ahead_t *read_ahead);
+
+void lv_libssh2_sftp_read_ahead_free(lv_libssh2_sftp_read_ahead_t *read_ahead);
+
+/**
+ * Limits how far ahead to read, where zero reads nothing ahead.
+ */
+void lv_libssh2_sftp_read_ahead_set_max_depth(
+    lv_libssh2_sftp_read_ahead_t *read_ahead, const size_t max_depth);
+
+/**
+ * Reads through the buffer, with the same results as `libssh2_sftp_read`.
+ */
+ssize_t lv_libssh2_sftp_read_ahead_read(
+    lv_libssh2_sftp_read_ahead_t *read_ahead, LIBSSH2_SFTP_HANDLE *handle,
+    uint8_t *buffer, const size_t buffer_max_length);
+
+/**
+ * Moves to the offset, keeping the buffered data if the offset is within it.
+ */
+void lv_libssh2_sftp_read_ahead_seek(lv_libssh2_sftp_read_ahead_t *read_ahead,
+                                     LIBSSH2_SFTP_HANDLE *handle,
+                                     const uint64_t offset);
+
+/**
+ * Gets the position seen by the caller.
+ */
+uint64_t
+lv_libssh2_sftp_read_ahead_position(lv_libssh2_sftp_read_ahead_t *read_ahead,
+                                    LIBSSH2_SFTP_HANDLE *handle);
+
+/**
+ * Drops the buffered data and moves the libssh2 handle back to the position
+ * seen by the caller, such as before writing.
+ */
+void lv_libssh2_sftp_read_ahead_discard(
+    lv_libssh2_sftp_read_ahead_t *read_ahead, LIBSSH2_SFTP_HANDLE *handle);
+
+#endif
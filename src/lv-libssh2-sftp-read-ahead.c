@@ -0,0 +1,180 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-sftp-read-ahead-private.h"
+#include "lv-libssh2.h"
+
+#define MIN_DEPTH 32768
+#define DEFAULT_MAX_DEPTH 1048576
+
+static size_t lv_libssh2_sftp_read_ahead_initial_depth(
+    const lv_libssh2_sftp_read_ahead_t *read_ahead) {
+  if (read_ahead->max_depth > 0 && read_ahead->max_depth < MIN_DEPTH) {
+    return read_ahead->max_depth;
+  }
+  return MIN_DEPTH;
+}
+
+void lv_libssh2_sftp_read_ahead_init(lv_libssh2_sftp_read_ahead_t *read_ahead) {
+  read_ahead->buffer = NULL;
+  read_ahead->capacity = 0;
+  read_ahead->start = 0;
+  read_ahead->end = 0;
+  read_ahead->offset = 0;
+  read_ahead->depth = MIN_DEPTH;
+  read_ahead->max_depth = DEFAULT_MAX_DEPTH;
+  read_ahead->sequential = false;
+}
+
+void lv_libssh2_sftp_read_ahead_free(lv_libssh2_sftp_read_ahead_t *read_ahead) {
+  free(read_ahead->buffer);
+  read_ahead->buffer = NULL;
+  read_ahead->capacity = 0;
+  read_ahead->start = 0;
+  read_ahead->end = 0;
+}
+
+static size_t
+lv_libssh2_sftp_read_ahead_copy(lv_libssh2_sftp_read_ahead_t *read_ahead,
+                                uint8_t *buffer,
+                                const size_t buffer_max_length) {
+  size_t count = read_ahead->end - read_ahead->start;
+  if (count > buffer_max_length) {
+    count = buffer_max_length;
+  }
+  memcpy(buffer, read_ahead->buffer + read_ahead->start, count);
+  read_ahead->start += count;
+  return count;
+}
+
+ssize_t lv_libssh2_sftp_read_ahead_read(
+    lv_libssh2_sftp_read_ahead_t *read_ahead, LIBSSH2_SFTP_HANDLE *handle,
+    uint8_t *buffer, const size_t buffer_max_length) {
+  if (read_ahead->start < read_ahead->end) {
+    return (ssize_t)lv_libssh2_sftp_read_ahead_copy(read_ahead, buffer,
+                                                    buffer_max_length);
+  }
+  /* The buffer is used up, and the libssh2 handle is about to move past it,
+   * so it no longer describes the position or a range to seek within. */
+  read_ahead->start = 0;
+  read_ahead->end = 0;
+  /* The first read after opening or seeking goes straight through. Only a
+   * read that follows another one is taken as a sign of a sequential scan
+   * worth fetching ahead for, and reads at least as large as the depth gain
+   * nothing from the buffer. */
+  if (!read_ahead->sequential || read_ahead->max_depth == 0 ||
+      buffer_max_length >= read_ahead->depth) {
+    read_ahead->sequential = true;
+    return libssh2_sftp_read(handle, (char *)buffer, buffer_max_length);
+  }
+  if (read_ahead->capacity < read_ahead->depth) {
+    uint8_t *grown = realloc(read_ahead->buffer, read_ahead->depth);
+    if (grown == NULL) {
+      return libssh2_sftp_read(handle, (char *)buffer, buffer_max_length);
+    }
+    read_ahead->buffer = grown;
+    read_ahead->capacity = read_ahead->depth;
+  }
+  read_ahead->offset = libssh2_sftp_tell64(handle);
+  ssize_t count = libssh2_sftp_read(handle, (char *)read_ahead->buffer,
+                                    read_ahead->depth);
+  if (count <= 0) {
+    return count;
+  }
+  read_ahead->end = (size_t)count;
+  /* Every refill means the previous one was used up without a seek, so the
+   * scan is still sequential and the next refill can go further ahead. */
+  if (read_ahead->depth < read_ahead->max_depth) {
+    read_ahead->depth *= 2;
+    if (read_ahead->depth > read_ahead->max_depth) {
+      read_ahead->depth = read_ahead->max_depth;
+    }
+  }
+  return (ssize_t)lv_libssh2_sftp_read_ahead_copy(read_ahead, buffer,
+                                                  buffer_max_length);
+}
+
+void lv_libssh2_sftp_read_ahead_seek(lv_libssh2_sftp_read_ahead_t *read_ahead,
+                                     LIBSSH2_SFTP_HANDLE *handle,
+                                     const uint64_t offset) {
+  if (read_ahead->end > 0 && offset >= read_ahead->offset &&
+      offset <= read_ahead->offset + read_ahead->end) {
+    read_ahead->start = (size_t)(offset - read_ahead->offset);
+    return;
+  }
+  read_ahead->start = 0;
+  read_ahead->end = 0;
+  read_ahead->depth = lv_libssh2_sftp_read_ahead_initial_depth(read_ahead);
+  read_ahead->sequential = false;
+  libssh2_sftp_seek64(handle, offset);
+}
+
+uint64_t
+lv_libssh2_sftp_read_ahead_position(lv_libssh2_sftp_read_ahead_t *read_ahead,
+                                    LIBSSH2_SFTP_HANDLE *handle) {
+  if (read_ahead->end > 0) {
+    return read_ahead->offset + read_ahead->start;
+  }
+  return libssh2_sftp_tell64(handle);
+}
+
+void lv_libssh2_sftp_read_ahead_discard(
+    lv_libssh2_sftp_read_ahead_t *read_ahead, LIBSSH2_SFTP_HANDLE *handle) {
+  if (read_ahead->end == 0) {
+    return;
+  }
+  uint64_t position = read_ahead->offset + read_ahead->start;
+  read_ahead->start = 0;
+  read_ahead->end = 0;
+  read_ahead->depth = lv_libssh2_sftp_read_ahead_initial_depth(read_ahead);
+  read_ahead->sequential = false;
+  libssh2_sftp_seek64(handle, position);
+}
+
+void lv_libssh2_sftp_read_ahead_set_max_depth(
+    lv_libssh2_sftp_read_ahead_t *read_ahead, const size_t max_depth) {
+  read_ahead->max_depth = max_depth;
+  if (max_depth > 0 && read_ahead->depth > max_depth) {
+    read_ahead->depth = max_depth;
+  }
+  if (read_ahead->depth < MIN_DEPTH) {
+    read_ahead->depth = lv_libssh2_sftp_read_ahead_initial_depth(read_ahead);
+  }
+}
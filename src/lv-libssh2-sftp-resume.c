@@ -0,0 +1,420 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <openssl/evp.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-mapping-private.h"
+#include "lv-libssh2-sftp-private.h"
+#include "lv-libssh2-sftp-transfer-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2.h"
+
+#define JOURNAL_HEADER "lv-libssh2 journal 1"
+#define CHECKPOINT_INTERVAL 8388608
+#define TAIL_SIZE 65536
+#define DIGEST_HEX_LEN 32
+
+/* What a journal records about an interrupted transfer. The source is
+ * identified by its size and modification time, so a changed source is
+ * never resumed into a destination holding parts of the old one. */
+typedef struct _lv_libssh2_sftp_journal {
+  uint64_t source_size;
+  uint64_t source_mtime;
+  uint64_t offset;
+  char digest[DIGEST_HEX_LEN + 1];
+} lv_libssh2_sftp_journal_t;
+
+typedef struct _lv_libssh2_sftp_resume {
+  const char *journal_path;
+  const char *tail_path;
+  bool verify_tail;
+  lv_libssh2_sftp_journal_t journal;
+  uint64_t next_checkpoint;
+} lv_libssh2_sftp_resume_t;
+
+static void lv_libssh2_sftp_resume_init(lv_libssh2_sftp_resume_t *resume,
+                                        const char *journal_path,
+                                        const char *tail_path,
+                                        const bool verify_tail) {
+  memset(resume, 0, sizeof(lv_libssh2_sftp_resume_t));
+  resume->journal_path = journal_path;
+  resume->tail_path = tail_path;
+  resume->verify_tail = verify_tail;
+}
+
+static void lv_libssh2_sftp_resume_digest(const uint8_t *data,
+                                          const size_t len, char *hex) {
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_len = 0;
+  hex[0] = '\0';
+  if (EVP_Digest(data, len, digest, &digest_len, EVP_md5(), NULL) != 1) {
+    return;
+  }
+  static const char digits[] = "0123456789abcdef";
+  for (unsigned int i = 0; i < digest_len; i++) {
+    hex[i * 2] = digits[digest[i] >> 4];
+    hex[i * 2 + 1] = digits[digest[i] & 0x0f];
+  }
+  hex[digest_len * 2] = '\0';
+}
+
+/* Digests the bytes of the local file that end at the offset. */
+static bool lv_libssh2_sftp_resume_local_tail(const char *path,
+                                              const uint64_t offset,
+                                              char *hex) {
+  lv_libssh2_mapping_t mapping;
+  if (lv_libssh2_status_is_err(lv_libssh2_mapping_open_read(&mapping, path))) {
+    return false;
+  }
+  const uint64_t start = offset < TAIL_SIZE ? 0 : offset - TAIL_SIZE;
+  uint8_t *data = NULL;
+  size_t len = 0;
+  lv_libssh2_status_t status = lv_libssh2_mapping_map(
+      &mapping, start, (size_t)(offset - start), &data, &len);
+  bool complete =
+      lv_libssh2_status_is_ok(status) && len == (size_t)(offset - start);
+  if (complete) {
+    lv_libssh2_sftp_resume_digest(data, len, hex);
+  }
+  lv_libssh2_mapping_close(&mapping);
+  return complete;
+}
+
+/* Digests the bytes of the remote file that end at the offset. */
+static bool lv_libssh2_sftp_resume_remote_tail(lv_libssh2_sftp_t *sftp,
+                                               const char *path,
+                                               const uint64_t offset,
+                                               char *hex) {
+  LIBSSH2_SFTP_HANDLE *remote =
+      libssh2_sftp_open_ex(sftp->inner, path, (unsigned int)strlen(path),
+                           LIBSSH2_FXF_READ, 0, LIBSSH2_SFTP_OPENFILE);
+  if (remote == NULL) {
+    return false;
+  }
+  uint8_t *buffer = malloc(TAIL_SIZE);
+  const uint64_t start = offset < TAIL_SIZE ? 0 : offset - TAIL_SIZE;
+  const size_t len = (size_t)(offset - start);
+  size_t total = 0;
+  if (buffer != NULL) {
+    libssh2_sftp_seek64(remote, start);
+    while (total < len) {
+      ssize_t count =
+          libssh2_sftp_read(remote, (char *)buffer + total, len - total);
+      if (count <= 0) {
+        break;
+      }
+      total += (size_t)count;
+    }
+  }
+  libssh2_sftp_close_handle(remote);
+  bool complete = buffer != NULL && total == len;
+  if (complete) {
+    lv_libssh2_sftp_resume_digest(buffer, len, hex);
+  }
+  free(buffer);
+  return complete;
+}
+
+static bool lv_libssh2_sftp_journal_read(const char *path,
+                                         lv_libssh2_sftp_journal_t *journal) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    return false;
+  }
+  char header[sizeof(JOURNAL_HEADER) + 1];
+  bool valid = fgets(header, sizeof(header), file) != NULL &&
+               strncmp(header, JOURNAL_HEADER, strlen(JOURNAL_HEADER)) == 0 &&
+               fscanf(file, "%" SCNu64 " %" SCNu64 " %" SCNu64 " %32s",
+                      &journal->source_size, &journal->source_mtime,
+                      &journal->offset, journal->digest) == 4;
+  fclose(file);
+  if (valid && strcmp(journal->digest, "-") == 0) {
+    journal->digest[0] = '\0';
+  }
+  return valid;
+}
+
+static void
+lv_libssh2_sftp_journal_write(const char *path,
+                              const lv_libssh2_sftp_journal_t *journal) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    return;
+  }
+  fprintf(file, "%s\n%" PRIu64 " %" PRIu64 " %" PRIu64 " %s\n",
+          JOURNAL_HEADER, journal->source_size, journal->source_mtime,
+          journal->offset,
+          journal->digest[0] != '\0' ? journal->digest : "-");
+  fclose(file);
+}
+
+/* Records the offset as committed, along with the digest of the data just
+ * before it if the tail is verified on resume. */
+static void lv_libssh2_sftp_resume_checkpoint(lv_libssh2_sftp_resume_t *resume,
+                                              const uint64_t offset) {
+  resume->journal.offset = offset;
+  resume->journal.digest[0] = '\0';
+  if (resume->verify_tail && offset > 0 &&
+      !lv_libssh2_sftp_resume_local_tail(resume->tail_path, offset,
+                                         resume->journal.digest)) {
+    resume->journal.digest[0] = '\0';
+  }
+  lv_libssh2_sftp_journal_write(resume->journal_path, &resume->journal);
+  resume->next_checkpoint = offset + CHECKPOINT_INTERVAL;
+}
+
+static bool lv_libssh2_sftp_resume_progress(void *context,
+                                            const uint64_t byte_count) {
+  lv_libssh2_sftp_resume_t *resume = context;
+  if (byte_count >= resume->next_checkpoint) {
+    lv_libssh2_sftp_resume_checkpoint(resume, byte_count);
+  }
+  return true;
+}
+
+/* Gets the offset to continue from, or zero if the journal is missing, is
+ * for a different source, or does not match the destination. */
+static uint64_t lv_libssh2_sftp_resume_offset(
+    lv_libssh2_sftp_t *sftp, const lv_libssh2_sftp_resume_t *resume,
+    const uint64_t source_size, const uint64_t source_mtime,
+    const uint64_t destination_size, const char *remote_destination) {
+  lv_libssh2_sftp_journal_t journal;
+  if (!lv_libssh2_sftp_journal_read(resume->journal_path, &journal) ||
+      journal.source_size != source_size ||
+      journal.source_mtime != source_mtime || journal.offset > source_size ||
+      journal.offset > destination_size) {
+    return 0;
+  }
+  if (resume->verify_tail && journal.offset > 0) {
+    char digest[DIGEST_HEX_LEN + 1];
+    bool read = remote_destination != NULL
+                    ? lv_libssh2_sftp_resume_remote_tail(
+                          sftp, remote_destination, journal.offset, digest)
+                    : lv_libssh2_sftp_resume_local_tail(
+                          resume->tail_path, journal.offset, digest);
+    if (!read || journal.digest[0] == '\0' ||
+        strcmp(digest, journal.digest) != 0) {
+      return 0;
+    }
+  }
+  return journal.offset;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_resume_remote_stat(lv_libssh2_sftp_t *sftp, const char *path,
+                                   bool *exists, uint64_t *size,
+                                   uint64_t *mtime) {
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  int result = libssh2_sftp_stat_ex(sftp->inner, path,
+                                    (unsigned int)strlen(path),
+                                    LIBSSH2_SFTP_STAT, &attributes);
+  *exists = false;
+  *size = 0;
+  *mtime = 0;
+  if (result != 0) {
+    lv_libssh2_status_t status =
+        lv_libssh2_sftp_status_from_result(sftp->inner, result);
+    return status == LV_LIBSSH2_STATUS_ERROR_SFTP_NO_SUCH_FILE
+               ? LV_LIBSSH2_STATUS_OK
+               : status;
+  }
+  *exists = true;
+  *size = attributes.filesize;
+  *mtime = attributes.mtime;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static bool lv_libssh2_sftp_resume_local_stat(const char *path,
+                                              uint64_t *size,
+                                              uint64_t *mtime) {
+#ifdef _WIN32
+  struct _stat64 info;
+  int result = _stat64(path, &info);
+#else
+  struct stat info;
+  int result = stat(path, &info);
+#endif
+  *size = 0;
+  *mtime = 0;
+  if (result != 0) {
+    return false;
+  }
+  *size = (uint64_t)info.st_size;
+  *mtime = (uint64_t)info.st_mtime;
+  return true;
+}
+
+/* Either the transfer completed and the journal is no longer needed, or it
+ * records how far the transfer got. */
+static void lv_libssh2_sftp_resume_finish(lv_libssh2_sftp_resume_t *resume,
+                                          const lv_libssh2_status_t status,
+                                          const uint64_t byte_count) {
+  if (lv_libssh2_status_is_ok(status)) {
+    remove(resume->journal_path);
+  } else {
+    lv_libssh2_sftp_resume_checkpoint(resume, byte_count);
+  }
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_download_resumable(
+    lv_libssh2_sftp_t *sftp, const char *remote_path, const char *local_path,
+    const char *journal_path, const bool verify_tail, const size_t chunk_size,
+    const size_t window_depth, uint64_t *resumed_offset,
+    uint64_t *byte_count) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (journal_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (resumed_offset == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *resumed_offset = 0;
+  *byte_count = 0;
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  bool exists = false;
+  uint64_t source_size = 0;
+  uint64_t source_mtime = 0;
+  lv_libssh2_status_t status = lv_libssh2_sftp_resume_remote_stat(
+      sftp, remote_path, &exists, &source_size, &source_mtime);
+  libssh2_session_set_blocking(sftp->session, blocking);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  if (!exists) {
+    return LV_LIBSSH2_STATUS_ERROR_SFTP_NO_SUCH_FILE;
+  }
+  lv_libssh2_sftp_resume_t resume;
+  lv_libssh2_sftp_resume_init(&resume, journal_path, local_path, verify_tail);
+  uint64_t local_size = 0;
+  uint64_t local_mtime = 0;
+  if (lv_libssh2_sftp_resume_local_stat(local_path, &local_size,
+                                        &local_mtime)) {
+    *resumed_offset = lv_libssh2_sftp_resume_offset(
+        sftp, &resume, source_size, source_mtime, local_size, NULL);
+  }
+  resume.journal.source_size = source_size;
+  resume.journal.source_mtime = source_mtime;
+  lv_libssh2_sftp_resume_checkpoint(&resume, *resumed_offset);
+  status = lv_libssh2_sftp_transfer_download(
+      sftp, remote_path, local_path, *resumed_offset, chunk_size, window_depth,
+      lv_libssh2_sftp_resume_progress, &resume, byte_count);
+  lv_libssh2_sftp_resume_finish(&resume, status, *byte_count);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_upload_resumable(
+    lv_libssh2_sftp_t *sftp, const char *local_path, const char *remote_path,
+    const char *journal_path, const int32_t permissions,
+    const bool verify_tail, const size_t chunk_size,
+    const size_t window_depth, uint64_t *resumed_offset,
+    uint64_t *byte_count) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (journal_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (resumed_offset == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *resumed_offset = 0;
+  *byte_count = 0;
+  uint64_t source_size = 0;
+  uint64_t source_mtime = 0;
+  if (!lv_libssh2_sftp_resume_local_stat(local_path, &source_size,
+                                         &source_mtime)) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  bool exists = false;
+  uint64_t remote_size = 0;
+  uint64_t remote_mtime = 0;
+  lv_libssh2_status_t status = lv_libssh2_sftp_resume_remote_stat(
+      sftp, remote_path, &exists, &remote_size, &remote_mtime);
+  /* The digest recorded at each checkpoint is of the local bytes that were
+   * just acknowledged, and on resume it is compared with the remote bytes
+   * that should be the same. */
+  lv_libssh2_sftp_resume_t resume;
+  lv_libssh2_sftp_resume_init(&resume, journal_path, local_path, verify_tail);
+  if (lv_libssh2_status_is_ok(status) && exists) {
+    *resumed_offset = lv_libssh2_sftp_resume_offset(
+        sftp, &resume, source_size, source_mtime, remote_size, remote_path);
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  resume.journal.source_size = source_size;
+  resume.journal.source_mtime = source_mtime;
+  lv_libssh2_sftp_resume_checkpoint(&resume, *resumed_offset);
+  status = lv_libssh2_sftp_transfer_upload(
+      sftp, local_path, remote_path, *resumed_offset, permissions, chunk_size,
+      window_depth, lv_libssh2_sftp_resume_progress, &resume, byte_count);
+  lv_libssh2_sftp_resume_finish(&resume, status, *byte_count);
+  return status;
+}
@@ -0,0 +1,252 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-sftp-cache-private.h"
+#include "lv-libssh2-sftp-listing-private.h"
+#include "lv-libssh2-sftp-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define DEFAULT_LANE_COUNT 4
+#define MAX_LANE_COUNT 8
+#define WAIT_PERIOD 100
+
+typedef struct _lv_libssh2_sftp_stat_lane {
+  LIBSSH2_SFTP *inner;
+  bool busy;
+  size_t index;
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+} lv_libssh2_sftp_stat_lane_t;
+
+/* Opens up to `wanted` extra SFTP channels into the lane states. Opening
+ * fewer than wanted, such as when the server limits the channels of a
+ * session, is not an error as long as there is one. */
+static lv_libssh2_status_t
+lv_libssh2_sftp_lanes_open(lv_libssh2_sftp_t *sftp,
+                           lv_libssh2_sftp_stat_lane_t *lanes,
+                           const size_t wanted, size_t *lane_count) {
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  int error = 0;
+  *lane_count = 0;
+  while (*lane_count < wanted) {
+    LIBSSH2_SFTP *lane = libssh2_sftp_init(sftp->session);
+    if (lane == NULL) {
+      error = libssh2_session_last_errno(sftp->session);
+      break;
+    }
+    lanes[*lane_count].inner = lane;
+    *lane_count += 1;
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  if (*lane_count == 0) {
+    return lv_libssh2_status_from_result(error);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+/* Closes the extra SFTP channels, so the session is left with the channels
+ * it had before the batch. */
+static void lv_libssh2_sftp_lanes_close(lv_libssh2_sftp_t *sftp,
+                                        lv_libssh2_sftp_stat_lane_t *lanes,
+                                        const size_t lane_count) {
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  for (size_t i = 0; i < lane_count; i++) {
+    libssh2_sftp_shutdown(lanes[i].inner);
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+}
+
+/* Hands the next path that is not answered by the cache to the lane. */
+static bool lv_libssh2_sftp_stat_dispatch(
+    lv_libssh2_sftp_t *sftp, lv_libssh2_sftp_stat_lane_t *lane,
+    const char *paths, const size_t *offsets, const size_t count, size_t *next,
+    size_t *done, lv_libssh2_sftp_listing_record_t *records,
+    lv_libssh2_status_t *statuses) {
+  while (*next < count) {
+    size_t index = *next;
+    *next += 1;
+    LIBSSH2_SFTP_ATTRIBUTES attributes;
+    if (lv_libssh2_sftp_cache_find_attributes(
+            sftp->cache, LV_LIBSSH2_SFTP_CACHE_KIND_STATUS,
+            paths + offsets[index], &attributes, &statuses[index])) {
+      if (lv_libssh2_status_is_ok(statuses[index])) {
+        lv_libssh2_sftp_listing_fill_record(&records[index], &attributes);
+      }
+      *done += 1;
+      continue;
+    }
+    lane->busy = true;
+    lane->index = index;
+    return true;
+  }
+  return false;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_stat_many(
+    lv_libssh2_sftp_t *sftp, const char *paths, const size_t paths_len,
+    const size_t count, const size_t lanes,
+    lv_libssh2_sftp_listing_record_t *records, lv_libssh2_status_t *statuses) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (paths == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (records == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (statuses == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (count == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  size_t *offsets = malloc(count * sizeof(size_t));
+  if (offsets == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  /* Every path must be terminated inside the buffer. */
+  size_t offset = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *end = offset < paths_len
+                          ? memchr(paths + offset, '\0', paths_len - offset)
+                          : NULL;
+    if (end == NULL) {
+      free(offsets);
+      return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+    }
+    offsets[i] = offset;
+    memset(&records[i], 0, sizeof(lv_libssh2_sftp_listing_record_t));
+    records[i].name_offset = (uint32_t)offset;
+    records[i].name_len = (uint32_t)(end - (paths + offset));
+    records[i].type = (uint32_t)LV_LIBSSH2_FILE_TYPE_UNKNOWN;
+    statuses[i] = LV_LIBSSH2_STATUS_OK;
+    offset += records[i].name_len + 1;
+  }
+  size_t wanted = lanes == 0 ? DEFAULT_LANE_COUNT : lanes;
+  if (wanted > MAX_LANE_COUNT) {
+    wanted = MAX_LANE_COUNT;
+  }
+  if (wanted > count) {
+    wanted = count;
+  }
+  lv_libssh2_sftp_stat_lane_t *lane_states =
+      calloc(wanted, sizeof(lv_libssh2_sftp_stat_lane_t));
+  if (lane_states == NULL) {
+    free(offsets);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  size_t lane_count = 0;
+  lv_libssh2_status_t status =
+      lv_libssh2_sftp_lanes_open(sftp, lane_states, wanted, &lane_count);
+  if (lv_libssh2_status_is_err(status)) {
+    free(lane_states);
+    free(offsets);
+    return status;
+  }
+  /* Each lane has one request in flight, so the server works on as many
+   * paths at once as there are lanes. The session is driven without
+   * blocking and the socket is only waited on once no lane can progress. */
+  const long timeout = libssh2_session_get_timeout(sftp->session);
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 0);
+  uint64_t last_progress = lv_libssh2_time_now();
+  size_t next = 0;
+  size_t done = 0;
+  while (done < count && lv_libssh2_status_is_ok(status)) {
+    bool progressed = false;
+    for (size_t i = 0; i < lane_count && lv_libssh2_status_is_ok(status);
+         i++) {
+      lv_libssh2_sftp_stat_lane_t *lane = &lane_states[i];
+      if (!lane->busy) {
+        size_t before = done;
+        if (!lv_libssh2_sftp_stat_dispatch(sftp, lane, paths, offsets, count,
+                                           &next, &done, records, statuses)) {
+          progressed = progressed || done > before;
+          continue;
+        }
+      }
+      const char *path = paths + offsets[lane->index];
+      int result = libssh2_sftp_stat_ex(lane->inner, path,
+                                        records[lane->index].name_len,
+                                        LIBSSH2_SFTP_STAT, &lane->attributes);
+      if (result == LIBSSH2_ERROR_EAGAIN) {
+        continue;
+      }
+      progressed = true;
+      lane->busy = false;
+      if (result == 0) {
+        lv_libssh2_sftp_listing_fill_record(&records[lane->index],
+                                            &lane->attributes);
+      } else if (result == LIBSSH2_ERROR_SFTP_PROTOCOL) {
+        statuses[lane->index] =
+            lv_libssh2_sftp_status_from_result(lane->inner, result);
+      } else {
+        status = lv_libssh2_status_from_result(result);
+        break;
+      }
+      lv_libssh2_sftp_cache_store_attributes(
+          sftp->cache, LV_LIBSSH2_SFTP_CACHE_KIND_STATUS, path,
+          &lane->attributes, statuses[lane->index]);
+      done += 1;
+    }
+    if (progressed) {
+      last_progress = lv_libssh2_time_now();
+    } else if (lv_libssh2_status_is_ok(status)) {
+      if (timeout > 0 &&
+          lv_libssh2_time_elapsed(last_progress) / 1000 >= (uint64_t)timeout) {
+        status = LV_LIBSSH2_STATUS_ERROR_TIMEOUT;
+        break;
+      }
+      lv_libssh2_session_wait(sftp->owner, WAIT_PERIOD);
+    }
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  /* The lanes are not kept for the next batch, because servers limit the
+   * channels of a session and other channels would fail to open. */
+  lv_libssh2_sftp_lanes_close(sftp, lane_states, lane_count);
+  free(lane_states);
+  free(offsets);
+  return status;
+}
@@ -0,0 +1,667 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/utime.h>
+#else
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <openssl/evp.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-exec-private.h"
+#include "lv-libssh2-sftp-cache-private.h"
+#include "lv-libssh2-sftp-private.h"
+#include "lv-libssh2-sftp-transfer-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2.h"
+
+#define DEFAULT_BLOCK_SIZE (1024 * 1024)
+#define DEFAULT_PERMISSIONS 0644
+#define DIGEST_HEX_LEN 32
+#define COMMAND_EXTRA_LEN 192
+
+typedef struct _lv_libssh2_sftp_sync_file {
+  bool exists;
+  uint64_t size;
+  uint64_t mtime;
+} lv_libssh2_sftp_sync_file_t;
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_local_stat(const char *path,
+                                lv_libssh2_sftp_sync_file_t *file) {
+#ifdef _WIN32
+  struct _stat64 info;
+  int result = _stat64(path, &info);
+#else
+  struct stat info;
+  int result = stat(path, &info);
+#endif
+  if (result != 0) {
+    file->exists = false;
+    return errno == ENOENT ? LV_LIBSSH2_STATUS_OK
+                           : LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  file->exists = true;
+  file->size = (uint64_t)info.st_size;
+  file->mtime = (uint64_t)info.st_mtime;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_remote_stat(lv_libssh2_sftp_t *sftp, const char *path,
+                                 lv_libssh2_sftp_sync_file_t *file) {
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  int result = libssh2_sftp_stat_ex(sftp->inner, path,
+                                    (unsigned int)strlen(path),
+                                    LIBSSH2_SFTP_STAT, &attributes);
+  if (result != 0) {
+    file->exists = false;
+    lv_libssh2_status_t status =
+        lv_libssh2_sftp_status_from_result(sftp->inner, result);
+    return status == LV_LIBSSH2_STATUS_ERROR_SFTP_NO_SUCH_FILE
+               ? LV_LIBSSH2_STATUS_OK
+               : status;
+  }
+  if ((attributes.flags & LIBSSH2_SFTP_ATTR_SIZE) == 0) {
+    return LV_LIBSSH2_STATUS_ERROR_SFTP_BAD_MESSAGE;
+  }
+  file->exists = true;
+  file->size = attributes.filesize;
+  file->mtime = (attributes.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) != 0
+                    ? attributes.mtime
+                    : 0;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static bool lv_libssh2_sftp_sync_unchanged(lv_libssh2_sftp_sync_file_t *a,
+                                           lv_libssh2_sftp_sync_file_t *b) {
+  return a->size == b->size && a->mtime == b->mtime && a->mtime != 0;
+}
+
+static int lv_libssh2_sftp_sync_seek(FILE *file, const uint64_t offset) {
+#ifdef _WIN32
+  return _fseeki64(file, (__int64)offset, SEEK_SET);
+#else
+  return fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_read_local(FILE *file, const uint64_t offset,
+                                uint8_t *buffer, const size_t len) {
+  if (lv_libssh2_sftp_sync_seek(file, offset) != 0 ||
+      fread(buffer, 1, len, file) != len) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_write_local(FILE *file, const uint64_t offset,
+                                 const uint8_t *buffer, const size_t len) {
+  if (lv_libssh2_sftp_sync_seek(file, offset) != 0 ||
+      fwrite(buffer, 1, len, file) != len) {
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_read_remote(LIBSSH2_SFTP *sftp,
+                                 LIBSSH2_SFTP_HANDLE *handle,
+                                 const uint64_t offset, uint8_t *buffer,
+                                 const size_t len) {
+  libssh2_sftp_seek64(handle, offset);
+  size_t total = 0;
+  while (total < len) {
+    ssize_t result =
+        libssh2_sftp_read(handle, (char *)buffer + total, len - total);
+    if (result < 0) {
+      return lv_libssh2_sftp_status_from_result(sftp, (int)result);
+    }
+    if (result == 0) {
+      /* The remote file shrank after it was compared. */
+      return LV_LIBSSH2_STATUS_ERROR_SFTP_EOF;
+    }
+    total += (size_t)result;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_write_remote(LIBSSH2_SFTP *sftp,
+                                  LIBSSH2_SFTP_HANDLE *handle,
+                                  const uint64_t offset, const uint8_t *buffer,
+                                  const size_t len) {
+  libssh2_sftp_seek64(handle, offset);
+  size_t total = 0;
+  while (total < len) {
+    ssize_t result =
+        libssh2_sftp_write(handle, (const char *)buffer + total, len - total);
+    if (result < 0) {
+      return lv_libssh2_sftp_status_from_result(sftp, (int)result);
+    }
+    total += (size_t)result;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static lv_libssh2_status_t lv_libssh2_sftp_sync_digest(FILE *file,
+                                                       const uint64_t offset,
+                                                       const uint64_t len,
+                                                       uint8_t *buffer,
+                                                       const size_t buffer_len,
+                                                       char *hex) {
+  EVP_MD_CTX *context = EVP_MD_CTX_new();
+  if (context == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (EVP_DigestInit_ex(context, EVP_md5(), NULL) != 1 ||
+      lv_libssh2_sftp_sync_seek(file, offset) != 0) {
+    status = LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  uint64_t remaining = len;
+  while (lv_libssh2_status_is_ok(status) && remaining > 0) {
+    size_t count = remaining < buffer_len ? (size_t)remaining : buffer_len;
+    if (fread(buffer, 1, count, file) != count ||
+        EVP_DigestUpdate(context, buffer, count) != 1) {
+      status = LV_LIBSSH2_STATUS_ERROR_FILE;
+    }
+    remaining -= count;
+  }
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_len = 0;
+  if (lv_libssh2_status_is_ok(status) &&
+      EVP_DigestFinal_ex(context, digest, &digest_len) != 1) {
+    status = LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  EVP_MD_CTX_free(context);
+  if (lv_libssh2_status_is_ok(status)) {
+    static const char digits[] = "0123456789abcdef";
+    for (unsigned int i = 0; i < digest_len; i++) {
+      hex[i * 2] = digits[digest[i] >> 4];
+      hex[i * 2 + 1] = digits[digest[i] & 0x0f];
+    }
+  }
+  return status;
+}
+
+/* Quotes the path for a POSIX shell. */
+static char *lv_libssh2_sftp_sync_quote(const char *path) {
+  size_t len = 2;
+  for (const char *c = path; *c != '\0'; c++) {
+    len += *c == '\'' ? 4 : 1;
+  }
+  char *quoted = malloc(len + 1);
+  if (quoted == NULL) {
+    return NULL;
+  }
+  char *out = quoted;
+  *out++ = '\'';
+  for (const char *c = path; *c != '\0'; c++) {
+    if (*c == '\'') {
+      memcpy(out, "'\\''", 4);
+      out += 4;
+    } else {
+      *out++ = *c;
+    }
+  }
+  *out++ = '\'';
+  *out = '\0';
+  return quoted;
+}
+
+/* Runs a checksum command and returns its standard output. */
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_run(lv_libssh2_session_t *session, const char *command,
+                         lv_libssh2_exec_result_t **result) {
+  lv_libssh2_status_t status =
+      lv_libssh2_exec_capture(session, command, -1, result);
+  if (lv_libssh2_status_is_ok(status) && (*result)->exit_code != 0) {
+    lv_libssh2_exec_result_destroy(*result);
+    *result = NULL;
+    status = LV_LIBSSH2_STATUS_ERROR_REMOTE_COMMAND;
+  }
+  return status;
+}
+
+/* Finds the blocks of the first `overlap` bytes that differ between the local
+ * and remote files. The `changed` array is left NULL when none differ.
+ *
+ * A single digest of the whole overlap is compared first, which settles the
+ * common case of a file that only grew by appending with one remote command.
+ * Otherwise the remote side digests each block, reading the file once from a
+ * single descriptor so that no block is opened or seeked to on its own. */
+static lv_libssh2_status_t lv_libssh2_sftp_sync_compare(
+    lv_libssh2_session_t *session, FILE *local, const char *remote_path,
+    const uint64_t overlap, uint8_t *buffer, const size_t block_size,
+    bool **changed, size_t *block_count) {
+  *changed = NULL;
+  *block_count = 0;
+  if (overlap == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  char *quoted = lv_libssh2_sftp_sync_quote(remote_path);
+  if (quoted == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  size_t command_len = strlen(quoted) + COMMAND_EXTRA_LEN;
+  char *command = malloc(command_len);
+  if (command == NULL) {
+    free(quoted);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  snprintf(command, command_len, "head -c %llu %s | md5sum",
+           (unsigned long long)overlap, quoted);
+  lv_libssh2_exec_result_t *result = NULL;
+  char local_hex[DIGEST_HEX_LEN];
+  lv_libssh2_status_t status =
+      lv_libssh2_sftp_sync_run(session, command, &result);
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_sftp_sync_digest(local, 0, overlap, buffer,
+                                         block_size, local_hex);
+  }
+  if (lv_libssh2_status_is_ok(status) && result->out.len >= DIGEST_HEX_LEN &&
+      memcmp(result->out.data, local_hex, DIGEST_HEX_LEN) == 0) {
+    lv_libssh2_exec_result_destroy(result);
+    free(command);
+    free(quoted);
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  if (result != NULL) {
+    lv_libssh2_exec_result_destroy(result);
+    result = NULL;
+  }
+  const size_t count = (size_t)((overlap + block_size - 1) / block_size);
+  if (lv_libssh2_status_is_ok(status)) {
+    snprintf(command, command_len,
+             "{ i=0; while [ $i -lt %llu ]; do "
+             "dd bs=%llu count=1 2>/dev/null | md5sum; "
+             "i=$((i+1)); done; } < %s",
+             (unsigned long long)count, (unsigned long long)block_size,
+             quoted);
+    status = lv_libssh2_sftp_sync_run(session, command, &result);
+  }
+  free(command);
+  free(quoted);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  bool *blocks = calloc(count, sizeof(bool));
+  if (blocks == NULL) {
+    lv_libssh2_exec_result_destroy(result);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  const char *line = (const char *)result->out.data;
+  const char *end = line + result->out.len;
+  for (size_t i = 0; i < count && lv_libssh2_status_is_ok(status); i++) {
+    const uint64_t offset = (uint64_t)i * block_size;
+    const uint64_t len =
+        overlap - offset < block_size ? overlap - offset : block_size;
+    status = lv_libssh2_sftp_sync_digest(local, offset, len, buffer,
+                                         block_size, local_hex);
+    if (end - line < DIGEST_HEX_LEN) {
+      status = LV_LIBSSH2_STATUS_ERROR_REMOTE_COMMAND;
+      break;
+    }
+    blocks[i] = memcmp(line, local_hex, DIGEST_HEX_LEN) != 0;
+    const char *next = memchr(line, '\n', (size_t)(end - line));
+    line = next == NULL ? end : next + 1;
+  }
+  lv_libssh2_exec_result_destroy(result);
+  if (lv_libssh2_status_is_err(status)) {
+    free(blocks);
+    return status;
+  }
+  *changed = blocks;
+  *block_count = count;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_set_remote(lv_libssh2_sftp_t *sftp, const char *path,
+                                const lv_libssh2_sftp_sync_file_t *local,
+                                const bool truncate) {
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.flags = LIBSSH2_SFTP_ATTR_ACMODTIME;
+  attributes.atime = (unsigned long)local->mtime;
+  attributes.mtime = (unsigned long)local->mtime;
+  if (truncate) {
+    attributes.flags |= LIBSSH2_SFTP_ATTR_SIZE;
+    attributes.filesize = local->size;
+  }
+  int result = libssh2_sftp_stat_ex(sftp->inner, path,
+                                    (unsigned int)strlen(path),
+                                    LIBSSH2_SFTP_SETSTAT, &attributes);
+  return lv_libssh2_sftp_status_from_result(sftp->inner, result);
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_sync_set_local(const char *path,
+                               const lv_libssh2_sftp_sync_file_t *remote) {
+#ifdef _WIN32
+  struct __utimbuf64 times;
+  times.actime = (__time64_t)remote->mtime;
+  times.modtime = (__time64_t)remote->mtime;
+  int result = _utime64(path, &times);
+#else
+  struct utimbuf times;
+  times.actime = (time_t)remote->mtime;
+  times.modtime = (time_t)remote->mtime;
+  int result = utime(path, &times);
+#endif
+  return result == 0 ? LV_LIBSSH2_STATUS_OK : LV_LIBSSH2_STATUS_ERROR_FILE;
+}
+
+static int lv_libssh2_sftp_sync_truncate(FILE *file, const uint64_t size) {
+  if (fflush(file) != 0) {
+    return -1;
+  }
+#ifdef _WIN32
+  return _chsize_s(_fileno(file), (__int64)size) == 0 ? 0 : -1;
+#else
+  return ftruncate(fileno(file), (off_t)size);
+#endif
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_sync_upload(lv_libssh2_sftp_t *sftp,
+                            lv_libssh2_session_t *session,
+                            const char *local_path, const char *remote_path,
+                            const size_t block_size, uint64_t *byte_count) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *byte_count = 0;
+  const size_t block = block_size == 0 ? DEFAULT_BLOCK_SIZE : block_size;
+  lv_libssh2_sftp_sync_file_t local_file;
+  lv_libssh2_sftp_sync_file_t remote_file;
+  lv_libssh2_status_t status =
+      lv_libssh2_sftp_sync_local_stat(local_path, &local_file);
+  if (lv_libssh2_status_is_ok(status) && !local_file.exists) {
+    status = LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_sftp_sync_remote_stat(sftp, remote_path, &remote_file);
+  }
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_sftp_cache_invalidate(sftp->cache, remote_path);
+  if (!remote_file.exists) {
+    status = lv_libssh2_sftp_transfer_upload(sftp, local_path, remote_path, 0,
+                                             DEFAULT_PERMISSIONS, 0, 0, NULL,
+                                             NULL, byte_count);
+    if (lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_sync_set_remote(sftp, remote_path, &local_file,
+                                               false);
+    }
+    return status;
+  }
+  if (lv_libssh2_sftp_sync_unchanged(&local_file, &remote_file)) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  uint8_t *buffer = malloc(block);
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  FILE *local = fopen(local_path, "rb");
+  if (local == NULL) {
+    free(buffer);
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  const uint64_t overlap = local_file.size < remote_file.size
+                               ? local_file.size
+                               : remote_file.size;
+  bool *changed = NULL;
+  size_t block_count = 0;
+  status = lv_libssh2_sftp_sync_compare(session, local, remote_path, overlap,
+                                        buffer, block, &changed, &block_count);
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  LIBSSH2_SFTP_HANDLE *remote = NULL;
+  if (lv_libssh2_status_is_ok(status)) {
+    remote = libssh2_sftp_open_ex(
+        sftp->inner, remote_path, (unsigned int)strlen(remote_path),
+        LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT, DEFAULT_PERMISSIONS,
+        LIBSSH2_SFTP_OPENFILE);
+    if (remote == NULL) {
+      status = lv_libssh2_sftp_status_from_result(
+          sftp->inner, libssh2_session_last_errno(sftp->session));
+    }
+  }
+  for (size_t i = 0; i < block_count && lv_libssh2_status_is_ok(status); i++) {
+    if (!changed[i]) {
+      continue;
+    }
+    const uint64_t offset = (uint64_t)i * block;
+    const size_t len =
+        overlap - offset < block ? (size_t)(overlap - offset) : block;
+    status = lv_libssh2_sftp_sync_read_local(local, offset, buffer, len);
+    if (lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_sync_write_remote(sftp->inner, remote, offset,
+                                                 buffer, len);
+    }
+    if (lv_libssh2_status_is_ok(status)) {
+      *byte_count += len;
+    }
+  }
+  for (uint64_t offset = overlap;
+       offset < local_file.size && lv_libssh2_status_is_ok(status);) {
+    const size_t len = local_file.size - offset < block
+                           ? (size_t)(local_file.size - offset)
+                           : block;
+    status = lv_libssh2_sftp_sync_read_local(local, offset, buffer, len);
+    if (lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_sync_write_remote(sftp->inner, remote, offset,
+                                                 buffer, len);
+    }
+    if (lv_libssh2_status_is_ok(status)) {
+      *byte_count += len;
+    }
+    offset += len;
+  }
+  /* A write that the server only fails when the handle is closed is still
+   * reported. */
+  if (remote != NULL) {
+    int result = libssh2_sftp_close_handle(remote);
+    if (result != 0 && lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, result);
+    }
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_sftp_sync_set_remote(
+        sftp, remote_path, &local_file, remote_file.size > local_file.size);
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  free(changed);
+  fclose(local);
+  free(buffer);
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_sync_download(lv_libssh2_sftp_t *sftp,
+                              lv_libssh2_session_t *session,
+                              const char *remote_path, const char *local_path,
+                              const size_t block_size, uint64_t *byte_count) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *byte_count = 0;
+  const size_t block = block_size == 0 ? DEFAULT_BLOCK_SIZE : block_size;
+  lv_libssh2_sftp_sync_file_t remote_file;
+  lv_libssh2_sftp_sync_file_t local_file;
+  lv_libssh2_status_t status =
+      lv_libssh2_sftp_sync_remote_stat(sftp, remote_path, &remote_file);
+  if (lv_libssh2_status_is_ok(status) && !remote_file.exists) {
+    status = LV_LIBSSH2_STATUS_ERROR_SFTP_NO_SUCH_FILE;
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_sftp_sync_local_stat(local_path, &local_file);
+  }
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  if (!local_file.exists) {
+    status = lv_libssh2_sftp_transfer_download(
+        sftp, remote_path, local_path, 0, 0, 0, NULL, NULL, byte_count);
+    if (lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_sync_set_local(local_path, &remote_file);
+    }
+    return status;
+  }
+  if (lv_libssh2_sftp_sync_unchanged(&local_file, &remote_file)) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  uint8_t *buffer = malloc(block);
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  FILE *local = fopen(local_path, "r+b");
+  if (local == NULL) {
+    free(buffer);
+    return LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  const uint64_t overlap = local_file.size < remote_file.size
+                               ? local_file.size
+                               : remote_file.size;
+  bool *changed = NULL;
+  size_t block_count = 0;
+  status = lv_libssh2_sftp_sync_compare(session, local, remote_path, overlap,
+                                        buffer, block, &changed, &block_count);
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  LIBSSH2_SFTP_HANDLE *remote = NULL;
+  if (lv_libssh2_status_is_ok(status)) {
+    remote = libssh2_sftp_open_ex(sftp->inner, remote_path,
+                                  (unsigned int)strlen(remote_path),
+                                  LIBSSH2_FXF_READ, 0, LIBSSH2_SFTP_OPENFILE);
+    if (remote == NULL) {
+      status = lv_libssh2_sftp_status_from_result(
+          sftp->inner, libssh2_session_last_errno(sftp->session));
+    }
+  }
+  for (size_t i = 0; i < block_count && lv_libssh2_status_is_ok(status); i++) {
+    if (!changed[i]) {
+      continue;
+    }
+    const uint64_t offset = (uint64_t)i * block;
+    const size_t len =
+        overlap - offset < block ? (size_t)(overlap - offset) : block;
+    status = lv_libssh2_sftp_sync_read_remote(sftp->inner, remote, offset,
+                                              buffer, len);
+    if (lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_sync_write_local(local, offset, buffer, len);
+    }
+    if (lv_libssh2_status_is_ok(status)) {
+      *byte_count += len;
+    }
+  }
+  for (uint64_t offset = overlap;
+       offset < remote_file.size && lv_libssh2_status_is_ok(status);) {
+    const size_t len = remote_file.size - offset < block
+                           ? (size_t)(remote_file.size - offset)
+                           : block;
+    status = lv_libssh2_sftp_sync_read_remote(sftp->inner, remote, offset,
+                                              buffer, len);
+    if (lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_sync_write_local(local, offset, buffer, len);
+    }
+    if (lv_libssh2_status_is_ok(status)) {
+      *byte_count += len;
+    }
+    offset += len;
+  }
+  if (remote != NULL) {
+    int result = libssh2_sftp_close_handle(remote);
+    if (result != 0 && lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, result);
+    }
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  if (lv_libssh2_status_is_ok(status) && local_file.size > remote_file.size &&
+      lv_libssh2_sftp_sync_truncate(local, remote_file.size) != 0) {
+    status = LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  if (fclose(local) != 0 && lv_libssh2_status_is_ok(status)) {
+    status = LV_LIBSSH2_STATUS_ERROR_FILE;
+  }
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_sftp_sync_set_local(local_path, &remote_file);
+  }
+  free(changed);
+  free(buffer);
+  return status;
+}
@@ -0,0 +1,71 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_SFTP_TRANSFER_PRIVATE_H
+#define LV_LIBSSH2_SFTP_TRANSFER_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2.h"
+
+/**
+ * Called after every chunk with the running byte count. Returning `false`
+ * cancels the transfer with ::LV_LIBSSH2_STATUS_ERROR_CANCELLED.
+ */
+typedef bool (*lv_libssh2_sftp_transfer_progress_t)(void *context,
+                                                    const uint64_t byte_count);
+
+/**
+ * Downloads the remote file from the offset into the same offset of the
+ * local file. The byte count is the offset reached, including the starting
+ * offset.
+ */
+lv_libssh2_status_t lv_libssh2_sftp_transfer_download(
+    lv_libssh2_sftp_t *sftp, const char *remote_path, const char *local_path,
+    const uint64_t offset, const size_t chunk_size, const size_t window_depth,
+    lv_libssh2_sftp_transfer_progress_t progress, void *context,
+    uint64_t *byte_count);
+
+/**
+ * Uploads the local file from the offset into the same offset of the remote
+ * file, which is only truncated if the offset is zero. The byte count is the
+ * offset reached, including the starting offset.
+ */
+lv_libssh2_status_t lv_libssh2_sftp_transfer_upload(
+    lv_libssh2_sftp_t *sftp, const char *local_path, const char *remote_path,
+    const uint64_t offset, const int32_t permissions, const size_t chunk_size,
+    const size_t window_depth, lv_libssh2_sftp_transfer_progress_t progress,
+    void *context, uint64_t *byte_count);
+
+#endif
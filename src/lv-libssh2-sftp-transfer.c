@@ -0,0 +1,407 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-mapping-private.h"
+#include "lv-libssh2-sftp-cache-private.h"
+#include "lv-libssh2-sftp-private.h"
+#include "lv-libssh2-sftp-transfer-private.h"
+#include "lv-libssh2-status-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define DEFAULT_CHUNK_SIZE 32768
+#define DEFAULT_WINDOW_DEPTH 32
+
+/* The window is capped at the size of a mapped view, which also keeps the
+ * product from overflowing. It is never zero. */
+static size_t lv_libssh2_sftp_transfer_window(const size_t chunk_size,
+                                              const size_t window_depth) {
+  size_t chunk = chunk_size == 0 ? DEFAULT_CHUNK_SIZE : chunk_size;
+  size_t depth = window_depth == 0 ? DEFAULT_WINDOW_DEPTH : window_depth;
+  if (chunk > LV_LIBSSH2_MAPPING_VIEW_SIZE / depth) {
+    return LV_LIBSSH2_MAPPING_VIEW_SIZE;
+  }
+  return chunk * depth;
+}
+
+static double lv_libssh2_sftp_transfer_rate(const uint64_t byte_count,
+                                            const uint64_t start) {
+  const uint64_t elapsed = lv_libssh2_time_elapsed(start);
+  if (elapsed == 0) {
+    return 0.0;
+  }
+  return (double)byte_count * 1000000.0 / (double)elapsed;
+}
+
+static lv_libssh2_status_t
+lv_libssh2_sftp_transfer_open(lv_libssh2_sftp_t *sftp, const char *path,
+                              const unsigned long flags, const long mode,
+                              LIBSSH2_SFTP_HANDLE **handle) {
+  if ((flags & LIBSSH2_FXF_WRITE) != 0) {
+    lv_libssh2_sftp_cache_invalidate(sftp->cache, path);
+  }
+  *handle = libssh2_sftp_open_ex(sftp->inner, path, (unsigned int)strlen(path),
+                                 flags, mode, LIBSSH2_SFTP_OPENFILE);
+  if (*handle == NULL) {
+    int error_code = libssh2_session_last_errno(sftp->session);
+    return lv_libssh2_sftp_status_from_result(sftp->inner, error_code);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_transfer_download(
+    lv_libssh2_sftp_t *sftp, const char *remote_path, const char *local_path,
+    const uint64_t offset, const size_t chunk_size, const size_t window_depth,
+    lv_libssh2_sftp_transfer_progress_t progress, void *context,
+    uint64_t *byte_count) {
+  *byte_count = offset;
+  const size_t window =
+      lv_libssh2_sftp_transfer_window(chunk_size, window_depth);
+  /* The transfer runs natively, so the session blocks until it completes. */
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  LIBSSH2_SFTP_HANDLE *remote = NULL;
+  lv_libssh2_status_t status = lv_libssh2_sftp_transfer_open(
+      sftp, remote_path, LIBSSH2_FXF_READ, 0, &remote);
+  /* The local file is sized to the remote file up front, so the data can be
+   * read straight into a mapped view of it. */
+  uint64_t size = 0;
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  if (lv_libssh2_status_is_ok(status) &&
+      libssh2_sftp_fstat_ex(remote, &attributes, 0) == 0 &&
+      (attributes.flags & LIBSSH2_SFTP_ATTR_SIZE) != 0) {
+    size = attributes.filesize;
+  }
+  if (size < offset) {
+    size = offset;
+  }
+  if (lv_libssh2_status_is_ok(status) && offset > 0) {
+    libssh2_sftp_seek64(remote, offset);
+  }
+  lv_libssh2_mapping_t local;
+  bool local_open = false;
+  if (lv_libssh2_status_is_ok(status)) {
+    status = lv_libssh2_mapping_open_write(&local, local_path, size);
+    local_open = lv_libssh2_status_is_ok(status);
+  }
+  uint8_t *view = NULL;
+  size_t view_len = 0;
+  size_t view_position = 0;
+  while (lv_libssh2_status_is_ok(status)) {
+    if (view_position == view_len) {
+      /* The remote file has grown since it was sized. */
+      if (*byte_count == local.size) {
+        status = lv_libssh2_mapping_resize(&local, local.size + window);
+        if (lv_libssh2_status_is_err(status)) {
+          break;
+        }
+      }
+      status = lv_libssh2_mapping_map(&local, *byte_count,
+                                      LV_LIBSSH2_MAPPING_VIEW_SIZE, &view,
+                                      &view_len);
+      if (lv_libssh2_status_is_err(status)) {
+        break;
+      }
+      view_position = 0;
+    }
+    size_t len = view_len - view_position;
+    if (len > window) {
+      len = window;
+    }
+    /* libssh2 splits a read of the whole window into protocol-sized READ
+     * requests that are all in flight at once, and returns as soon as the
+     * first of them has been answered. */
+    ssize_t count =
+        libssh2_sftp_read(remote, (char *)view + view_position, len);
+    if (count < 0) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, (int)count);
+      break;
+    }
+    if (count == 0) {
+      break;
+    }
+    view_position += (size_t)count;
+    *byte_count += (uint64_t)count;
+    if (progress != NULL && !progress(context, *byte_count)) {
+      status = LV_LIBSSH2_STATUS_ERROR_CANCELLED;
+      break;
+    }
+  }
+  if (remote != NULL) {
+    libssh2_sftp_close_handle(remote);
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  if (local_open) {
+    /* The file ends where the data did, even if the remote file shrank. */
+    lv_libssh2_status_t result = LV_LIBSSH2_STATUS_OK;
+    if (local.size != *byte_count) {
+      result = lv_libssh2_mapping_resize(&local, *byte_count);
+    }
+    if (lv_libssh2_status_is_ok(result)) {
+      result = lv_libssh2_mapping_close(&local);
+    } else {
+      lv_libssh2_mapping_close(&local);
+    }
+    if (lv_libssh2_status_is_ok(status)) {
+      status = result;
+    }
+  }
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_download(lv_libssh2_sftp_t *sftp,
+                                             const char *remote_path,
+                                             const char *local_path,
+                                             const size_t chunk_size,
+                                             const size_t window_depth,
+                                             uint64_t *byte_count) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  return lv_libssh2_sftp_transfer_download(sftp, remote_path, local_path, 0,
+                                           chunk_size, window_depth, NULL,
+                                           NULL, byte_count);
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_download_to_buffer(
+    lv_libssh2_sftp_t *sftp, const char *remote_path, uint8_t *buffer,
+    const size_t buffer_max_length, const size_t chunk_size,
+    const size_t window_depth, size_t *read_count) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (read_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *read_count = 0;
+  const size_t window =
+      lv_libssh2_sftp_transfer_window(chunk_size, window_depth);
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  LIBSSH2_SFTP_HANDLE *remote = NULL;
+  lv_libssh2_status_t status = lv_libssh2_sftp_transfer_open(
+      sftp, remote_path, LIBSSH2_FXF_READ, 0, &remote);
+  while (lv_libssh2_status_is_ok(status) && *read_count < buffer_max_length) {
+    size_t remaining = buffer_max_length - *read_count;
+    ssize_t count = libssh2_sftp_read(remote, (char *)buffer + *read_count,
+                                      remaining < window ? remaining : window);
+    if (count < 0) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, (int)count);
+      break;
+    }
+    if (count == 0) {
+      break;
+    }
+    *read_count += (size_t)count;
+  }
+  if (remote != NULL) {
+    libssh2_sftp_close_handle(remote);
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_transfer_upload(
+    lv_libssh2_sftp_t *sftp, const char *local_path, const char *remote_path,
+    const uint64_t offset, const int32_t permissions, const size_t chunk_size,
+    const size_t window_depth, lv_libssh2_sftp_transfer_progress_t progress,
+    void *context, uint64_t *byte_count) {
+  *byte_count = offset;
+  const size_t window =
+      lv_libssh2_sftp_transfer_window(chunk_size, window_depth);
+  lv_libssh2_mapping_t local;
+  lv_libssh2_status_t status =
+      lv_libssh2_mapping_open_read(&local, local_path);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  LIBSSH2_SFTP_HANDLE *remote = NULL;
+  status = lv_libssh2_sftp_transfer_open(
+      sftp, remote_path,
+      LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT |
+          (offset == 0 ? LIBSSH2_FXF_TRUNC : 0),
+      (long)permissions, &remote);
+  if (lv_libssh2_status_is_ok(status) && offset > 0) {
+    libssh2_sftp_seek64(remote, offset);
+  }
+  uint8_t *view = NULL;
+  size_t view_len = 0;
+  size_t start = 0;
+  while (lv_libssh2_status_is_ok(status)) {
+    if (start == view_len) {
+      status = lv_libssh2_mapping_map(&local, *byte_count,
+                                      LV_LIBSSH2_MAPPING_VIEW_SIZE, &view,
+                                      &view_len);
+      if (lv_libssh2_status_is_err(status) || view_len == 0) {
+        break;
+      }
+      start = 0;
+    }
+    size_t len = view_len - start;
+    if (len > window) {
+      len = window;
+    }
+    /* libssh2 sends the whole span as WRITE requests straight from the
+     * mapped view and returns the length of the prefix that has been
+     * acknowledged in order, so short returns and acknowledgements that
+     * arrive out of order are both absorbed by resubmitting the remainder. */
+    ssize_t count =
+        libssh2_sftp_write(remote, (const char *)view + start, len);
+    if (count < 0) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, (int)count);
+      break;
+    }
+    start += (size_t)count;
+    *byte_count += (uint64_t)count;
+    if (progress != NULL && !progress(context, *byte_count)) {
+      status = LV_LIBSSH2_STATUS_ERROR_CANCELLED;
+      break;
+    }
+  }
+  if (remote != NULL) {
+    int result = libssh2_sftp_close_handle(remote);
+    if (result != 0 && lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, result);
+    }
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  lv_libssh2_mapping_close(&local);
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_upload(lv_libssh2_sftp_t *sftp, const char *local_path,
+                       const char *remote_path, const int32_t permissions,
+                       const size_t chunk_size, const size_t window_depth,
+                       uint64_t *byte_count, double *bytes_per_second) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (bytes_per_second == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  const uint64_t start_time = lv_libssh2_time_now();
+  lv_libssh2_status_t status = lv_libssh2_sftp_transfer_upload(
+      sftp, local_path, remote_path, 0, permissions, chunk_size,
+      window_depth, NULL, NULL, byte_count);
+  *bytes_per_second = lv_libssh2_sftp_transfer_rate(*byte_count, start_time);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_upload_from_buffer(
+    lv_libssh2_sftp_t *sftp, const uint8_t *buffer, const size_t buffer_length,
+    const char *remote_path, const int32_t permissions,
+    const size_t chunk_size, const size_t window_depth, uint64_t *byte_count,
+    double *bytes_per_second) {
+  if (sftp == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (bytes_per_second == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  *byte_count = 0;
+  *bytes_per_second = 0.0;
+  const size_t window =
+      lv_libssh2_sftp_transfer_window(chunk_size, window_depth);
+  const uint64_t start_time = lv_libssh2_time_now();
+  int blocking = libssh2_session_get_blocking(sftp->session);
+  libssh2_session_set_blocking(sftp->session, 1);
+  LIBSSH2_SFTP_HANDLE *remote = NULL;
+  lv_libssh2_status_t status = lv_libssh2_sftp_transfer_open(
+      sftp, remote_path,
+      LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_TRUNC,
+      (long)permissions, &remote);
+  size_t start = 0;
+  while (lv_libssh2_status_is_ok(status) && start < buffer_length) {
+    size_t remaining = buffer_length - start;
+    ssize_t count = libssh2_sftp_write(remote, (const char *)buffer + start,
+                                       remaining < window ? remaining : window);
+    if (count < 0) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, (int)count);
+      break;
+    }
+    start += (size_t)count;
+  }
+  *byte_count = start;
+  if (remote != NULL) {
+    int result = libssh2_sftp_close_handle(remote);
+    if (result != 0 && lv_libssh2_status_is_ok(status)) {
+      status = lv_libssh2_sftp_status_from_result(sftp->inner, result);
+    }
+  }
+  libssh2_session_set_blocking(sftp->session, blocking);
+  *bytes_per_second = lv_libssh2_sftp_transfer_rate(*byte_count, start_time);
+  return status;
+}
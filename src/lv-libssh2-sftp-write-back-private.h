@@ -0,0 +1,93 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_SFTP_WRITE_BACK_PRIVATE_H
+#define LV_LIBSSH2_SFTP_WRITE_BACK_PRIVATE_H
+
+#include <stdint.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2.h"
+
+/**
+ * Small writes to a remote file held back to be sent together.
+ *
+ * The bytes from `start` to `end` of the buffer have been accepted from the
+ * caller but not yet written, and follow the position of the libssh2
+ * handle. A `capacity` of zero means writes go straight through.
+ */
+typedef struct _lv_libssh2_sftp_write_back {
+  uint8_t *buffer;
+  size_t capacity;
+  size_t start;
+  size_t end;
+  uint32_t max_age;
+  uint64_t since;
+} lv_libssh2_sftp_write_back_t;
+
+void lv_libssh2_sftp_write_back_init(lv_libssh2_sftp_write_back_t *write_back);
+
+void lv_libssh2_sftp_write_back_free(lv_libssh2_sftp_write_back_t *write_back);
+
+/**
+ * Resizes the buffer, which must be flushed first.
+ */
+lv_libssh2_status_t
+lv_libssh2_sftp_write_back_set(lv_libssh2_sftp_write_back_t *write_back,
+                               const size_t capacity, const uint32_t max_age);
+
+/**
+ * Gets the number of bytes accepted but not yet written.
+ */
+size_t
+lv_libssh2_sftp_write_back_pending(lv_libssh2_sftp_write_back_t *write_back);
+
+/**
+ * Writes out everything held back, returning zero or a libssh2 error. After
+ * `LIBSSH2_ERROR_EAGAIN` the rest is still held back.
+ */
+int lv_libssh2_sftp_write_back_flush(lv_libssh2_sftp_write_back_t *write_back,
+                                     LIBSSH2_SFTP_HANDLE *handle);
+
+/**
+ * Writes through the buffer, with the same results as `libssh2_sftp_write`.
+ */
+ssize_t
+lv_libssh2_sftp_write_back_write(lv_libssh2_sftp_write_back_t *write_back,
+                                 LIBSSH2_SFTP_HANDLE *handle,
+                                 const uint8_t *buffer,
+                                 const size_t buffer_length);
+
+#endif
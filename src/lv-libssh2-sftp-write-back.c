@@ -0,0 +1,140 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-sftp-write-back-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+void lv_libssh2_sftp_write_back_init(lv_libssh2_sftp_write_back_t *write_back) {
+  write_back->buffer = NULL;
+  write_back->capacity = 0;
+  write_back->start = 0;
+  write_back->end = 0;
+  write_back->max_age = 0;
+  write_back->since = 0;
+}
+
+void lv_libssh2_sftp_write_back_free(lv_libssh2_sftp_write_back_t *write_back) {
+  free(write_back->buffer);
+  lv_libssh2_sftp_write_back_init(write_back);
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_write_back_set(lv_libssh2_sftp_write_back_t *write_back,
+                               const size_t capacity, const uint32_t max_age) {
+  if (lv_libssh2_sftp_write_back_pending(write_back) > 0) {
+    return LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+  }
+  if (capacity == 0) {
+    lv_libssh2_sftp_write_back_free(write_back);
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  uint8_t *buffer = realloc(write_back->buffer, capacity);
+  if (buffer == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  write_back->buffer = buffer;
+  write_back->capacity = capacity;
+  write_back->start = 0;
+  write_back->end = 0;
+  write_back->max_age = max_age;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+size_t
+lv_libssh2_sftp_write_back_pending(lv_libssh2_sftp_write_back_t *write_back) {
+  return write_back->end - write_back->start;
+}
+
+int lv_libssh2_sftp_write_back_flush(lv_libssh2_sftp_write_back_t *write_back,
+                                     LIBSSH2_SFTP_HANDLE *handle) {
+  while (write_back->start < write_back->end) {
+    ssize_t count = libssh2_sftp_write(
+        handle, (const char *)write_back->buffer + write_back->start,
+        write_back->end - write_back->start);
+    if (count < 0) {
+      return (int)count;
+    }
+    write_back->start += (size_t)count;
+  }
+  write_back->start = 0;
+  write_back->end = 0;
+  return 0;
+}
+
+ssize_t
+lv_libssh2_sftp_write_back_write(lv_libssh2_sftp_write_back_t *write_back,
+                                 LIBSSH2_SFTP_HANDLE *handle,
+                                 const uint8_t *buffer,
+                                 const size_t buffer_length) {
+  if (write_back->capacity == 0) {
+    return libssh2_sftp_write(handle, (const char *)buffer, buffer_length);
+  }
+  /* Anything that has to go out is flushed before the new bytes are
+   * accepted, so a failed flush never leaves the caller unsure whether its
+   * own bytes were taken. */
+  size_t pending = lv_libssh2_sftp_write_back_pending(write_back);
+  if (pending > 0 &&
+      (pending + buffer_length > write_back->capacity ||
+       (write_back->max_age > 0 &&
+        lv_libssh2_time_elapsed(write_back->since) / 1000 >=
+            write_back->max_age))) {
+    int result = lv_libssh2_sftp_write_back_flush(write_back, handle);
+    if (result < 0) {
+      return result;
+    }
+    pending = 0;
+  }
+  if (buffer_length >= write_back->capacity) {
+    return libssh2_sftp_write(handle, (const char *)buffer, buffer_length);
+  }
+  if (pending == 0) {
+    write_back->start = 0;
+    write_back->end = 0;
+    write_back->since = lv_libssh2_time_now();
+  } else if (write_back->end + buffer_length > write_back->capacity) {
+    memmove(write_back->buffer, write_back->buffer + write_back->start,
+            pending);
+    write_back->start = 0;
+    write_back->end = pending;
+  }
+  memcpy(write_back->buffer + write_back->end, buffer, buffer_length);
+  write_back->end += buffer_length;
+  return (ssize_t)buffer_length;
+}
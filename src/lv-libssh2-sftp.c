@@ -33,18 +33,20 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "libssh2.h"
 #include "libssh2_sftp.h"
 
 #include "lv-libssh2-session-private.h"
 #include "lv-libssh2-sftp-attributes-private.h"
+#include "lv-libssh2-sftp-cache-private.h"
 #include "lv-libssh2-sftp-private.h"
 #include "lv-libssh2-status-private.h"
 #include "lv-libssh2.h"
 
-static lv_libssh2_status_t
-lv_libssh2_sftp_status_from_result(LIBSSH2_SFTP *sftp, int result) {
+lv_libssh2_status_t lv_libssh2_sftp_status_from_result(LIBSSH2_SFTP *sftp,
+                                                       int result) {
   if (result == LIBSSH2_ERROR_SFTP_PROTOCOL) {
     return lv_libssh2_status_from_result(libssh2_sftp_last_error(sftp));
   } else {
@@ -67,6 +69,8 @@ lv_libssh2_status_t lv_libssh2_sftp_create(lv_libssh2_session_t *session,
   }
   sftp->inner = inner;
   sftp->session = session->inner;
+  sftp->owner = session;
+  sftp->cache = NULL;
   *handle = sftp;
   return LV_LIBSSH2_STATUS_OK;
 }
@@ -79,8 +83,11 @@ lv_libssh2_status_t lv_libssh2_sftp_destroy(lv_libssh2_sftp_t *handle) {
   if (result != 0) {
     return lv_libssh2_status_from_result(result);
   }
+  lv_libssh2_sftp_cache_destroy(handle->cache);
   handle->inner = NULL;
   handle->session = NULL;
+  handle->owner = NULL;
+  handle->cache = NULL;
   free(handle);
   return LV_LIBSSH2_STATUS_OK;
 }
@@ -113,27 +120,64 @@ lv_libssh2_status_t lv_libssh2_sftp_open_file(lv_libssh2_sftp_t *sftp,
     int error_code = libssh2_session_last_errno(sftp->session);
     return lv_libssh2_sftp_status_from_result(sftp->inner, error_code);
   }
+  if ((flags & (LIBSSH2_FXF_WRITE | LIBSSH2_FXF_APPEND | LIBSSH2_FXF_CREAT |
+                LIBSSH2_FXF_TRUNC)) != 0) {
+    lv_libssh2_sftp_cache_invalidate(sftp->cache, path);
+  }
   lv_libssh2_sftp_file_t *file = malloc(sizeof(lv_libssh2_sftp_file_t));
-  if (file == NULL) {
+  char *path_copy = malloc(strlen(path) + 1);
+  if (file == NULL || path_copy == NULL) {
     libssh2_sftp_close_handle(inner);
+    free(file);
+    free(path_copy);
     return LV_LIBSSH2_STATUS_ERROR_MALLOC;
   }
+  strcpy(path_copy, path);
   file->inner = inner;
+  file->sftp = sftp->inner;
+  file->owner = sftp;
+  file->path = path_copy;
+  lv_libssh2_sftp_read_ahead_init(&file->read_ahead);
+  lv_libssh2_sftp_write_back_init(&file->write_back);
   *handle = file;
   return LV_LIBSSH2_STATUS_OK;
 }
 
+/* Writes out anything held back by the write-back buffer. */
+static lv_libssh2_status_t
+lv_libssh2_sftp_file_flush(lv_libssh2_sftp_file_t *file) {
+  if (lv_libssh2_sftp_write_back_pending(&file->write_back) == 0) {
+    return LV_LIBSSH2_STATUS_OK;
+  }
+  lv_libssh2_sftp_cache_invalidate(file->owner->cache, file->path);
+  int result = lv_libssh2_sftp_write_back_flush(&file->write_back, file->inner);
+  if (result != 0) {
+    return lv_libssh2_sftp_status_from_result(file->sftp, result);
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
 lv_libssh2_status_t lv_libssh2_sftp_close_file(lv_libssh2_sftp_file_t *handle) {
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  /* A flush that would block can be retried, but any other failure is
+   * reported after the handle is closed, as the held-back bytes cannot be
+   * written anymore. */
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (status == LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+    return status;
+  }
   int result = libssh2_sftp_close_handle(handle->inner);
   if (result != 0) {
     return lv_libssh2_sftp_status_from_result(handle->sftp, result);
   }
   handle->inner = NULL;
+  lv_libssh2_sftp_read_ahead_free(&handle->read_ahead);
+  lv_libssh2_sftp_write_back_free(&handle->write_back);
+  free(handle->path);
   free(handle);
-  return LV_LIBSSH2_STATUS_OK;
+  return status;
 }
 
 lv_libssh2_status_t
@@ -160,6 +204,7 @@ lv_libssh2_sftp_open_directory(lv_libssh2_sftp_t *sftp, const char *path,
     return LV_LIBSSH2_STATUS_ERROR_MALLOC;
   }
   directory->inner = inner;
+  directory->sftp = sftp->inner;
   *handle = directory;
   return LV_LIBSSH2_STATUS_OK;
 }
@@ -192,8 +237,12 @@ lv_libssh2_status_t lv_libssh2_sftp_read_file(lv_libssh2_sftp_file_t *handle,
   if (read_count == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
-  ssize_t count =
-      libssh2_sftp_read(handle->inner, (char *)buffer, buffer_max_length);
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  ssize_t count = lv_libssh2_sftp_read_ahead_read(
+      &handle->read_ahead, handle->inner, buffer, buffer_max_length);
   if (count < 0) {
     return lv_libssh2_sftp_status_from_result(handle->sftp, (int)count);
   }
@@ -238,8 +287,10 @@ lv_libssh2_status_t lv_libssh2_sftp_write_file(lv_libssh2_sftp_file_t *handle,
   if (buffer == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
-  ssize_t count =
-      libssh2_sftp_write(handle->inner, (char *)buffer, buffer_length);
+  lv_libssh2_sftp_cache_invalidate(handle->owner->cache, handle->path);
+  lv_libssh2_sftp_read_ahead_discard(&handle->read_ahead, handle->inner);
+  ssize_t count = lv_libssh2_sftp_write_back_write(
+      &handle->write_back, handle->inner, buffer, buffer_length);
   if (count < 0) {
     return lv_libssh2_sftp_status_from_result(handle->sftp, (int)count);
   }
@@ -251,6 +302,10 @@ lv_libssh2_status_t lv_libssh2_sftp_file_sync(lv_libssh2_sftp_file_t *handle) {
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
   int result = libssh2_sftp_fsync(handle->inner);
   return lv_libssh2_sftp_status_from_result(handle->sftp, result);
 }
@@ -260,7 +315,11 @@ lv_libssh2_status_t lv_libssh2_sftp_file_seek(lv_libssh2_sftp_file_t *handle,
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
-  libssh2_sftp_seek64(handle->inner, offset);
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_sftp_read_ahead_seek(&handle->read_ahead, handle->inner, offset);
   return LV_LIBSSH2_STATUS_OK;
 }
 
@@ -269,7 +328,11 @@ lv_libssh2_sftp_file_rewind(lv_libssh2_sftp_file_t *handle) {
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
-  libssh2_sftp_seek64(handle->inner, 0);
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_sftp_read_ahead_seek(&handle->read_ahead, handle->inner, 0);
   return LV_LIBSSH2_STATUS_OK;
 }
 
@@ -279,11 +342,40 @@ lv_libssh2_sftp_file_position(lv_libssh2_sftp_file_t *handle,
   if (handle == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
-  uint64_t pos = libssh2_sftp_tell64(handle->inner);
+  uint64_t pos =
+      lv_libssh2_sftp_read_ahead_position(&handle->read_ahead, handle->inner) +
+      lv_libssh2_sftp_write_back_pending(&handle->write_back);
   *position = pos;
   return LV_LIBSSH2_STATUS_OK;
 }
 
+lv_libssh2_status_t
+lv_libssh2_sftp_file_set_read_ahead(lv_libssh2_sftp_file_t *handle,
+                                    const uint32_t max_depth) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (max_depth == 0) {
+    lv_libssh2_sftp_read_ahead_discard(&handle->read_ahead, handle->inner);
+  }
+  lv_libssh2_sftp_read_ahead_set_max_depth(&handle->read_ahead, max_depth);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_file_set_write_back(lv_libssh2_sftp_file_t *handle,
+                                    const uint32_t size,
+                                    const uint32_t max_age) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  return lv_libssh2_sftp_write_back_set(&handle->write_back, size, max_age);
+}
+
 lv_libssh2_status_t
 lv_libssh2_sftp_file_status(lv_libssh2_sftp_file_t *handle,
                             lv_libssh2_sftp_attributes_t *attributes) {
@@ -293,6 +385,10 @@ lv_libssh2_sftp_file_status(lv_libssh2_sftp_file_t *handle,
   if (attributes == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
   int result = libssh2_sftp_fstat_ex(handle->inner, attributes->inner, 0);
   return lv_libssh2_sftp_status_from_result(handle->sftp, result);
 }
@@ -306,6 +402,12 @@ lv_libssh2_sftp_file_set_status(lv_libssh2_sftp_file_t *handle,
   if (attributes == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_sftp_cache_invalidate(handle->owner->cache, handle->path);
+  lv_libssh2_status_t status = lv_libssh2_sftp_file_flush(handle);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_sftp_read_ahead_discard(&handle->read_ahead, handle->inner);
   int result = libssh2_sftp_fstat_ex(handle->inner, attributes->inner, 1);
   return lv_libssh2_sftp_status_from_result(handle->sftp, result);
 }
@@ -322,13 +424,52 @@ lv_libssh2_sftp_link_status(lv_libssh2_sftp_t *handle, const char *path,
   if (attributes == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (lv_libssh2_sftp_cache_find_attributes(
+          handle->cache, LV_LIBSSH2_SFTP_CACHE_KIND_LINK_STATUS, path,
+          attributes->inner, &status)) {
+    return status;
+  }
   int result =
       libssh2_sftp_stat_ex(handle->inner, path, (unsigned int)strlen(path),
                            LIBSSH2_SFTP_LSTAT, attributes->inner);
   if (result != 0) {
-    return lv_libssh2_sftp_status_from_result(handle->inner, result);
+    status = lv_libssh2_sftp_status_from_result(handle->inner, result);
   }
-  return LV_LIBSSH2_STATUS_OK;
+  lv_libssh2_sftp_cache_store_attributes(
+      handle->cache, LV_LIBSSH2_SFTP_CACHE_KIND_LINK_STATUS, path,
+      attributes->inner, status);
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_sftp_stat(lv_libssh2_sftp_t *handle, const char *path,
+                     lv_libssh2_sftp_attributes_t *attributes) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (attributes == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (lv_libssh2_sftp_cache_find_attributes(
+          handle->cache, LV_LIBSSH2_SFTP_CACHE_KIND_STATUS, path,
+          attributes->inner, &status)) {
+    return status;
+  }
+  int result =
+      libssh2_sftp_stat_ex(handle->inner, path, (unsigned int)strlen(path),
+                           LIBSSH2_SFTP_STAT, attributes->inner);
+  if (result != 0) {
+    status = lv_libssh2_sftp_status_from_result(handle->inner, result);
+  }
+  lv_libssh2_sftp_cache_store_attributes(handle->cache,
+                                         LV_LIBSSH2_SFTP_CACHE_KIND_STATUS,
+                                         path, attributes->inner, status);
+  return status;
 }
 
 lv_libssh2_status_t lv_libssh2_sftp_file_rename(lv_libssh2_sftp_t *handle,
@@ -344,6 +485,8 @@ lv_libssh2_status_t lv_libssh2_sftp_file_rename(lv_libssh2_sftp_t *handle,
   if (destination_path == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_sftp_cache_invalidate_tree(handle->cache, source_path);
+  lv_libssh2_sftp_cache_invalidate_tree(handle->cache, destination_path);
   int result = libssh2_sftp_rename_ex(
       handle->inner, source_path, (unsigned int)strlen(source_path),
       destination_path, (unsigned int)strlen(destination_path), (long)options);
@@ -361,6 +504,7 @@ lv_libssh2_status_t lv_libssh2_sftp_delete_file(lv_libssh2_sftp_t *handle,
   if (file_path == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_sftp_cache_invalidate(handle->cache, file_path);
   int result = libssh2_sftp_unlink_ex(handle->inner, file_path,
                                       (unsigned int)strlen(file_path));
   if (result != 0) {
@@ -379,6 +523,7 @@ lv_libssh2_sftp_create_directory(lv_libssh2_sftp_t *handle,
   if (directory_path == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_sftp_cache_invalidate(handle->cache, directory_path);
   int result =
       libssh2_sftp_mkdir_ex(handle->inner, directory_path,
                             (unsigned int)strlen(directory_path), permissions);
@@ -397,6 +542,7 @@ lv_libssh2_sftp_delete_directory(lv_libssh2_sftp_t *handle,
   if (directory_path == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_sftp_cache_invalidate_tree(handle->cache, directory_path);
   int result = libssh2_sftp_rmdir_ex(handle->inner, directory_path,
                                      (unsigned int)strlen(directory_path));
   if (result != 0) {
@@ -417,6 +563,8 @@ lv_libssh2_status_t lv_libssh2_sftp_create_link(lv_libssh2_sftp_t *handle,
   if (link_path == NULL) {
     return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
   }
+  lv_libssh2_sftp_cache_invalidate(handle->cache, source_path);
+  lv_libssh2_sftp_cache_invalidate(handle->cache, link_path);
   int result = libssh2_sftp_symlink_ex(
       handle->inner, source_path, (unsigned int)strlen(source_path),
       (char *)link_path, (unsigned int)strlen(link_path), LIBSSH2_SFTP_SYMLINK);
@@ -479,3 +627,63 @@ lv_libssh2_status_t lv_libssh2_sftp_resolve_real_link(
   *read_count = (size_t)result;
   return LV_LIBSSH2_STATUS_OK;
 }
+
+lv_libssh2_status_t lv_libssh2_sftp_enable_cache(lv_libssh2_sftp_t *handle,
+                                                 const uint32_t ttl) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_sftp_cache_t *cache = NULL;
+  lv_libssh2_status_t status = lv_libssh2_sftp_cache_create(ttl, &cache);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  lv_libssh2_sftp_cache_destroy(handle->cache);
+  handle->cache = cache;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_disable_cache(lv_libssh2_sftp_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_sftp_cache_destroy(handle->cache);
+  handle->cache = NULL;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_clear_cache(lv_libssh2_sftp_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_sftp_cache_clear(handle->cache);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_sftp_cache_statistics(lv_libssh2_sftp_t *handle,
+                                                     uint64_t *hits,
+                                                     uint64_t *misses,
+                                                     size_t *entries) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (hits == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (misses == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (entries == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (handle->cache == NULL) {
+    *hits = 0;
+    *misses = 0;
+    *entries = 0;
+  } else {
+    *hits = handle->cache->hits;
+    *misses = handle->cache->misses;
+    *entries = handle->cache->count;
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
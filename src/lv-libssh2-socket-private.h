@@ -0,0 +1,132 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_SOCKET_PRIVATE_H
+#define LV_LIBSSH2_SOCKET_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <poll.h>
+#endif
+
+#ifdef _WIN32
+typedef SOCKET lv_libssh2_socket_t;
+#define LV_LIBSSH2_SOCKET_INVALID INVALID_SOCKET
+#else
+typedef int lv_libssh2_socket_t;
+#define LV_LIBSSH2_SOCKET_INVALID -1
+#endif
+
+#define LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES 16
+
+/**
+ * A connection attempt that races the addresses of a host, alternating
+ * between address families and starting a new attempt whenever the previous
+ * one has not completed within a short delay.
+ */
+typedef struct _lv_libssh2_connector {
+  struct addrinfo *addresses;
+  struct addrinfo *order[LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES];
+  lv_libssh2_socket_t attempts[LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES];
+  size_t address_count;
+  size_t next_address;
+  uint64_t last_attempt;
+  uint32_t options;
+  int32_t send_buffer_size;
+  int32_t receive_buffer_size;
+} lv_libssh2_connector_t;
+
+/**
+ * Resolves the host and prepares the connector.
+ *
+ * The connector must be closed with lv_libssh2_connector_close() if this
+ * succeeds.
+ */
+lv_libssh2_status_t
+lv_libssh2_connector_start(lv_libssh2_connector_t *connector, const char *host,
+                           const int32_t port, const uint32_t options,
+                           const int32_t send_buffer_size,
+                           const int32_t receive_buffer_size);
+
+/**
+ * Advances the connection attempts, waiting at most the number of
+ * milliseconds.
+ *
+ * Returns ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN while attempts are still in
+ * progress. On success, the connected socket is owned by the caller.
+ */
+lv_libssh2_status_t lv_libssh2_connector_step(lv_libssh2_connector_t *connector,
+                                              const uint32_t milliseconds,
+                                              lv_libssh2_socket_t *socket);
+
+void lv_libssh2_connector_close(lv_libssh2_connector_t *connector);
+
+/**
+ * Connects to the host, waiting at most the number of milliseconds. A negative
+ * timeout waits indefinitely.
+ */
+lv_libssh2_status_t lv_libssh2_socket_connect(
+    const char *host, const int32_t port, const int32_t timeout,
+    const uint32_t options, const int32_t send_buffer_size,
+    const int32_t receive_buffer_size, lv_libssh2_socket_t *socket);
+
+void lv_libssh2_socket_close(lv_libssh2_socket_t socket);
+
+/**
+ * Polls the sockets, waiting at most the number of milliseconds. A negative
+ * timeout waits indefinitely.
+ *
+ * Returns the number of sockets that are ready, zero on timeout, or a
+ * negative number on error.
+ */
+int lv_libssh2_socket_poll(struct pollfd *descriptors, const size_t count,
+                           const int32_t milliseconds);
+
+/**
+ * Waits at most the number of milliseconds for the socket to become readable
+ * or writable, as requested.
+ *
+ * Returns `false` if the wait timed out.
+ */
+bool lv_libssh2_socket_wait(lv_libssh2_socket_t socket, const bool read,
+                            const bool write, const uint32_t milliseconds);
+
+#endif
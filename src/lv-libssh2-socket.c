@@ -0,0 +1,328 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "lv-libssh2-socket-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2.h"
+
+#define ATTEMPT_DELAY 250
+
+#ifdef _WIN32
+#define poll WSAPoll
+#define CONNECT_IN_PROGRESS(error) ((error) == WSAEWOULDBLOCK)
+#define LAST_SOCKET_ERROR WSAGetLastError()
+typedef int socklen_t;
+#else
+#define CONNECT_IN_PROGRESS(error) ((error) == EINPROGRESS)
+#define LAST_SOCKET_ERROR errno
+#endif
+
+static void lv_libssh2_socket_set_blocking(lv_libssh2_socket_t socket,
+                                           const bool blocking) {
+#ifdef _WIN32
+  u_long mode = blocking ? 0 : 1;
+  ioctlsocket(socket, FIONBIO, &mode);
+#else
+  int flags = fcntl(socket, F_GETFL, 0);
+  fcntl(socket, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK);
+#endif
+}
+
+static void lv_libssh2_socket_tune(lv_libssh2_socket_t socket,
+                                   const uint32_t options,
+                                   const int32_t send_buffer_size,
+                                   const int32_t receive_buffer_size) {
+  int enabled = 1;
+  if (options & LV_LIBSSH2_SOCKET_OPTION_NODELAY) {
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char *)&enabled,
+               sizeof(enabled));
+  }
+  if (options & LV_LIBSSH2_SOCKET_OPTION_KEEPALIVE) {
+    setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, (const char *)&enabled,
+               sizeof(enabled));
+  }
+  /* Buffer sizes must be set before connecting for the TCP window scale to
+   * account for them. */
+  if (send_buffer_size > 0) {
+    setsockopt(socket, SOL_SOCKET, SO_SNDBUF, (const char *)&send_buffer_size,
+               sizeof(send_buffer_size));
+  }
+  if (receive_buffer_size > 0) {
+    setsockopt(socket, SOL_SOCKET, SO_RCVBUF,
+               (const char *)&receive_buffer_size,
+               sizeof(receive_buffer_size));
+  }
+}
+
+static bool lv_libssh2_connector_in_flight(lv_libssh2_connector_t *connector) {
+  for (size_t i = 0; i < connector->next_address; i++) {
+    if (connector->attempts[i] != LV_LIBSSH2_SOCKET_INVALID) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void lv_libssh2_connector_finish(lv_libssh2_connector_t *connector,
+                                        const size_t index,
+                                        lv_libssh2_socket_t *socket) {
+  *socket = connector->attempts[index];
+  connector->attempts[index] = LV_LIBSSH2_SOCKET_INVALID;
+  lv_libssh2_socket_set_blocking(*socket, true);
+}
+
+/* Returns `true` if the attempt connected immediately. */
+static bool lv_libssh2_connector_attempt(lv_libssh2_connector_t *connector) {
+  size_t index = connector->next_address;
+  struct addrinfo *address = connector->order[index];
+  connector->next_address += 1;
+  connector->last_attempt = lv_libssh2_time_now();
+  lv_libssh2_socket_t attempt =
+      socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+  if (attempt == LV_LIBSSH2_SOCKET_INVALID) {
+    return false;
+  }
+  lv_libssh2_socket_tune(attempt, connector->options,
+                         connector->send_buffer_size,
+                         connector->receive_buffer_size);
+  lv_libssh2_socket_set_blocking(attempt, false);
+  connector->attempts[index] = attempt;
+  if (connect(attempt, address->ai_addr, (socklen_t)address->ai_addrlen) == 0) {
+    return true;
+  }
+  if (!CONNECT_IN_PROGRESS(LAST_SOCKET_ERROR)) {
+    lv_libssh2_socket_close(attempt);
+    connector->attempts[index] = LV_LIBSSH2_SOCKET_INVALID;
+  }
+  return false;
+}
+
+lv_libssh2_status_t
+lv_libssh2_connector_start(lv_libssh2_connector_t *connector, const char *host,
+                           const int32_t port, const uint32_t options,
+                           const int32_t send_buffer_size,
+                           const int32_t receive_buffer_size) {
+  memset(connector, 0, sizeof(lv_libssh2_connector_t));
+  for (size_t i = 0; i < LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES; i++) {
+    connector->attempts[i] = LV_LIBSSH2_SOCKET_INVALID;
+  }
+  connector->options = options;
+  connector->send_buffer_size = send_buffer_size;
+  connector->receive_buffer_size = receive_buffer_size;
+  char service[16];
+  snprintf(service, sizeof(service), "%d", (int)port);
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_ADDRCONFIG;
+  if (getaddrinfo(host, service, &hints, &connector->addresses) != 0) {
+    connector->addresses = NULL;
+    return LV_LIBSSH2_STATUS_ERROR_HOST_RESOLVE;
+  }
+  /* Alternate the address families, starting with the family the resolver
+   * preferred, so an unreachable family only costs one attempt delay. */
+  struct addrinfo *first = connector->addresses;
+  struct addrinfo *preferred = first;
+  struct addrinfo *other = first;
+  while (connector->address_count < LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES &&
+         (preferred != NULL || other != NULL)) {
+    while (preferred != NULL && preferred->ai_family != first->ai_family) {
+      preferred = preferred->ai_next;
+    }
+    if (preferred != NULL) {
+      connector->order[connector->address_count++] = preferred;
+      preferred = preferred->ai_next;
+    }
+    while (other != NULL && other->ai_family == first->ai_family) {
+      other = other->ai_next;
+    }
+    if (other != NULL &&
+        connector->address_count < LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES) {
+      connector->order[connector->address_count++] = other;
+      other = other->ai_next;
+    }
+  }
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t lv_libssh2_connector_step(lv_libssh2_connector_t *connector,
+                                              const uint32_t milliseconds,
+                                              lv_libssh2_socket_t *socket) {
+  *socket = LV_LIBSSH2_SOCKET_INVALID;
+  while (connector->next_address < connector->address_count &&
+         (!lv_libssh2_connector_in_flight(connector) ||
+          lv_libssh2_time_elapsed(connector->last_attempt) / 1000 >=
+              ATTEMPT_DELAY)) {
+    size_t index = connector->next_address;
+    if (lv_libssh2_connector_attempt(connector)) {
+      lv_libssh2_connector_finish(connector, index, socket);
+      return LV_LIBSSH2_STATUS_OK;
+    }
+  }
+  if (!lv_libssh2_connector_in_flight(connector)) {
+    return LV_LIBSSH2_STATUS_ERROR_CONNECT;
+  }
+  uint32_t wait = milliseconds;
+  if (connector->next_address < connector->address_count) {
+    uint64_t elapsed = lv_libssh2_time_elapsed(connector->last_attempt) / 1000;
+    uint32_t remaining =
+        elapsed >= ATTEMPT_DELAY ? 0 : ATTEMPT_DELAY - (uint32_t)elapsed;
+    if (remaining < wait) {
+      wait = remaining;
+    }
+  }
+  struct pollfd descriptors[LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES];
+  size_t indices[LV_LIBSSH2_CONNECTOR_MAX_ADDRESSES];
+  size_t count = 0;
+  for (size_t i = 0; i < connector->next_address; i++) {
+    if (connector->attempts[i] != LV_LIBSSH2_SOCKET_INVALID) {
+      descriptors[count].fd = connector->attempts[i];
+      descriptors[count].events = POLLOUT;
+      descriptors[count].revents = 0;
+      indices[count] = i;
+      count += 1;
+    }
+  }
+  if (poll(descriptors, count, (int)wait) <= 0) {
+    return LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (descriptors[i].revents == 0) {
+      continue;
+    }
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(descriptors[i].fd, SOL_SOCKET, SO_ERROR, (char *)&error,
+                   &len) == 0 &&
+        error == 0 && (descriptors[i].revents & POLLOUT)) {
+      lv_libssh2_connector_finish(connector, indices[i], socket);
+      return LV_LIBSSH2_STATUS_OK;
+    }
+    lv_libssh2_socket_close(connector->attempts[indices[i]]);
+    connector->attempts[indices[i]] = LV_LIBSSH2_SOCKET_INVALID;
+  }
+  if (!lv_libssh2_connector_in_flight(connector) &&
+      connector->next_address >= connector->address_count) {
+    return LV_LIBSSH2_STATUS_ERROR_CONNECT;
+  }
+  return LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN;
+}
+
+void lv_libssh2_connector_close(lv_libssh2_connector_t *connector) {
+  for (size_t i = 0; i < connector->next_address; i++) {
+    if (connector->attempts[i] != LV_LIBSSH2_SOCKET_INVALID) {
+      lv_libssh2_socket_close(connector->attempts[i]);
+      connector->attempts[i] = LV_LIBSSH2_SOCKET_INVALID;
+    }
+  }
+  if (connector->addresses != NULL) {
+    freeaddrinfo(connector->addresses);
+    connector->addresses = NULL;
+  }
+}
+
+lv_libssh2_status_t lv_libssh2_socket_connect(
+    const char *host, const int32_t port, const int32_t timeout,
+    const uint32_t options, const int32_t send_buffer_size,
+    const int32_t receive_buffer_size, lv_libssh2_socket_t *socket) {
+  *socket = LV_LIBSSH2_SOCKET_INVALID;
+  lv_libssh2_connector_t connector;
+  lv_libssh2_status_t status =
+      lv_libssh2_connector_start(&connector, host, port, options,
+                                 send_buffer_size, receive_buffer_size);
+  if (lv_libssh2_status_is_err(status)) {
+    return status;
+  }
+  const uint64_t start = lv_libssh2_time_now();
+  for (;;) {
+    uint32_t wait = ATTEMPT_DELAY;
+    if (timeout >= 0) {
+      uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+      if (elapsed >= (uint64_t)timeout) {
+        status = LV_LIBSSH2_STATUS_ERROR_SOCKET_TIMEOUT;
+        break;
+      }
+      if ((uint64_t)timeout - elapsed < wait) {
+        wait = (uint32_t)((uint64_t)timeout - elapsed);
+      }
+    }
+    status = lv_libssh2_connector_step(&connector, wait, socket);
+    if (status != LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN) {
+      break;
+    }
+  }
+  lv_libssh2_connector_close(&connector);
+  return status;
+}
+
+void lv_libssh2_socket_close(lv_libssh2_socket_t socket) {
+#ifdef _WIN32
+  closesocket(socket);
+#else
+  close(socket);
+#endif
+}
+
+int lv_libssh2_socket_poll(struct pollfd *descriptors, const size_t count,
+                           const int32_t milliseconds) {
+  return poll(descriptors, count, (int)milliseconds);
+}
+
+bool lv_libssh2_socket_wait(lv_libssh2_socket_t socket, const bool read,
+                            const bool write, const uint32_t milliseconds) {
+  struct pollfd descriptor;
+  descriptor.fd = socket;
+  descriptor.events = (read ? POLLIN : 0) | (write ? POLLOUT : 0);
+  descriptor.revents = 0;
+  return poll(&descriptor, 1, (int)milliseconds) > 0;
+}
@@ -213,6 +213,20 @@ const char *lv_libssh2_status_string(lv_libssh2_status_t status) {
     return "SFTP Invalid File Name Error";
   case LV_LIBSSH2_STATUS_ERROR_SFTP_LINK_LOOP:
     return "SFTP Link Loop Error";
+  case LV_LIBSSH2_STATUS_ERROR_CANCELLED:
+    return "Cancelled Error";
+  case LV_LIBSSH2_STATUS_ERROR_POOL_MISS:
+    return "Pool Miss Error";
+  case LV_LIBSSH2_STATUS_ERROR_HOST_RESOLVE:
+    return "Host Resolve Error";
+  case LV_LIBSSH2_STATUS_ERROR_CONNECT:
+    return "Connect Error";
+  case LV_LIBSSH2_STATUS_ERROR_REMOTE_COMMAND:
+    return "Remote Command Error";
+  case LV_LIBSSH2_STATUS_ERROR_HOST_KEY_UNKNOWN:
+    return "Host Key Unknown Error";
+  case LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH:
+    return "Host Key Mismatch Error";
   default:
     return UNKNOWN_STATUS;
   }
@@ -390,6 +404,21 @@ const char *lv_libssh2_status_message(lv_libssh2_status_t status) {
     return "";
   case LV_LIBSSH2_STATUS_ERROR_SFTP_LINK_LOOP:
     return "";
+  case LV_LIBSSH2_STATUS_ERROR_CANCELLED:
+    return "The operation was cancelled before it completed.";
+  case LV_LIBSSH2_STATUS_ERROR_POOL_MISS:
+    return "No idle session in the pool matches the host, port, user, and "
+           "credential fingerprint.";
+  case LV_LIBSSH2_STATUS_ERROR_HOST_RESOLVE:
+    return "The host name could not be resolved to an address.";
+  case LV_LIBSSH2_STATUS_ERROR_CONNECT:
+    return "A connection could not be established to any address of the host.";
+  case LV_LIBSSH2_STATUS_ERROR_REMOTE_COMMAND:
+    return "A remote command exited with an error.";
+  case LV_LIBSSH2_STATUS_ERROR_HOST_KEY_UNKNOWN:
+    return "The host is not in the known hosts.";
+  case LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH:
+    return "The host key does not match the key in the known hosts.";
   default:
     return UNKNOWN_STATUS;
   }
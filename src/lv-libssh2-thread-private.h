@@ -0,0 +1,130 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_THREAD_PRIVATE_H
+#define LV_LIBSSH2_THREAD_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef _WIN32
+typedef HANDLE lv_libssh2_thread_t;
+typedef CRITICAL_SECTION lv_libssh2_mutex_t;
+typedef CONDITION_VARIABLE lv_libssh2_condition_t;
+#else
+typedef pthread_t lv_libssh2_thread_t;
+typedef pthread_mutex_t lv_libssh2_mutex_t;
+typedef pthread_cond_t lv_libssh2_condition_t;
+#endif
+
+typedef volatile int64_t lv_libssh2_atomic_t;
+
+typedef void (*lv_libssh2_thread_function_t)(void *context);
+
+lv_libssh2_status_t
+lv_libssh2_thread_start(lv_libssh2_thread_t *thread,
+                        lv_libssh2_thread_function_t function, void *context);
+
+void lv_libssh2_thread_join(lv_libssh2_thread_t thread);
+
+void lv_libssh2_thread_sleep(const uint32_t milliseconds);
+
+void lv_libssh2_mutex_init(lv_libssh2_mutex_t *mutex);
+
+void lv_libssh2_mutex_destroy(lv_libssh2_mutex_t *mutex);
+
+void lv_libssh2_mutex_lock(lv_libssh2_mutex_t *mutex);
+
+void lv_libssh2_mutex_unlock(lv_libssh2_mutex_t *mutex);
+
+void lv_libssh2_condition_init(lv_libssh2_condition_t *condition);
+
+void lv_libssh2_condition_destroy(lv_libssh2_condition_t *condition);
+
+void lv_libssh2_condition_signal(lv_libssh2_condition_t *condition);
+
+void lv_libssh2_condition_broadcast(lv_libssh2_condition_t *condition);
+
+void lv_libssh2_condition_wait(lv_libssh2_condition_t *condition,
+                               lv_libssh2_mutex_t *mutex);
+
+/**
+ * Waits on the condition for at most the number of milliseconds.
+ *
+ * Returns `false` if the wait timed out.
+ */
+bool lv_libssh2_condition_timed_wait(lv_libssh2_condition_t *condition,
+                                     lv_libssh2_mutex_t *mutex,
+                                     const uint32_t milliseconds);
+
+/* The atomic operations are all sequentially consistent. */
+
+int64_t lv_libssh2_atomic_load(lv_libssh2_atomic_t *value);
+
+/**
+ * Adds to the value, returning the result.
+ */
+int64_t lv_libssh2_atomic_add(lv_libssh2_atomic_t *value, const int64_t delta);
+
+/**
+ * Sets the value to `desired` if it is `expected`, returning `false` if it
+ * was not.
+ */
+bool lv_libssh2_atomic_compare_exchange(lv_libssh2_atomic_t *value,
+                                        const int64_t expected,
+                                        const int64_t desired);
+
+void *lv_libssh2_atomic_load_pointer(void *volatile *pointer);
+
+/**
+ * Sets the pointer to `desired` if it is `expected`, returning `false` if it
+ * was not.
+ */
+bool lv_libssh2_atomic_compare_exchange_pointer(void *volatile *pointer,
+                                                void *expected, void *desired);
+
+/**
+ * Sets the pointer, returning the previous one.
+ */
+void *lv_libssh2_atomic_exchange_pointer(void *volatile *pointer,
+                                         void *value);
+
+#endif
@@ -0,0 +1,258 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <time.h>
+#endif
+
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+typedef struct _lv_libssh2_thread_start {
+  lv_libssh2_thread_function_t function;
+  void *context;
+} lv_libssh2_thread_start_t;
+
+#ifdef _WIN32
+static DWORD WINAPI lv_libssh2_thread_main(LPVOID argument) {
+#else
+static void *lv_libssh2_thread_main(void *argument) {
+#endif
+  lv_libssh2_thread_start_t start = *(lv_libssh2_thread_start_t *)argument;
+  free(argument);
+  start.function(start.context);
+#ifdef _WIN32
+  return 0;
+#else
+  return NULL;
+#endif
+}
+
+lv_libssh2_status_t
+lv_libssh2_thread_start(lv_libssh2_thread_t *thread,
+                        lv_libssh2_thread_function_t function, void *context) {
+  lv_libssh2_thread_start_t *start = malloc(sizeof(lv_libssh2_thread_start_t));
+  if (start == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  start->function = function;
+  start->context = context;
+#ifdef _WIN32
+  *thread = CreateThread(NULL, 0, lv_libssh2_thread_main, start, 0, NULL);
+  if (*thread == NULL) {
+    free(start);
+    return LV_LIBSSH2_STATUS_ERROR_GENERIC;
+  }
+#else
+  if (pthread_create(thread, NULL, lv_libssh2_thread_main, start) != 0) {
+    free(start);
+    return LV_LIBSSH2_STATUS_ERROR_GENERIC;
+  }
+#endif
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+void lv_libssh2_thread_join(lv_libssh2_thread_t thread) {
+#ifdef _WIN32
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+#else
+  pthread_join(thread, NULL);
+#endif
+}
+
+void lv_libssh2_thread_sleep(const uint32_t milliseconds) {
+#ifdef _WIN32
+  Sleep(milliseconds);
+#else
+  struct timespec duration;
+  duration.tv_sec = milliseconds / 1000;
+  duration.tv_nsec = (long)(milliseconds % 1000) * 1000000;
+  while (nanosleep(&duration, &duration) != 0 && errno == EINTR) {
+  }
+#endif
+}
+
+void lv_libssh2_mutex_init(lv_libssh2_mutex_t *mutex) {
+#ifdef _WIN32
+  InitializeCriticalSection(mutex);
+#else
+  pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void lv_libssh2_mutex_destroy(lv_libssh2_mutex_t *mutex) {
+#ifdef _WIN32
+  DeleteCriticalSection(mutex);
+#else
+  pthread_mutex_destroy(mutex);
+#endif
+}
+
+void lv_libssh2_mutex_lock(lv_libssh2_mutex_t *mutex) {
+#ifdef _WIN32
+  EnterCriticalSection(mutex);
+#else
+  pthread_mutex_lock(mutex);
+#endif
+}
+
+void lv_libssh2_mutex_unlock(lv_libssh2_mutex_t *mutex) {
+#ifdef _WIN32
+  LeaveCriticalSection(mutex);
+#else
+  pthread_mutex_unlock(mutex);
+#endif
+}
+
+void lv_libssh2_condition_init(lv_libssh2_condition_t *condition) {
+#ifdef _WIN32
+  InitializeConditionVariable(condition);
+#else
+  pthread_cond_init(condition, NULL);
+#endif
+}
+
+void lv_libssh2_condition_destroy(lv_libssh2_condition_t *condition) {
+#ifdef _WIN32
+  (void)condition;
+#else
+  pthread_cond_destroy(condition);
+#endif
+}
+
+void lv_libssh2_condition_signal(lv_libssh2_condition_t *condition) {
+#ifdef _WIN32
+  WakeConditionVariable(condition);
+#else
+  pthread_cond_signal(condition);
+#endif
+}
+
+void lv_libssh2_condition_broadcast(lv_libssh2_condition_t *condition) {
+#ifdef _WIN32
+  WakeAllConditionVariable(condition);
+#else
+  pthread_cond_broadcast(condition);
+#endif
+}
+
+void lv_libssh2_condition_wait(lv_libssh2_condition_t *condition,
+                               lv_libssh2_mutex_t *mutex) {
+#ifdef _WIN32
+  SleepConditionVariableCS(condition, mutex, INFINITE);
+#else
+  pthread_cond_wait(condition, mutex);
+#endif
+}
+
+bool lv_libssh2_condition_timed_wait(lv_libssh2_condition_t *condition,
+                                     lv_libssh2_mutex_t *mutex,
+                                     const uint32_t milliseconds) {
+#ifdef _WIN32
+  return SleepConditionVariableCS(condition, mutex, milliseconds) != 0;
+#else
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += milliseconds / 1000;
+  deadline.tv_nsec += (long)(milliseconds % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+  return pthread_cond_timedwait(condition, mutex, &deadline) != ETIMEDOUT;
+#endif
+}
+
+int64_t lv_libssh2_atomic_load(lv_libssh2_atomic_t *value) {
+#ifdef _WIN32
+  return InterlockedCompareExchange64(value, 0, 0);
+#else
+  return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+int64_t lv_libssh2_atomic_add(lv_libssh2_atomic_t *value,
+                              const int64_t delta) {
+#ifdef _WIN32
+  return InterlockedExchangeAdd64(value, delta) + delta;
+#else
+  return __atomic_add_fetch(value, delta, __ATOMIC_SEQ_CST);
+#endif
+}
+
+bool lv_libssh2_atomic_compare_exchange(lv_libssh2_atomic_t *value,
+                                        const int64_t expected,
+                                        const int64_t desired) {
+#ifdef _WIN32
+  return InterlockedCompareExchange64(value, desired, expected) == expected;
+#else
+  int64_t previous = expected;
+  return __atomic_compare_exchange_n(value, &previous, desired, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+void *lv_libssh2_atomic_load_pointer(void *volatile *pointer) {
+#ifdef _WIN32
+  return InterlockedCompareExchangePointer(pointer, NULL, NULL);
+#else
+  return __atomic_load_n(pointer, __ATOMIC_SEQ_CST);
+#endif
+}
+
+bool lv_libssh2_atomic_compare_exchange_pointer(void *volatile *pointer,
+                                                void *expected,
+                                                void *desired) {
+#ifdef _WIN32
+  return InterlockedCompareExchangePointer(pointer, desired, expected) ==
+         expected;
+#else
+  return __atomic_compare_exchange_n(pointer, &expected, desired, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+void *lv_libssh2_atomic_exchange_pointer(void *volatile *pointer,
+                                         void *value) {
+#ifdef _WIN32
+  return InterlockedExchangePointer(pointer, value);
+#else
+  return __atomic_exchange_n(pointer, value, __ATOMIC_SEQ_CST);
+#endif
+}
@@ -0,0 +1,99 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#ifndef LV_LIBSSH2_TRANSFER_QUEUE_PRIVATE_H
+#define LV_LIBSSH2_TRANSFER_QUEUE_PRIVATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2.h"
+
+/* Tallies a set of jobs, such as those added by a mirror, as they finish. The
+ * fields are guarded by the queue mutex. */
+typedef struct _lv_libssh2_transfer_group {
+  size_t remaining;
+  size_t completed;
+  size_t failed;
+  uint64_t byte_count;
+} lv_libssh2_transfer_group_t;
+
+typedef struct _lv_libssh2_transfer_job {
+  lv_libssh2_transfer_group_t *group;
+  char *remote_path;
+  char *local_path;
+  lv_libssh2_transfer_directions_t direction;
+  lv_libssh2_transfer_states_t state;
+  lv_libssh2_status_t status;
+  uint64_t byte_count;
+  bool cancel;
+} lv_libssh2_transfer_job_t;
+
+typedef struct _lv_libssh2_transfer_worker {
+  lv_libssh2_transfer_queue_t *queue;
+  lv_libssh2_session_t *session;
+  lv_libssh2_thread_t thread;
+  bool started;
+} lv_libssh2_transfer_worker_t;
+
+struct _lv_libssh2_transfer_queue {
+  lv_libssh2_mutex_t mutex;
+  lv_libssh2_condition_t changed;
+  lv_libssh2_transfer_job_t *jobs;
+  size_t job_count;
+  size_t job_capacity;
+  size_t next_job;
+  size_t pending_count;
+  size_t running_count;
+  size_t completed_count;
+  size_t failed_count;
+  size_t cancelled_count;
+  lv_libssh2_transfer_worker_t **workers;
+  size_t worker_count;
+  size_t active_workers;
+  size_t chunk_size;
+  size_t window_depth;
+  uint64_t start_time;
+  bool started;
+  bool stopping;
+};
+
+/* Adds a job like `lv_libssh2_transfer_queue_add` and counts it in the group,
+ * which may be NULL. */
+lv_libssh2_status_t lv_libssh2_transfer_queue_add_to_group(
+    lv_libssh2_transfer_queue_t *queue, const char *remote_path,
+    const char *local_path, const lv_libssh2_transfer_directions_t direction,
+    lv_libssh2_transfer_group_t *group, size_t *job);
+
+#endif
@@ -0,0 +1,545 @@
+/*
+ * LV-LIBSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-session-private.h"
+#include "lv-libssh2-sftp-transfer-private.h"
+#include "lv-libssh2-thread-private.h"
+#include "lv-libssh2-time-private.h"
+#include "lv-libssh2-transfer-queue-private.h"
+#include "lv-libssh2.h"
+
+#define DEFAULT_PERMISSIONS 0644
+#define INITIAL_JOB_CAPACITY 16
+
+typedef struct _lv_libssh2_transfer_progress {
+  lv_libssh2_transfer_queue_t *queue;
+  size_t job;
+} lv_libssh2_transfer_progress_t;
+
+static char *lv_libssh2_transfer_queue_copy(const char *text) {
+  size_t len = strlen(text) + 1;
+  char *copy = malloc(len);
+  if (copy != NULL) {
+    memcpy(copy, text, len);
+  }
+  return copy;
+}
+
+static bool lv_libssh2_transfer_queue_next(lv_libssh2_transfer_queue_t *queue,
+                                           size_t *job) {
+  while (queue->next_job < queue->job_count) {
+    size_t index = queue->next_job;
+    queue->next_job += 1;
+    if (queue->jobs[index].state == LV_LIBSSH2_TRANSFER_STATE_PENDING) {
+      *job = index;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void lv_libssh2_transfer_queue_count(lv_libssh2_transfer_job_t *entry,
+                                            const uint64_t byte_count) {
+  if (entry->group != NULL) {
+    entry->group->byte_count =
+        entry->group->byte_count - entry->byte_count + byte_count;
+  }
+  entry->byte_count = byte_count;
+}
+
+static void lv_libssh2_transfer_queue_settle(lv_libssh2_transfer_job_t *entry) {
+  if (entry->group == NULL) {
+    return;
+  }
+  entry->group->remaining -= 1;
+  if (entry->state == LV_LIBSSH2_TRANSFER_STATE_COMPLETED) {
+    entry->group->completed += 1;
+  } else {
+    entry->group->failed += 1;
+  }
+}
+
+static void
+lv_libssh2_transfer_queue_finish(lv_libssh2_transfer_queue_t *queue,
+                                 const size_t job,
+                                 const lv_libssh2_status_t status) {
+  lv_libssh2_transfer_job_t *entry = &queue->jobs[job];
+  queue->running_count -= 1;
+  entry->status = status;
+  if (lv_libssh2_status_is_ok(status)) {
+    entry->state = LV_LIBSSH2_TRANSFER_STATE_COMPLETED;
+    queue->completed_count += 1;
+    lv_libssh2_transfer_queue_settle(entry);
+  } else if (status == LV_LIBSSH2_STATUS_ERROR_CANCELLED && !entry->cancel) {
+    /* Interrupted by a stop rather than cancelled, so it runs again on the
+     * next start. */
+    entry->state = LV_LIBSSH2_TRANSFER_STATE_PENDING;
+    entry->status = LV_LIBSSH2_STATUS_OK;
+    lv_libssh2_transfer_queue_count(entry, 0);
+    queue->pending_count += 1;
+    if (job < queue->next_job) {
+      queue->next_job = job;
+    }
+  } else if (status == LV_LIBSSH2_STATUS_ERROR_CANCELLED) {
+    entry->state = LV_LIBSSH2_TRANSFER_STATE_CANCELLED;
+    queue->cancelled_count += 1;
+    lv_libssh2_transfer_queue_settle(entry);
+  } else {
+    entry->state = LV_LIBSSH2_TRANSFER_STATE_FAILED;
+    queue->failed_count += 1;
+    lv_libssh2_transfer_queue_settle(entry);
+  }
+}
+
+static bool lv_libssh2_transfer_queue_progress(void *context,
+                                               const uint64_t byte_count) {
+  lv_libssh2_transfer_progress_t *progress = context;
+  lv_libssh2_transfer_queue_t *queue = progress->queue;
+  lv_libssh2_mutex_lock(&queue->mutex);
+  lv_libssh2_transfer_job_t *entry = &queue->jobs[progress->job];
+  lv_libssh2_transfer_queue_count(entry, byte_count);
+  bool proceed = !entry->cancel && !queue->stopping;
+  lv_libssh2_mutex_unlock(&queue->mutex);
+  return proceed;
+}
+
+static void lv_libssh2_transfer_queue_work(void *context) {
+  lv_libssh2_transfer_worker_t *worker = context;
+  lv_libssh2_transfer_queue_t *queue = worker->queue;
+  lv_libssh2_sftp_t *sftp = NULL;
+  libssh2_session_set_blocking(worker->session->inner, 1);
+  lv_libssh2_status_t status = lv_libssh2_sftp_create(worker->session, &sftp);
+  lv_libssh2_mutex_lock(&queue->mutex);
+  while (lv_libssh2_status_is_ok(status) && !queue->stopping) {
+    size_t job = 0;
+    if (!lv_libssh2_transfer_queue_next(queue, &job)) {
+      lv_libssh2_condition_wait(&queue->changed, &queue->mutex);
+      continue;
+    }
+    lv_libssh2_transfer_job_t *entry = &queue->jobs[job];
+    entry->state = LV_LIBSSH2_TRANSFER_STATE_RUNNING;
+    queue->pending_count -= 1;
+    queue->running_count += 1;
+    const char *remote_path = entry->remote_path;
+    const char *local_path = entry->local_path;
+    const lv_libssh2_transfer_directions_t direction = entry->direction;
+    lv_libssh2_mutex_unlock(&queue->mutex);
+    lv_libssh2_transfer_progress_t progress = {queue, job};
+    uint64_t byte_count = 0;
+    lv_libssh2_status_t result;
+    if (direction == LV_LIBSSH2_TRANSFER_DIRECTION_UPLOAD) {
+      result = lv_libssh2_sftp_transfer_upload(
+          sftp, local_path, remote_path, 0, DEFAULT_PERMISSIONS,
+          queue->chunk_size, queue->window_depth,
+          lv_libssh2_transfer_queue_progress, &progress, &byte_count);
+    } else {
+      result = lv_libssh2_sftp_transfer_download(
+          sftp, remote_path, local_path, 0, queue->chunk_size,
+          queue->window_depth, lv_libssh2_transfer_queue_progress, &progress,
+          &byte_count);
+    }
+    lv_libssh2_mutex_lock(&queue->mutex);
+    lv_libssh2_transfer_queue_count(&queue->jobs[job], byte_count);
+    lv_libssh2_transfer_queue_finish(queue, job, result);
+    lv_libssh2_condition_broadcast(&queue->changed);
+  }
+  queue->active_workers -= 1;
+  if (lv_libssh2_status_is_err(status) && queue->active_workers == 0) {
+    /* Without any worker left, the remaining jobs would never run. */
+    size_t job = 0;
+    while (lv_libssh2_transfer_queue_next(queue, &job)) {
+      queue->jobs[job].state = LV_LIBSSH2_TRANSFER_STATE_FAILED;
+      queue->jobs[job].status = status;
+      queue->pending_count -= 1;
+      queue->failed_count += 1;
+      lv_libssh2_transfer_queue_settle(&queue->jobs[job]);
+    }
+  }
+  lv_libssh2_condition_broadcast(&queue->changed);
+  lv_libssh2_mutex_unlock(&queue->mutex);
+  if (sftp != NULL) {
+    lv_libssh2_sftp_destroy(sftp);
+  }
+}
+
+static lv_libssh2_status_t
+lv_libssh2_transfer_queue_launch(lv_libssh2_transfer_queue_t *queue,
+                                 lv_libssh2_transfer_worker_t *worker) {
+  lv_libssh2_status_t status = lv_libssh2_thread_start(
+      &worker->thread, lv_libssh2_transfer_queue_work, worker);
+  if (lv_libssh2_status_is_ok(status)) {
+    worker->started = true;
+    queue->active_workers += 1;
+  }
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_create(const size_t chunk_size,
+                                 const size_t window_depth,
+                                 lv_libssh2_transfer_queue_t **handle) {
+  *handle = NULL;
+  lv_libssh2_transfer_queue_t *queue =
+      calloc(1, sizeof(lv_libssh2_transfer_queue_t));
+  if (queue == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  queue->chunk_size = chunk_size;
+  queue->window_depth = window_depth;
+  lv_libssh2_mutex_init(&queue->mutex);
+  lv_libssh2_condition_init(&queue->changed);
+  *handle = queue;
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_destroy(lv_libssh2_transfer_queue_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_transfer_queue_stop(handle);
+  for (size_t i = 0; i < handle->worker_count; i++) {
+    free(handle->workers[i]);
+  }
+  for (size_t i = 0; i < handle->job_count; i++) {
+    free(handle->jobs[i].remote_path);
+    free(handle->jobs[i].local_path);
+  }
+  free(handle->workers);
+  free(handle->jobs);
+  lv_libssh2_condition_destroy(&handle->changed);
+  lv_libssh2_mutex_destroy(&handle->mutex);
+  free(handle);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_add_session(lv_libssh2_transfer_queue_t *handle,
+                                      lv_libssh2_session_t *session) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (session == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_transfer_worker_t *worker =
+      calloc(1, sizeof(lv_libssh2_transfer_worker_t));
+  if (worker == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  worker->queue = handle;
+  worker->session = session;
+  lv_libssh2_mutex_lock(&handle->mutex);
+  lv_libssh2_transfer_worker_t **workers =
+      realloc(handle->workers, (handle->worker_count + 1) *
+                                   sizeof(lv_libssh2_transfer_worker_t *));
+  if (workers == NULL) {
+    lv_libssh2_mutex_unlock(&handle->mutex);
+    free(worker);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  handle->workers = workers;
+  handle->workers[handle->worker_count] = worker;
+  handle->worker_count += 1;
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (handle->started) {
+    status = lv_libssh2_transfer_queue_launch(handle, worker);
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_transfer_queue_add(
+    lv_libssh2_transfer_queue_t *handle, const char *remote_path,
+    const char *local_path, const lv_libssh2_transfer_directions_t direction,
+    size_t *job) {
+  return lv_libssh2_transfer_queue_add_to_group(handle, remote_path, local_path,
+                                                direction, NULL, job);
+}
+
+lv_libssh2_status_t lv_libssh2_transfer_queue_add_to_group(
+    lv_libssh2_transfer_queue_t *handle, const char *remote_path,
+    const char *local_path, const lv_libssh2_transfer_directions_t direction,
+    lv_libssh2_transfer_group_t *group, size_t *job) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (remote_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (local_path == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (job == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  switch (direction) {
+  case LV_LIBSSH2_TRANSFER_DIRECTION_DOWNLOAD:
+  case LV_LIBSSH2_TRANSFER_DIRECTION_UPLOAD:
+    break;
+  default:
+    return LV_LIBSSH2_STATUS_ERROR_INVALID;
+  }
+  char *remote = lv_libssh2_transfer_queue_copy(remote_path);
+  char *local = lv_libssh2_transfer_queue_copy(local_path);
+  if (remote == NULL || local == NULL) {
+    free(remote);
+    free(local);
+    return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  if (handle->job_count == handle->job_capacity) {
+    size_t capacity = handle->job_capacity == 0 ? INITIAL_JOB_CAPACITY
+                                                : handle->job_capacity * 2;
+    lv_libssh2_transfer_job_t *jobs =
+        realloc(handle->jobs, capacity * sizeof(lv_libssh2_transfer_job_t));
+    if (jobs == NULL) {
+      lv_libssh2_mutex_unlock(&handle->mutex);
+      free(remote);
+      free(local);
+      return LV_LIBSSH2_STATUS_ERROR_MALLOC;
+    }
+    handle->jobs = jobs;
+    handle->job_capacity = capacity;
+  }
+  lv_libssh2_transfer_job_t *entry = &handle->jobs[handle->job_count];
+  entry->group = group;
+  entry->remote_path = remote;
+  entry->local_path = local;
+  entry->direction = direction;
+  entry->state = LV_LIBSSH2_TRANSFER_STATE_PENDING;
+  entry->status = LV_LIBSSH2_STATUS_OK;
+  entry->byte_count = 0;
+  entry->cancel = false;
+  *job = handle->job_count;
+  handle->job_count += 1;
+  handle->pending_count += 1;
+  if (group != NULL) {
+    group->remaining += 1;
+  }
+  lv_libssh2_condition_broadcast(&handle->changed);
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_start(lv_libssh2_transfer_queue_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  lv_libssh2_mutex_lock(&handle->mutex);
+  if (!handle->started) {
+    handle->started = true;
+    handle->stopping = false;
+    handle->start_time = lv_libssh2_time_now();
+    for (size_t i = 0; i < handle->worker_count; i++) {
+      status = lv_libssh2_transfer_queue_launch(handle, handle->workers[i]);
+      if (lv_libssh2_status_is_err(status)) {
+        break;
+      }
+    }
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  if (lv_libssh2_status_is_err(status)) {
+    lv_libssh2_transfer_queue_stop(handle);
+  }
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_stop(lv_libssh2_transfer_queue_t *handle) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  handle->stopping = true;
+  lv_libssh2_condition_broadcast(&handle->changed);
+  /* Workers can be added while others are joined, which moves the array, so
+   * each started worker is claimed under the lock and joined without it. A
+   * worker added meanwhile sees the stop, exits, and is joined in turn. */
+  size_t i = 0;
+  while (i < handle->worker_count) {
+    lv_libssh2_transfer_worker_t *worker = handle->workers[i];
+    if (!worker->started) {
+      i += 1;
+      continue;
+    }
+    worker->started = false;
+    lv_libssh2_thread_t thread = worker->thread;
+    lv_libssh2_mutex_unlock(&handle->mutex);
+    lv_libssh2_thread_join(thread);
+    lv_libssh2_mutex_lock(&handle->mutex);
+    i = 0;
+  }
+  handle->started = false;
+  handle->stopping = false;
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return LV_LIBSSH2_STATUS_OK;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_wait(lv_libssh2_transfer_queue_t *handle,
+                               const int32_t timeout) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  const uint64_t start = lv_libssh2_time_now();
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  lv_libssh2_mutex_lock(&handle->mutex);
+  while (handle->pending_count + handle->running_count > 0) {
+    if (handle->active_workers == 0) {
+      status = LV_LIBSSH2_STATUS_ERROR_BAD_USE;
+      break;
+    }
+    if (timeout < 0) {
+      lv_libssh2_condition_wait(&handle->changed, &handle->mutex);
+      continue;
+    }
+    uint64_t elapsed = lv_libssh2_time_elapsed(start) / 1000;
+    if (elapsed >= (uint64_t)timeout) {
+      status = LV_LIBSSH2_STATUS_ERROR_TIMEOUT;
+      break;
+    }
+    lv_libssh2_condition_timed_wait(&handle->changed, &handle->mutex,
+                                    (uint32_t)((uint64_t)timeout - elapsed));
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_cancel(lv_libssh2_transfer_queue_t *handle,
+                                 const size_t job) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  lv_libssh2_mutex_lock(&handle->mutex);
+  if (job < handle->job_count) {
+    lv_libssh2_transfer_job_t *entry = &handle->jobs[job];
+    entry->cancel = true;
+    if (entry->state == LV_LIBSSH2_TRANSFER_STATE_PENDING) {
+      entry->state = LV_LIBSSH2_TRANSFER_STATE_CANCELLED;
+      entry->status = LV_LIBSSH2_STATUS_ERROR_CANCELLED;
+      handle->pending_count -= 1;
+      handle->cancelled_count += 1;
+      lv_libssh2_transfer_queue_settle(entry);
+      lv_libssh2_condition_broadcast(&handle->changed);
+    }
+  } else {
+    status = LV_LIBSSH2_STATUS_ERROR_OUT_OF_BOUNDARY;
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return status;
+}
+
+lv_libssh2_status_t
+lv_libssh2_transfer_queue_job_status(lv_libssh2_transfer_queue_t *handle,
+                                     const size_t job,
+                                     lv_libssh2_transfer_states_t *state,
+                                     lv_libssh2_status_t *job_status,
+                                     uint64_t *byte_count) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (state == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (job_status == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  lv_libssh2_mutex_lock(&handle->mutex);
+  if (job < handle->job_count) {
+    *state = handle->jobs[job].state;
+    *job_status = handle->jobs[job].status;
+    *byte_count = handle->jobs[job].byte_count;
+  } else {
+    status = LV_LIBSSH2_STATUS_ERROR_OUT_OF_BOUNDARY;
+  }
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  return status;
+}
+
+lv_libssh2_status_t lv_libssh2_transfer_queue_statistics(
+    lv_libssh2_transfer_queue_t *handle, size_t *pending, size_t *running,
+    size_t *completed, size_t *failed, uint64_t *byte_count,
+    double *bytes_per_second) {
+  if (handle == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (pending == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (running == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (completed == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (failed == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (byte_count == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  if (bytes_per_second == NULL) {
+    return LV_LIBSSH2_STATUS_ERROR_NULL_VALUE;
+  }
+  lv_libssh2_mutex_lock(&handle->mutex);
+  *pending = handle->pending_count;
+  *running = handle->running_count;
+  *completed = handle->completed_count;
+  *failed = handle->failed_count + handle->cancelled_count;
+  uint64_t total = 0;
+  for (size_t i = 0; i < handle->job_count; i++) {
+    total += handle->jobs[i].byte_count;
+  }
+  *byte_count = total;
+  uint64_t elapsed =
+      handle->start_time == 0 ? 0 : lv_libssh2_time_elapsed(handle->start_time);
+  lv_libssh2_mutex_unlock(&handle->mutex);
+  *bytes_per_second =
+      elapsed == 0 ? 0.0 : (double)total * 1000000.0 / (double)elapsed;
+  return LV_LIBSSH2_STATUS_OK;
+}
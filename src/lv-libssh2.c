@@ -31,17 +31,30 @@
  *   Christopher R. Field <chris@fieldrndservices.com>
  */
 
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
 #include "libssh2.h"
 
 #include "lv-libssh2.h"
 
 lv_libssh2_status_t lv_libssh2_initialize() {
+#ifdef _WIN32
+  WSADATA data;
+  if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+    return LV_LIBSSH2_STATUS_ERROR_GENERIC;
+  }
+#endif
   libssh2_init(0);
   return LV_LIBSSH2_STATUS_OK;
 }
 
 lv_libssh2_status_t lv_libssh2_shutdown() {
   libssh2_exit();
+#ifdef _WIN32
+  WSACleanup();
+#endif
   return LV_LIBSSH2_STATUS_OK;
 }
 
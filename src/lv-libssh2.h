@@ -156,7 +156,14 @@ typedef enum _lv_libssh2_status {
   LV_LIBSSH2_STATUS_ERROR_SFTP_DIR_NOT_EMPTY = -79,
   LV_LIBSSH2_STATUS_ERROR_SFTP_NOT_A_DIRECTORY = -80,
   LV_LIBSSH2_STATUS_ERROR_SFTP_INVALID_FILENAME = -81,
-  LV_LIBSSH2_STATUS_ERROR_SFTP_LINK_LOOP = -82
+  LV_LIBSSH2_STATUS_ERROR_SFTP_LINK_LOOP = -82,
+  LV_LIBSSH2_STATUS_ERROR_CANCELLED = -83,
+  LV_LIBSSH2_STATUS_ERROR_POOL_MISS = -84,
+  LV_LIBSSH2_STATUS_ERROR_HOST_RESOLVE = -85,
+  LV_LIBSSH2_STATUS_ERROR_CONNECT = -86,
+  LV_LIBSSH2_STATUS_ERROR_REMOTE_COMMAND = -87,
+  LV_LIBSSH2_STATUS_ERROR_HOST_KEY_UNKNOWN = -88,
+  LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH = -89
 } lv_libssh2_status_t;
 
 typedef enum _lv_libssh2_session_modes {
@@ -345,6 +352,31 @@ typedef enum _lv_libssh2_trace_options {
   LV_LIBSSH2_TRACE_OPTION_TRANS = LIBSSH2_TRACE_TRANS,
 } lv_libssh2_trace_options_t;
 
+typedef enum _lv_libssh2_poller_events {
+  LV_LIBSSH2_POLLER_EVENT_READ = 1,
+  LV_LIBSSH2_POLLER_EVENT_WRITE = 2,
+  LV_LIBSSH2_POLLER_EVENT_EOF = 4,
+} lv_libssh2_poller_events_t;
+
+typedef enum _lv_libssh2_socket_options {
+  LV_LIBSSH2_SOCKET_OPTION_NONE = 0,
+  LV_LIBSSH2_SOCKET_OPTION_NODELAY = 1,
+  LV_LIBSSH2_SOCKET_OPTION_KEEPALIVE = 2,
+} lv_libssh2_socket_options_t;
+
+typedef enum _lv_libssh2_transfer_directions {
+  LV_LIBSSH2_TRANSFER_DIRECTION_DOWNLOAD = 0,
+  LV_LIBSSH2_TRANSFER_DIRECTION_UPLOAD = 1,
+} lv_libssh2_transfer_directions_t;
+
+typedef enum _lv_libssh2_transfer_states {
+  LV_LIBSSH2_TRANSFER_STATE_PENDING = 0,
+  LV_LIBSSH2_TRANSFER_STATE_RUNNING = 1,
+  LV_LIBSSH2_TRANSFER_STATE_COMPLETED = 2,
+  LV_LIBSSH2_TRANSFER_STATE_FAILED = 3,
+  LV_LIBSSH2_TRANSFER_STATE_CANCELLED = 4,
+} lv_libssh2_transfer_states_t;
+
 /**
  * The session
  */
@@ -360,6 +392,16 @@ typedef struct _lv_libssh2_knownhosts lv_libssh2_knownhosts_t;
  */
 typedef struct _lv_libssh2_knownhost lv_libssh2_knownhost_t;
 
+/**
+ * A compiled index of known hosts for fast checks
+ */
+typedef struct _lv_libssh2_knownhosts_index lv_libssh2_knownhosts_index_t;
+
+/**
+ * A known hosts file loaded once and shared between threads
+ */
+typedef struct _lv_libssh2_knownhosts_store lv_libssh2_knownhosts_store_t;
+
 /**
  * The SSH channel
  */
@@ -411,6 +453,96 @@ typedef struct _lv_libssh2_agent lv_libssh2_agent_t;
  */
 typedef struct _lv_libssh2_agent_identity lv_libssh2_agent_identity_t;
 
+/**
+ * The result of a remote command execution
+ */
+typedef struct _lv_libssh2_exec_result lv_libssh2_exec_result_t;
+
+/**
+ * The poller
+ */
+typedef struct _lv_libssh2_poller lv_libssh2_poller_t;
+
+/**
+ * The session pool
+ */
+typedef struct _lv_libssh2_pool lv_libssh2_pool_t;
+
+/**
+ * The transfer queue
+ */
+typedef struct _lv_libssh2_transfer_queue lv_libssh2_transfer_queue_t;
+
+/**
+ * The SFTP directory mirror
+ */
+typedef struct _lv_libssh2_sftp_mirror lv_libssh2_sftp_mirror_t;
+
+/**
+ * The progress of a transfer, readable from another thread
+ */
+typedef struct _lv_libssh2_progress lv_libssh2_progress_t;
+
+/**
+ * A user name and the password or key to authenticate it with
+ */
+typedef struct _lv_libssh2_credentials lv_libssh2_credentials_t;
+
+/**
+ * The outcome of running a command on many hosts
+ */
+typedef struct _lv_libssh2_fanout_result lv_libssh2_fanout_result_t;
+
+/**
+ * A connection and authentication that runs without blocking the caller
+ */
+typedef struct _lv_libssh2_async_connect lv_libssh2_async_connect_t;
+
+/**
+ * The SFTP directory listing
+ */
+typedef struct _lv_libssh2_sftp_listing lv_libssh2_sftp_listing_t;
+
+/**
+ * An entry of an SFTP directory listing
+ *
+ * The record is 40 bytes in native byte order without any padding. The name
+ * is `name_len` bytes starting at `name_offset` in the names buffer of the
+ * listing, followed by a terminating null byte. The `flags` are the
+ * `LIBSSH2_SFTP_ATTR_*` bits of the attributes sent by the server, and the
+ * `type` is a ::lv_libssh2_file_types_t value.
+ */
+typedef struct _lv_libssh2_sftp_listing_record {
+  uint64_t size;
+  uint32_t name_offset;
+  uint32_t name_len;
+  uint32_t flags;
+  uint32_t permissions;
+  uint32_t uid;
+  uint32_t gid;
+  uint32_t mtime;
+  uint32_t type;
+} lv_libssh2_sftp_listing_record_t;
+
+/**
+ * The outcome of a command on one host of a fan-out.
+ *
+ * The standard output, standard error, and exit signal name of the command
+ * are back to back in the output buffer, starting at `output_offset`. The
+ * `status` is a ::lv_libssh2_status_t value for connecting, authenticating,
+ * and running the command, the `exit_code` is only meaningful if the command
+ * ran, and `elapsed` is in milliseconds.
+ */
+typedef struct _lv_libssh2_fanout_record {
+  uint64_t output_offset;
+  uint32_t stdout_len;
+  uint32_t stderr_len;
+  uint32_t exit_signal_len;
+  int32_t status;
+  int32_t exit_code;
+  uint32_t elapsed;
+} lv_libssh2_fanout_record_t;
+
 /**
  * @defgroup agent Agent
  *
@@ -460,6 +592,67 @@ lv_libssh2_agent_identity_create(lv_libssh2_agent_identity_t **handle);
 LV_LIBSSH2_API lv_libssh2_status_t
 lv_libssh2_agent_identity_destroy(lv_libssh2_agent_identity_t *handle);
 
+/**
+ * @}
+ */
+
+/**
+ * @defgroup async-connect Async Connect
+ *
+ * Connects a session to a host, verifies its key, and authenticates without
+ * blocking the caller.
+ *
+ * @{
+ */
+
+/**
+ * Starts connecting the session, which must not have a socket yet, to the
+ * host and authenticating with the credentials. The host name and the
+ * credentials are copied, but the `known_hosts` store, which may be `NULL`,
+ * must outlive the operation.
+ *
+ * With `background` true the operation advances on its own thread, else it
+ * only advances when it is polled or waited on. Only resolving the host
+ * blocks. The `timeout`, in milliseconds, bounds the whole operation, and a
+ * negative timeout waits indefinitely. The session must not be used until
+ * the operation is done.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_async_connect_create(
+    lv_libssh2_session_t *session, const char *host, const int32_t port,
+    lv_libssh2_credentials_t *credentials,
+    lv_libssh2_knownhosts_store_t *known_hosts, const int32_t timeout,
+    const bool background, lv_libssh2_async_connect_t **handle);
+
+/**
+ * Cancels the operation if it is not done and waits for it to stop. A
+ * session that did not finish authenticating is left without a socket.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_async_connect_destroy(lv_libssh2_async_connect_t *handle);
+
+/**
+ * Gets the status of the operation without waiting, advancing it one step if
+ * it has no thread. The status is ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN
+ * until the operation is done.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_async_connect_poll(lv_libssh2_async_connect_t *handle);
+
+/**
+ * Waits up to `timeout` milliseconds for the operation to be done and gets
+ * its status, like lv_libssh2_async_connect_poll. A negative timeout waits
+ * indefinitely.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_async_connect_wait(
+    lv_libssh2_async_connect_t *handle, const int32_t timeout);
+
+/**
+ * Asks the operation to stop, after which it is done with a
+ * ::LV_LIBSSH2_STATUS_ERROR_CANCELLED status.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_async_connect_cancel(lv_libssh2_async_connect_t *handle);
+
 /**
  * @}
  */
@@ -509,6 +702,14 @@ LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_userauth_publickey_from_memory(
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_create(
     lv_libssh2_session_t *session, lv_libssh2_channel_t **handle);
 
+/**
+ * Opens a session channel with the given receive window and maximum packet
+ * sizes in bytes. A size of zero uses the libssh2 default.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_create_ex(
+    lv_libssh2_session_t *session, const uint32_t window_size,
+    const uint32_t packet_size, lv_libssh2_channel_t **handle);
+
 LV_LIBSSH2_API lv_libssh2_status_t
 lv_libssh2_channel_destroy(lv_libssh2_channel_t *handle);
 
@@ -565,6 +766,21 @@ LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_receive_window_adjust(
     lv_libssh2_channel_t *handle, const uint32_t adjustment,
     const uint8_t force, uint32_t *window);
 
+/**
+ * Grows the receive window automatically, up to `max_window` bytes, whenever
+ * reads show the sender waiting on the window rather than the link. The
+ * window settles near the bandwidth-delay product. A `max_window` of zero
+ * turns auto-tuning off.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_set_autotune(
+    lv_libssh2_channel_t *handle, const uint32_t max_window);
+
+/**
+ * Gets the receive window size the channel is currently tuned to, in bytes.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_autotune_window(
+    lv_libssh2_channel_t *handle, uint32_t *window);
+
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_request_pty(
     lv_libssh2_channel_t *handle, const char *terminal);
 
@@ -603,6 +819,235 @@ LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_write_stderr(
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_request_x11(
     lv_libssh2_channel_t *handle, const int32_t screen_number);
 
+/**
+ * Allocates a page-aligned ring buffer of at least the capacity for reading
+ * the channel, and returns its address and actual length.
+ *
+ * The capacity is rounded up to a whole number of pages. The buffer is owned
+ * by the channel and freed with lv_libssh2_channel_ring_destroy() or when the
+ * channel is destroyed.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_ring_create(
+    lv_libssh2_channel_t *handle, const size_t capacity, uint8_t **buffer,
+    size_t *buffer_len);
+
+/**
+ * Registers the caller's buffer as the ring buffer for reading the channel.
+ *
+ * The buffer is not copied and must stay valid until the ring is destroyed.
+ * A buffer that does not start on a page boundary is rejected with
+ * ::LV_LIBSSH2_STATUS_ERROR_INVALID.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_ring_register(
+    lv_libssh2_channel_t *handle, uint8_t *buffer, const size_t buffer_len);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_channel_ring_destroy(lv_libssh2_channel_t *handle);
+
+/**
+ * Reads from the channel directly into the free space of the ring.
+ *
+ * A blocking channel waits for data at most once, and then only reads what
+ * has already arrived. A zero `byte_count` means the ring is full or the
+ * channel reached end of file.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_channel_ring_fill(lv_libssh2_channel_t *handle, size_t *byte_count);
+
+/**
+ * Gets the offset into the ring buffer and length of the next contiguous
+ * span of unread data.
+ *
+ * Data that wraps around the end of the buffer is returned by the next span
+ * after this one is committed.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_ring_span(
+    lv_libssh2_channel_t *handle, size_t *offset, size_t *len);
+
+/**
+ * Marks the number of bytes as consumed, making room for the next fill.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_channel_ring_commit(lv_libssh2_channel_t *handle, const size_t len);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup credentials Credentials
+ *
+ * A user name with a password, a key, or both, for functions that connect
+ * and authenticate on their own. A key is tried before a password.
+ *
+ * @{
+ */
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_credentials_create(
+    const char *username, lv_libssh2_credentials_t **handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_credentials_destroy(lv_libssh2_credentials_t *handle);
+
+/**
+ * Sets the password. An empty password clears it.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_credentials_set_password(
+    lv_libssh2_credentials_t *handle, const char *password);
+
+/**
+ * Sets the key files, as for lv_libssh2_userauth_publickey_from_file. An
+ * empty private key path clears the key, and an empty public key path
+ * derives the public key from the private key.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_credentials_set_publickey_from_file(
+    lv_libssh2_credentials_t *handle, const char *public_key_path,
+    const char *private_key_path, const char *passphrase);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup exec Exec
+ *
+ * @{
+ */
+
+/**
+ * Runs the command on a new channel and captures its output and exit status.
+ *
+ * The standard output and error streams are drained together into buffers
+ * that grow as needed, so a command that writes heavily to one stream cannot
+ * stall on the other. The session is in non-blocking mode while the command
+ * runs and is restored to its previous mode afterwards. The `timeout`, in
+ * milliseconds, bounds the whole execution, including closing the channel. A
+ * negative timeout waits indefinitely. When the command is still running at
+ * the timeout, the channel is asked to close and is freed with the session.
+ *
+ * This allocates memory which should be freed with the
+ * lv_libssh2_exec_result_destroy() function.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_capture(lv_libssh2_session_t *session, const char *command,
+                        const int32_t timeout,
+                        lv_libssh2_exec_result_t **handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_destroy(lv_libssh2_exec_result_t *handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_stdout_len(lv_libssh2_exec_result_t *handle,
+                                  size_t *len);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_stdout(lv_libssh2_exec_result_t *handle,
+                              uint8_t *buffer);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_stderr_len(lv_libssh2_exec_result_t *handle,
+                                  size_t *len);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_stderr(lv_libssh2_exec_result_t *handle,
+                              uint8_t *buffer);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_exit_code(lv_libssh2_exec_result_t *handle,
+                                 int32_t *code);
+
+/**
+ * Gets the length of the name of the signal that terminated the command,
+ * which is zero if the command exited normally.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_exit_signal_len(lv_libssh2_exec_result_t *handle,
+                                       size_t *len);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_exec_result_exit_signal(lv_libssh2_exec_result_t *handle,
+                                   char *buffer);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup fanout Fan-out
+ *
+ * Runs one command on many hosts with one call.
+ *
+ * @{
+ */
+
+/**
+ * Connects to each host, authenticates, and runs the command with
+ * lv_libssh2_exec_capture, on up to `workers` threads at once. Zero workers
+ * uses the default of 16, and at most 256 are used.
+ *
+ * The `hosts` buffer holds `count` NUL-terminated host names back to back,
+ * and the `ports` array has `count` elements. The `timeout`, in
+ * milliseconds, bounds the whole of each host, and a negative timeout waits
+ * indefinitely. If `known_hosts` is not `NULL`, a host whose key does not
+ * match is not authenticated with and gets a
+ * ::LV_LIBSSH2_STATUS_ERROR_HOST_KEY_UNKNOWN or
+ * ::LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH status.
+ *
+ * If `progress` is not `NULL`, its byte count is the number of hosts done
+ * and its total is `count`. Cancelling it lets the hosts in progress finish
+ * and gives the rest a ::LV_LIBSSH2_STATUS_ERROR_CANCELLED status.
+ *
+ * The failure of a host is only reported in its record. The returned status
+ * is an error only if the arguments are wrong or memory runs out.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_fanout_exec(
+    const char *hosts, const size_t hosts_len, const int32_t *ports,
+    const size_t count, lv_libssh2_credentials_t *credentials,
+    lv_libssh2_knownhosts_store_t *known_hosts, const char *command,
+    const int32_t timeout, const size_t workers,
+    lv_libssh2_progress_t *progress, lv_libssh2_fanout_result_t **handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_fanout_result_destroy(lv_libssh2_fanout_result_t *handle);
+
+/**
+ * Gets the number of hosts, which is the number of records.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_fanout_result_count(lv_libssh2_fanout_result_t *handle,
+                               size_t *count);
+
+/**
+ * Gets the length of the ::lv_libssh2_fanout_record_t records, in bytes.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_fanout_result_records_len(lv_libssh2_fanout_result_t *handle,
+                                     size_t *len);
+
+/**
+ * Copies the records, in the order of the hosts, into the buffer, which must
+ * be at least the length from lv_libssh2_fanout_result_records_len.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_fanout_result_records(lv_libssh2_fanout_result_t *handle,
+                                 uint8_t *buffer);
+
+/**
+ * Gets the length of the output of every host, in bytes.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_fanout_result_output_len(lv_libssh2_fanout_result_t *handle,
+                                    size_t *len);
+
+/**
+ * Copies the output into the buffer, which must be at least the length from
+ * lv_libssh2_fanout_result_output_len.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_fanout_result_output(lv_libssh2_fanout_result_t *handle,
+                                uint8_t *buffer);
+
 /**
  * @}
  */
@@ -700,6 +1145,26 @@ LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_check_and_get(
     lv_libssh2_knownhost_t *known_host,
     lv_libssh2_knownhosts_check_results_t *result);
 
+/**
+ * Checks the keys of many hosts with one call.
+ *
+ * The `hosts` buffer holds `count` NUL-terminated host names back to back,
+ * and the `keys` buffer holds `count` keys back to back, with the length of
+ * each in `key_lens`. The `ports` and `results` arrays have `count`
+ * elements, and a port of -1 checks the host name alone. The results are
+ * the same as from lv_libssh2_knownhosts_index_check.
+ *
+ * The entries are indexed once for the whole batch. If any are hashed, the
+ * hosts are checked on up to `threads` threads, where zero is the default
+ * of 4 and at most 32 are used.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_check_many(
+    lv_libssh2_knownhosts_t *handle, const char *hosts, const size_t hosts_len,
+    const int *ports, const uint8_t *keys, const size_t keys_len,
+    const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding, const size_t threads,
+    lv_libssh2_knownhosts_check_results_t *results);
+
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_delete(
     lv_libssh2_knownhosts_t *handle, lv_libssh2_knownhost_t *knownhost);
 
@@ -763,56 +1228,513 @@ lv_libssh2_knownhost_type_mask(lv_libssh2_knownhost_t *handle, int *type_mask);
  */
 
 /**
- * @defgroup scp SCP
+ * @defgroup known-hosts-index Known Hosts Index
+ *
+ * A read-only copy of a known hosts collection for checking many hosts.
+ * Plain host names are found by hash, and a hashed host name costs one
+ * HMAC for each distinct salt instead of one for each hashed entry. Host
+ * names resolved against the hashed entries are remembered, up to 65536 of
+ * them, so checking the same host again is a single lookup.
  *
  * @{
  */
 
-LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_scp_send(
-    lv_libssh2_session_t *session, const char *path, const int permissions,
-    const size_t file_size, lv_libssh2_channel_t **handle);
+/**
+ * Creates an index of the entries in the known hosts collection, such as
+ * after reading a file with lv_libssh2_knownhosts_read_file. Later changes
+ * to the collection are not seen by the index.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_knownhosts_index_create(lv_libssh2_knownhosts_t *knownhosts,
+                                   lv_libssh2_knownhosts_index_t **handle);
 
-LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_scp_receive(
-    lv_libssh2_session_t *session, const char *path,
-    lv_libssh2_fileinfo_t *file_info, lv_libssh2_channel_t **handle);
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_knownhosts_index_destroy(lv_libssh2_knownhosts_index_t *handle);
+
+/**
+ * Checks a host key with the same results as lv_libssh2_knownhosts_check
+ * for a plain host name. The key type is not compared. The index can be
+ * checked from several threads at once.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_index_check(
+    lv_libssh2_knownhosts_index_t *handle, const char *host, const int port,
+    const uint8_t *key, const size_t key_len,
+    const lv_libssh2_knownhost_key_encodings_t encoding,
+    lv_libssh2_knownhosts_check_results_t *result);
+
+/**
+ * Gets the number of plain host names, hashed host names, and distinct
+ * salts in the index.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_index_statistics(
+    lv_libssh2_knownhosts_index_t *handle, size_t *name_count,
+    size_t *hashed_count, size_t *salt_count);
+
+/**
+ * Checks the keys of many hosts with one call, taking the same arguments as
+ * lv_libssh2_knownhosts_check_many.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_index_check_many(
+    lv_libssh2_knownhosts_index_t *handle, const char *hosts,
+    const size_t hosts_len, const int *ports, const uint8_t *keys,
+    const size_t keys_len, const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding, const size_t threads,
+    lv_libssh2_knownhosts_check_results_t *results);
 
 /**
  * @}
  */
 
 /**
- * @defgroup session Session
+ * @defgroup known-hosts-store Known Hosts Store
+ *
+ * A known hosts file that is mapped into memory and indexed once, then
+ * checked by any number of sessions on any number of threads. A check does
+ * not wait on other checks or on a reload. Once a second, a thread of the
+ * store looks at the file and, if its size or modification time changed,
+ * loads it again and swaps the new index in. Checks of hashed host names
+ * share the memo of the index, which is also read and added to without a
+ * lock.
  *
  * @{
  */
 
 /**
- * Creates a session.
- *
- * This allocates memory which should be freed with the
- * lv_libssh2_session_destroy() function when work with the session is complete.
+ * Loads the known hosts file in the OpenSSH format. Lines with markers, such
+ * as `@cert-authority`, and RSA1 keys are skipped. The store starts a thread
+ * that watches the file until the store is destroyed.
  */
 LV_LIBSSH2_API lv_libssh2_status_t
-lv_libssh2_session_create(lv_libssh2_session_t **handle);
+lv_libssh2_knownhosts_store_create(const char *path,
+                                   lv_libssh2_knownhosts_store_t **handle);
 
 /**
- * Destroys a session.
- *
- * Frees the memory allocated for the session. Once called, the handle is no
- * longer valid and future usage of the handle will result in a
- * ::LV_LIBSSH2_STATUS_ERROR_NULL_VALUE status.
+ * Destroys the store. No check can be in progress.
  */
 LV_LIBSSH2_API lv_libssh2_status_t
-lv_libssh2_session_destroy(lv_libssh2_session_t *handle);
+lv_libssh2_knownhosts_store_destroy(lv_libssh2_knownhosts_store_t *handle);
 
-LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_connect(
-    lv_libssh2_session_t *handle, const uintptr_t socket);
+/**
+ * Checks a host key with the same results as
+ * lv_libssh2_knownhosts_index_check.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_store_check(
+    lv_libssh2_knownhosts_store_t *handle, const char *host, const int port,
+    const uint8_t *key, const size_t key_len,
+    const lv_libssh2_knownhost_key_encodings_t encoding,
+    lv_libssh2_knownhosts_check_results_t *result);
 
-LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_disconnect(
-    lv_libssh2_session_t *handle, const char *description);
+/**
+ * Checks the keys of many hosts with one call, taking the same arguments as
+ * lv_libssh2_knownhosts_check_many. The whole batch is checked against the
+ * same version of the file.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_store_check_many(
+    lv_libssh2_knownhosts_store_t *handle, const char *hosts,
+    const size_t hosts_len, const int *ports, const uint8_t *keys,
+    const size_t keys_len, const size_t *key_lens, const size_t count,
+    const lv_libssh2_knownhost_key_encodings_t encoding, const size_t threads,
+    lv_libssh2_knownhosts_check_results_t *results);
 
-LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_hostkey_hash_len(
-    const lv_libssh2_hostkey_hash_types_t type, size_t *len);
+/**
+ * Loads the file again now if it changed, instead of waiting for the thread
+ * of the store to notice. If the file cannot be loaded, the previous entries
+ * stay in use. A reload waits for the checks in progress to finish before
+ * freeing the previous entries.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_knownhosts_store_reload(lv_libssh2_knownhosts_store_t *handle,
+                                   bool *reloaded);
+
+/**
+ * Gets the number of times the file has been loaded again since the store
+ * was created.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_knownhosts_store_reload_count(
+    lv_libssh2_knownhosts_store_t *handle, uint64_t *count);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup poller Poller
+ *
+ * Waits on many sessions and channels with a single call instead of
+ * repeatedly retrying non-blocking calls.
+ *
+ * A channel is ready when it has data to read on either stream, room in its
+ * write window, or has reached end of file, filtered by the events it was
+ * added with. End of file is always reported. A session is ready when its
+ * socket can be read, or written if the session last blocked on writing, so
+ * a non-blocking call that returned ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN
+ * can be retried. Sessions must have been connected with
+ * lv_libssh2_session_connect() or lv_libssh2_session_connect_host().
+ *
+ * @{
+ */
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_poller_create(lv_libssh2_poller_t **handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_poller_destroy(lv_libssh2_poller_t *handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_poller_add_session(
+    lv_libssh2_poller_t *handle, lv_libssh2_session_t *session);
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_poller_remove_session(
+    lv_libssh2_poller_t *handle, lv_libssh2_session_t *session);
+
+/**
+ * Adds the channel, or updates its events if it was already added.
+ *
+ * The `events` are a bitwise OR of the ::lv_libssh2_poller_events_t values.
+ * Remove the channel before destroying it.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_poller_add_channel(
+    lv_libssh2_poller_t *handle, lv_libssh2_channel_t *channel,
+    const uint32_t events);
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_poller_remove_channel(
+    lv_libssh2_poller_t *handle, lv_libssh2_channel_t *channel);
+
+/**
+ * Waits until at least one session or channel is ready, or the `timeout`, in
+ * milliseconds, elapses. A negative timeout waits indefinitely.
+ *
+ * The `ready_count` is zero if the wait timed out.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_poller_wait(
+    lv_libssh2_poller_t *handle, const int32_t timeout, size_t *ready_count);
+
+/**
+ * Gets a ready session or channel from the last wait.
+ *
+ * The `channel` is `NULL` if a session is ready. The `events` are a bitwise OR
+ * of the ::lv_libssh2_poller_events_t values.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_poller_ready(
+    lv_libssh2_poller_t *handle, const size_t index,
+    lv_libssh2_session_t **session, lv_libssh2_channel_t **channel,
+    uint32_t *events);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup pool Pool
+ *
+ * Authenticated sessions kept alive for reuse, keyed by host, port, user, and
+ * credential fingerprint.
+ *
+ * The fingerprint is any text that identifies the credentials, such as a
+ * public key hash, so sessions authenticated differently are never shared.
+ * Each pooled session is leased to one channel at a time. A background thread
+ * sends keepalives on idle sessions and evicts those that exceed the idle
+ * timeout or stop responding.
+ *
+ * @{
+ */
+
+/**
+ * Creates a session pool.
+ *
+ * Sessions idle for longer than the `idle_timeout`, in milliseconds, are
+ * evicted. A zero `idle_timeout` keeps idle sessions until they are evicted
+ * explicitly or stop responding.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_pool_create(const uint32_t idle_timeout, lv_libssh2_pool_t **handle);
+
+/**
+ * Disconnects and destroys every pooled session, and destroys the pool.
+ *
+ * Channels that have not been released are destroyed, too.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_pool_destroy(lv_libssh2_pool_t *handle);
+
+/**
+ * Adds an authenticated session to the pool.
+ *
+ * The pool takes ownership of the session and puts it in blocking mode. Do
+ * not use or destroy the session afterwards. The socket is not owned by the
+ * pool and must stay open until the session is evicted.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_pool_add(
+    lv_libssh2_pool_t *handle, const char *host, const int32_t port,
+    const char *user, const char *fingerprint, lv_libssh2_session_t *session);
+
+/**
+ * Opens a channel on an idle pooled session with the same key.
+ *
+ * A pool miss error is returned if there is no such session, in which case
+ * connect and authenticate a new session, add it to the pool, and try again.
+ * Sessions that fail to open a channel are evicted. Release the channel
+ * instead of destroying it.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_pool_channel_open(
+    lv_libssh2_pool_t *handle, const char *host, const int32_t port,
+    const char *user, const char *fingerprint, lv_libssh2_channel_t **channel);
+
+/**
+ * Destroys a channel opened from the pool and returns its session to the
+ * pool.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_pool_channel_release(
+    lv_libssh2_pool_t *handle, lv_libssh2_channel_t *channel);
+
+/**
+ * Disconnects and destroys every idle session in the pool.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_pool_evict_idle(lv_libssh2_pool_t *handle, size_t *evicted);
+
+/**
+ * Gets the number of idle and leased sessions, and the hit, miss, and
+ * eviction counts since the pool was created.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_pool_statistics(
+    lv_libssh2_pool_t *handle, size_t *idle, size_t *leased, uint64_t *hits,
+    uint64_t *misses, uint64_t *evictions);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup progress Progress
+ *
+ * A counter that a transfer running on one thread updates and any other
+ * thread can read, such as a LabVIEW loop showing a progress bar while the
+ * transfer call blocks.
+ *
+ * @{
+ */
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_progress_create(lv_libssh2_progress_t **handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_progress_destroy(lv_libssh2_progress_t *handle);
+
+/**
+ * Gets the number of bytes transferred so far and the size of the file, as
+ * of the last transfer the progress was passed to.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_progress_get(lv_libssh2_progress_t *handle, uint64_t *byte_count,
+                        uint64_t *total);
+
+/**
+ * Stops the transfer at its next update with
+ * ::LV_LIBSSH2_STATUS_ERROR_CANCELLED. A cancelled progress also stops every
+ * later transfer it is passed to.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_progress_cancel(lv_libssh2_progress_t *handle);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup pump Pump
+ *
+ * A background thread per session that moves channel data between the
+ * network and bounded queues, so data keeps flowing between calls.
+ *
+ * While the pump runs, reading and writing a pumped channel use its queues.
+ * When the incoming queue reaches the high watermark, the pump stops reading
+ * the channel until it drains to the low watermark, which stops the server
+ * from sending more. The standard error stream has its own queue, and writes
+ * to standard error are not pumped. Other calls on the session and its
+ * channels must not be made until the pump is stopped, except destroying a
+ * channel.
+ *
+ * @{
+ */
+
+/**
+ * Starts the pump for the session.
+ *
+ * A zero `queue_capacity` selects 256 KiB per queue. A zero `high_watermark`
+ * selects the queue capacity and a zero `low_watermark` half of the high
+ * watermark. The session is put in non-blocking mode for the pump. Reads and
+ * writes on pumped channels wait on the queues if the session was in blocking
+ * mode, or return ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN otherwise.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_pump_start(
+    lv_libssh2_session_t *handle, const size_t queue_capacity,
+    const size_t high_watermark, const size_t low_watermark);
+
+/**
+ * Stops the pump, writing any queued outgoing data, and restores the session
+ * mode.
+ *
+ * Data already in the incoming queues is still returned by the next reads.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_session_pump_stop(lv_libssh2_session_t *handle);
+
+/**
+ * Adds the channel to the pump of its session.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_channel_pump(lv_libssh2_channel_t *handle);
+
+/**
+ * Gets the number of bytes waiting in each queue of the channel, and whether
+ * the pump has stopped reading the channel because of backpressure.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_channel_pump_depth(
+    lv_libssh2_channel_t *handle, size_t *read_depth, size_t *stderr_depth,
+    size_t *write_depth, bool *paused);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup scp SCP
+ *
+ * @{
+ */
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_scp_send(
+    lv_libssh2_session_t *session, const char *path, const int permissions,
+    const size_t file_size, lv_libssh2_channel_t **handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_scp_receive(
+    lv_libssh2_session_t *session, const char *path,
+    lv_libssh2_fileinfo_t *file_info, lv_libssh2_channel_t **handle);
+
+/**
+ * Writes the whole local file to a channel from lv_libssh2_scp_send, which
+ * must have been created with the size of the local file.
+ *
+ * The file is sent straight from a memory-mapped view, so it is never
+ * copied into a LabVIEW array. The session is in blocking mode for the
+ * duration of the transfer and restored to its previous mode afterwards.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_scp_send_file(lv_libssh2_channel_t *handle, const char *local_path,
+                         uint64_t *byte_count);
+
+/**
+ * Reads the file from a channel from lv_libssh2_scp_receive into the local
+ * file, replacing any existing local file.
+ *
+ * The file information must be the one filled in by lv_libssh2_scp_receive,
+ * as it holds the size of the file. The data is read straight into a
+ * memory-mapped view of the local file. The session is in blocking mode for
+ * the duration of the transfer and restored to its previous mode
+ * afterwards.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_scp_receive_file(
+    lv_libssh2_channel_t *handle, lv_libssh2_fileinfo_t *file_info,
+    const char *local_path, uint64_t *byte_count);
+
+/**
+ * Uploads the local file to the remote path with the permissions, running
+ * the whole transfer natively.
+ *
+ * The file is sent straight from memory-mapped views, and the channel is
+ * closed once the server has acknowledged it. The `progress` is optional
+ * and may be `NULL`. The session is in blocking mode for the duration of the
+ * transfer and restored to its previous mode afterwards.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_scp_upload_file(
+    lv_libssh2_session_t *session, const char *local_path,
+    const char *remote_path, const int32_t permissions,
+    lv_libssh2_progress_t *progress, uint64_t *byte_count);
+
+/**
+ * Downloads the remote file to the local file, replacing any existing local
+ * file and running the whole transfer natively.
+ *
+ * Exactly the size announced by the server is read straight into
+ * memory-mapped views of the local file, with the receive window of the
+ * channel grown by 16 MiB. The `progress` is optional and may be `NULL`.
+ * The session is in blocking mode for the duration of the transfer and
+ * restored to its previous mode afterwards.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_scp_download_file(
+    lv_libssh2_session_t *session, const char *remote_path,
+    const char *local_path, lv_libssh2_progress_t *progress,
+    uint64_t *byte_count);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup session Session
+ *
+ * @{
+ */
+
+/**
+ * Creates a session.
+ *
+ * This allocates memory which should be freed with the
+ * lv_libssh2_session_destroy() function when work with the session is complete.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_session_create(lv_libssh2_session_t **handle);
+
+/**
+ * Destroys a session.
+ *
+ * Frees the memory allocated for the session. Once called, the handle is no
+ * longer valid and future usage of the handle will result in a
+ * ::LV_LIBSSH2_STATUS_ERROR_NULL_VALUE status.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_session_destroy(lv_libssh2_session_t *handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_connect(
+    lv_libssh2_session_t *handle, const uintptr_t socket);
+
+/**
+ * Opens a TCP connection to the host and runs the handshake on it.
+ *
+ * The host is resolved and its addresses are raced against each other,
+ * alternating between IPv6 and IPv4, with a new attempt started every 250 ms
+ * until one connects. The `options` are a bitwise OR of the
+ * ::lv_libssh2_socket_options_t values, and the socket buffer sizes are those
+ * set with lv_libssh2_session_set_socket_buffers(). The `timeout`, in
+ * milliseconds, bounds both the connection and the handshake. A negative
+ * timeout waits indefinitely.
+ *
+ * The handshake is completed before returning, even on a session in
+ * non-blocking mode, whose mode is restored afterwards. The call never
+ * returns ::LV_LIBSSH2_STATUS_ERROR_EXECUTE_AGAIN.
+ *
+ * The socket is owned by the session and is closed when the session is
+ * destroyed.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_connect_host(
+    lv_libssh2_session_t *handle, const char *host, const int32_t port,
+    const int32_t timeout, const uint32_t options);
+
+/**
+ * Sets the send and receive buffer sizes, in bytes, of sockets opened by
+ * lv_libssh2_session_connect_host().
+ *
+ * A zero size keeps the system default.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_set_socket_buffers(
+    lv_libssh2_session_t *handle, const int32_t send_buffer_size,
+    const int32_t receive_buffer_size);
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_disconnect(
+    lv_libssh2_session_t *handle, const char *description);
+
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_hostkey_hash_len(
+    const lv_libssh2_hostkey_hash_types_t type, size_t *len);
 
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_session_hostkey_hash(
     lv_libssh2_session_t *handle, const lv_libssh2_hostkey_hash_types_t type,
@@ -937,6 +1859,34 @@ lv_libssh2_sftp_file_rewind(lv_libssh2_sftp_file_t *handle);
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_file_position(
     lv_libssh2_sftp_file_t *handle, uint64_t *position);
 
+/**
+ * Limits how many bytes a sequential reader is read ahead of, where zero
+ * disables reading ahead. The default is 1 MiB.
+ *
+ * Once a file has been read twice without a seek in between, small reads are
+ * served from a buffer that is refilled with one larger read, starting at
+ * 32 KiB and doubling on each refill up to the limit. A seek within the
+ * buffered data keeps it, any other seek drops it and starts over, and a
+ * write or setting the status drops it.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_file_set_read_ahead(
+    lv_libssh2_sftp_file_t *handle, const uint32_t max_depth);
+
+/**
+ * Holds back writes smaller than `size` bytes and sends them together, where
+ * a `size` of zero, the default, writes straight through.
+ *
+ * The held-back bytes are written once the next write would not fit, or by
+ * the first write after the oldest of them is `max_age` milliseconds old,
+ * where zero means no age limit. They are also written before a read, seek,
+ * rewind, sync, status change, status query, or close of the file. A failure
+ * to write them is reported by the call that wrote them, and by a close
+ * after the file has been closed anyway.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_file_set_write_back(
+    lv_libssh2_sftp_file_t *handle, const uint32_t size,
+    const uint32_t max_age);
+
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_file_status(
     lv_libssh2_sftp_file_t *handle, lv_libssh2_sftp_attributes_t *attributes);
 
@@ -947,6 +1897,14 @@ LV_LIBSSH2_API lv_libssh2_status_t
 lv_libssh2_sftp_link_status(lv_libssh2_sftp_t *handle, const char *path,
                             lv_libssh2_sftp_attributes_t *attributes);
 
+/**
+ * Gets the attributes of the remote path, following a symbolic link to its
+ * target.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_stat(lv_libssh2_sftp_t *handle, const char *path,
+                     lv_libssh2_sftp_attributes_t *attributes);
+
 LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_file_rename(
     lv_libssh2_sftp_t *handle, const char *source_path,
     const char *destination_path, const int32_t options);
@@ -976,6 +1934,373 @@ LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_resolve_real_link(
  * @}
  */
 
+/**
+ * @defgroup sftp-cache SFTP Cache
+ *
+ * An optional cache of remote metadata for an SFTP handle.
+ *
+ * While enabled, the results of lv_libssh2_sftp_link_status,
+ * lv_libssh2_sftp_stat, and lv_libssh2_sftp_stat_many, including a missing
+ * file, and lv_libssh2_sftp_list_directory are reused until they are `ttl`
+ * milliseconds old. Calls through the same handle that change a path,
+ * such as deleting, renaming, creating, writing, or setting the status of a
+ * file, drop the cached entries for the path and the listing of its parent
+ * directory. Changes made by other handles or clients are only seen once the
+ * entries expire.
+ *
+ * @{
+ */
+
+/**
+ * Enables the cache, replacing any existing cache and its entries.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_enable_cache(lv_libssh2_sftp_t *handle, const uint32_t ttl);
+
+/**
+ * Disables the cache and drops its entries.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_disable_cache(lv_libssh2_sftp_t *handle);
+
+/**
+ * Drops all of the entries, keeping the cache enabled.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_clear_cache(lv_libssh2_sftp_t *handle);
+
+/**
+ * Gets the number of lookups answered by the cache, the number that went to
+ * the server, and the number of cached entries.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_cache_statistics(lv_libssh2_sftp_t *handle, uint64_t *hits,
+                                 uint64_t *misses, size_t *entries);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup sftp-listing SFTP Listing
+ *
+ * Whole-directory listings read with one call.
+ *
+ * The entries, other than `.` and `..`, are packed into an array of
+ * ::lv_libssh2_sftp_listing_record_t records and a separate buffer of names,
+ * so both can be copied out and unflattened at once. The session is in
+ * blocking mode while the directory is read and restored to its previous
+ * mode afterwards.
+ *
+ * @{
+ */
+
+/**
+ * Reads every entry of the remote directory.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_list_directory(lv_libssh2_sftp_t *sftp, const char *path,
+                               lv_libssh2_sftp_listing_t **handle);
+
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_listing_destroy(lv_libssh2_sftp_listing_t *handle);
+
+/**
+ * Gets the number of entries.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_listing_count(lv_libssh2_sftp_listing_t *handle,
+                              size_t *count);
+
+/**
+ * Gets the length of the records, in bytes.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_listing_records_len(lv_libssh2_sftp_listing_t *handle,
+                                    size_t *len);
+
+/**
+ * Copies the records into the buffer, which must be at least the length from
+ * lv_libssh2_sftp_listing_records_len.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_listing_records(lv_libssh2_sftp_listing_t *handle,
+                                uint8_t *buffer);
+
+/**
+ * Gets the length of the names, in bytes.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_listing_names_len(lv_libssh2_sftp_listing_t *handle,
+                                  size_t *len);
+
+/**
+ * Copies the names into the buffer, which must be at least the length from
+ * lv_libssh2_sftp_listing_names_len.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_listing_names(lv_libssh2_sftp_listing_t *handle,
+                              uint8_t *buffer);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup sftp-stat SFTP Batch Status
+ *
+ * The attributes of many remote paths read with one call.
+ *
+ * The SFTP protocol allows many outstanding requests, but libssh2 only
+ * tracks one status request per SFTP channel. The batch is spread across a
+ * number of extra SFTP channels, or lanes, on the same session, each with
+ * one request in flight. The lanes are opened at the start of each batch and
+ * closed at its end.
+ *
+ * @{
+ */
+
+/**
+ * Gets the attributes of each path, following symbolic links.
+ *
+ * The `paths` buffer holds `count` NUL-terminated paths back to back. The
+ * `records` and `statuses` arrays must have room for `count` elements. The
+ * `name_offset` and `name_len` of each record locate its path in the `paths`
+ * buffer, and its status is the result of the request for that path, such
+ * as a missing file. The other fields of a record are only set if its status
+ * is OK. A `lanes` of zero uses the default of 4, and at most 8 are used.
+ *
+ * Each lane is a session channel held for the duration of the call. Servers
+ * limit the channels of a session, such as the 10 allowed by the OpenSSH
+ * MaxSessions default, which the lanes share with the SFTP handle and any
+ * other open channels. Fewer lanes are used if the server refuses more.
+ *
+ * The returned status is an error only if the batch as a whole failed, such
+ * as a lost connection or no reply within the session timeout.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_stat_many(
+    lv_libssh2_sftp_t *sftp, const char *paths, const size_t paths_len,
+    const size_t count, const size_t lanes,
+    lv_libssh2_sftp_listing_record_t *records, lv_libssh2_status_t *statuses);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup sftp-transfer SFTP Transfer
+ *
+ * Whole-file transfers that run natively instead of one call per chunk.
+ *
+ * The window, `chunk_size` multiplied by `window_depth`, is the amount of data
+ * kept in flight to or from the server. A zero `chunk_size` or
+ * `window_depth` selects the default of 32 KiB and 32, respectively. A
+ * window larger than 64 MiB is reduced to 64 MiB. The session is in blocking
+ * mode for the duration of the transfer and restored to its previous mode
+ * afterwards. Local files are read and written through memory-mapped views
+ * rather than an intermediate buffer.
+ *
+ * @{
+ */
+
+/**
+ * Downloads the remote file to the local file, replacing any existing local
+ * file.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_download(
+    lv_libssh2_sftp_t *sftp, const char *remote_path, const char *local_path,
+    const size_t chunk_size, const size_t window_depth, uint64_t *byte_count);
+
+/**
+ * Downloads the remote file into the buffer.
+ *
+ * At most `buffer_max_length` bytes are read. Use the SFTP attributes of the
+ * remote file to size the buffer.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_download_to_buffer(
+    lv_libssh2_sftp_t *sftp, const char *remote_path, uint8_t *buffer,
+    const size_t buffer_max_length, const size_t chunk_size,
+    const size_t window_depth, size_t *read_count);
+
+/**
+ * Uploads the local file to the remote file, creating or truncating the
+ * remote file with the permissions.
+ *
+ * The average rate of the transfer is returned in `bytes_per_second`.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_upload(
+    lv_libssh2_sftp_t *sftp, const char *local_path, const char *remote_path,
+    const int32_t permissions, const size_t chunk_size,
+    const size_t window_depth, uint64_t *byte_count, double *bytes_per_second);
+
+/**
+ * Uploads the buffer to the remote file, creating or truncating the remote
+ * file with the permissions.
+ *
+ * The average rate of the transfer is returned in `bytes_per_second`.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_upload_from_buffer(
+    lv_libssh2_sftp_t *sftp, const uint8_t *buffer, const size_t buffer_length,
+    const char *remote_path, const int32_t permissions,
+    const size_t chunk_size, const size_t window_depth, uint64_t *byte_count,
+    double *bytes_per_second);
+
+/**
+ * Downloads the remote file to the local file, continuing an earlier
+ * attempt recorded in the journal file if there is one.
+ *
+ * While the transfer runs, the offset up to which the local file holds the
+ * remote data is recorded in the journal every 8 MiB and when the transfer
+ * fails. The journal also records the size and modification time of the
+ * remote file, and the transfer only continues from the recorded offset if
+ * they are unchanged and the local file is at least that long. If
+ * `verify_tail` is true, the last 64 KiB before the offset must also match
+ * the digest recorded with it. Otherwise the transfer starts over. The
+ * journal is deleted once the transfer completes.
+ *
+ * The offset the transfer continued from is returned in `resumed_offset`,
+ * and the offset it reached in `byte_count`.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_download_resumable(
+    lv_libssh2_sftp_t *sftp, const char *remote_path, const char *local_path,
+    const char *journal_path, const bool verify_tail, const size_t chunk_size,
+    const size_t window_depth, uint64_t *resumed_offset, uint64_t *byte_count);
+
+/**
+ * Uploads the local file to the remote file, continuing an earlier attempt
+ * recorded in the journal file if there is one.
+ *
+ * The journal works as for lv_libssh2_sftp_download_resumable, with the
+ * local file as the source. The remote file is only created or truncated
+ * with the permissions when the transfer starts over.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_upload_resumable(
+    lv_libssh2_sftp_t *sftp, const char *local_path, const char *remote_path,
+    const char *journal_path, const int32_t permissions,
+    const bool verify_tail, const size_t chunk_size,
+    const size_t window_depth, uint64_t *resumed_offset, uint64_t *byte_count);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup sftp-mirror SFTP Mirror
+ *
+ * Recursive directory downloads and uploads.
+ *
+ * A mirror walks the source tree on a background thread, creating each
+ * directory at the destination and adding each regular file to a transfer
+ * queue as it is found, so transfers begin before the walk ends. The number
+ * of files transferred at once is the number of sessions added to the queue.
+ * The SFTP handle is only used for the walk and must be on a session that is
+ * not also part of the queue. Links to files are copied as files, and links
+ * to directories are skipped.
+ *
+ * @{
+ */
+
+/**
+ * Starts mirroring the remote directory to the local directory, or the local
+ * directory to the remote directory for an upload.
+ *
+ * The queue must be started for the files to transfer. Existing files are
+ * replaced.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_mirror(
+    lv_libssh2_sftp_t *sftp, lv_libssh2_transfer_queue_t *queue,
+    const char *remote_path, const char *local_path,
+    const lv_libssh2_transfer_directions_t direction,
+    lv_libssh2_sftp_mirror_t **handle);
+
+/**
+ * Stops the walk and destroys the mirror.
+ *
+ * Files already added to the queue are still transferred. Destroy the mirror
+ * before the queue.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_mirror_destroy(lv_libssh2_sftp_mirror_t *handle);
+
+/**
+ * Stops the walk and cancels the transfers of the mirror that have not
+ * finished.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_mirror_cancel(lv_libssh2_sftp_mirror_t *handle);
+
+/**
+ * Waits for the walk and all of the transfers of the mirror to finish.
+ *
+ * A negative `timeout`, in milliseconds, waits indefinitely. The first error
+ * of the walk is returned once everything has finished. A bad use error is
+ * returned if transfers remain but the queue has no workers running.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_sftp_mirror_wait(lv_libssh2_sftp_mirror_t *handle,
+                            const int32_t timeout);
+
+/**
+ * Gets the progress of the mirror.
+ *
+ * The `scanning` flag is set while the walk is running. The `files` count is
+ * the number of files found so far, and the `failed` count includes cancelled
+ * transfers. A directory that cannot be created or read is skipped along with
+ * its contents, and the first such error is kept in `walk_status`.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_mirror_status(
+    lv_libssh2_sftp_mirror_t *handle, bool *scanning, size_t *directories,
+    size_t *files, size_t *completed, size_t *failed, uint64_t *byte_count,
+    lv_libssh2_status_t *walk_status);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup sftp-sync SFTP Sync
+ *
+ * Incremental file transfers that only send the data that changed.
+ *
+ * A file with the same size and modification time on both sides is skipped.
+ * Otherwise, the range both files share is compared with MD5 digests. A
+ * digest of the whole range is tried first, so a file that only grew by
+ * appending costs a single remote command. Failing that, the range is
+ * compared in blocks of `block_size` bytes, and only the blocks that differ
+ * are sent. Any data beyond the end of the destination is always sent. The
+ * remote digests are computed with `head`, `dd`, and `md5sum` over an exec
+ * channel on the `session`, which must be the session of the `sftp` handle
+ * or another session to the same host. A zero `block_size` selects the
+ * default of 1 MiB. The destination ends up with the size and modification
+ * time of the source, and `byte_count` is the number of bytes sent.
+ *
+ * @{
+ */
+
+/**
+ * Brings the remote file up to date with the local file.
+ *
+ * A missing remote file is uploaded whole with `0644` permissions.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_sync_upload(
+    lv_libssh2_sftp_t *sftp, lv_libssh2_session_t *session,
+    const char *local_path, const char *remote_path, const size_t block_size,
+    uint64_t *byte_count);
+
+/**
+ * Brings the local file up to date with the remote file.
+ *
+ * A missing local file is downloaded whole.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_sync_download(
+    lv_libssh2_sftp_t *sftp, lv_libssh2_session_t *session,
+    const char *remote_path, const char *local_path, const size_t block_size,
+    uint64_t *byte_count);
+
+/**
+ * @}
+ */
+
 /**
  * @defgroup sftp SFTP Attribute
  *
@@ -1025,6 +2350,110 @@ LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_sftp_attributes_file_type(
  * @}
  */
 
+/**
+ * @defgroup transfer-queue Transfer Queue
+ *
+ * Many SFTP file transfers spread across a pool of sessions.
+ *
+ * Each session added to the queue gets its own worker thread and SFTP
+ * channel, and the workers take pending jobs in the order they were added.
+ * The sessions must already be connected and authenticated, are put in
+ * blocking mode, and must not be used elsewhere while the queue is started.
+ * The queue does not own the sessions, so destroy the queue before them.
+ *
+ * @{
+ */
+
+/**
+ * Creates a transfer queue.
+ *
+ * The `chunk_size` and `window_depth` apply to every transfer, see the SFTP
+ * Transfer functions.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_transfer_queue_create(const size_t chunk_size,
+                                 const size_t window_depth,
+                                 lv_libssh2_transfer_queue_t **handle);
+
+/**
+ * Stops the queue, waiting for the workers to exit, and destroys it.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_transfer_queue_destroy(lv_libssh2_transfer_queue_t *handle);
+
+/**
+ * Adds a session, and a worker for it, to the queue.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_transfer_queue_add_session(lv_libssh2_transfer_queue_t *handle,
+                                      lv_libssh2_session_t *session);
+
+/**
+ * Adds a transfer job to the queue.
+ *
+ * The `job` is the zero-based index of the job within the queue. Uploads
+ * create or truncate the remote file with `0644` permissions.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_transfer_queue_add(
+    lv_libssh2_transfer_queue_t *handle, const char *remote_path,
+    const char *local_path, const lv_libssh2_transfer_directions_t direction,
+    size_t *job);
+
+/**
+ * Starts the workers.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_transfer_queue_start(lv_libssh2_transfer_queue_t *handle);
+
+/**
+ * Stops the workers, waiting for them to exit.
+ *
+ * Running jobs are interrupted and become pending again, so they restart from
+ * the beginning on the next start.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_transfer_queue_stop(lv_libssh2_transfer_queue_t *handle);
+
+/**
+ * Waits for all of the jobs to finish.
+ *
+ * A negative `timeout`, in milliseconds, waits indefinitely. A bad use error
+ * is returned if jobs remain but no workers are running.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_transfer_queue_wait(lv_libssh2_transfer_queue_t *handle,
+                               const int32_t timeout);
+
+/**
+ * Cancels a pending or running job.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t
+lv_libssh2_transfer_queue_cancel(lv_libssh2_transfer_queue_t *handle,
+                                 const size_t job);
+
+/**
+ * Gets the state, result, and number of bytes transferred for a job.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_transfer_queue_job_status(
+    lv_libssh2_transfer_queue_t *handle, const size_t job,
+    lv_libssh2_transfer_states_t *state, lv_libssh2_status_t *job_status,
+    uint64_t *byte_count);
+
+/**
+ * Gets the aggregate progress of the queue.
+ *
+ * The `failed` count includes cancelled jobs. The `bytes_per_second` is the
+ * average rate since the queue was last started.
+ */
+LV_LIBSSH2_API lv_libssh2_status_t lv_libssh2_transfer_queue_statistics(
+    lv_libssh2_transfer_queue_t *handle, size_t *pending, size_t *running,
+    size_t *completed, size_t *failed, uint64_t *byte_count,
+    double *bytes_per_second);
+
+/**
+ * @}
+ */
+
 /**
  * @defgroup utility Utility
  *
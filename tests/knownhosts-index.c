@@ -0,0 +1,202 @@
+/*
+ * LabSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <string.h>
+
+#include "libssh2.h"
+
+#include "lv-libssh2-knownhosts-index-private.h"
+#include "lv-libssh2.h"
+#include "minunit.h"
+
+/* Ed25519 keys with every byte of the public key the same */
+#define KEY_PREFIX "AAAAC3NzaC1lZDI1NTE5AAAAI"
+#define KEY1 KEY_PREFIX "AEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEB"
+#define KEY2 KEY_PREFIX "AICAgICAgICAgICAgICAgICAgICAgICAgICAgICAgIC"
+#define KEY3 KEY_PREFIX "AMDAwMDAwMDAwMDAwMDAwMDAwMDAwMDAwMDAwMDAwMD"
+#define KEY4 KEY_PREFIX "AQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQE"
+#define KEY5 KEY_PREFIX "AUFBQUFBQUFBQUFBQUFBQUFBQUFBQUFBQUFBQUFBQUF"
+#define KEY6 KEY_PREFIX "AYGBgYGBgYGBgYGBgYGBgYGBgYGBgYGBgYGBgYGBgYG"
+#define KEY7 KEY_PREFIX "AcHBwcHBwcHBwcHBwcHBwcHBwcHBwcHBwcHBwcHBwcH"
+#define KEY8 KEY_PREFIX "AgICAgICAgICAgICAgICAgICAgICAgICAgICAgICAgI"
+
+/* The hashed names are `hashed.example.com`, `[hashedport.example.com]:2200`,
+ * and `shared.example.com`, where the first and last share a salt. */
+static const char *LINES[] = {
+    "# plain.example.com ssh-ed25519 " KEY8,
+    "",
+    "@cert-authority *.example.com ssh-ed25519 " KEY8,
+    "@revoked plain.example.com ssh-ed25519 " KEY8,
+    "plain.example.com,10.0.0.1 ssh-ed25519 " KEY1,
+    "[port.example.com]:2222 ssh-ed25519 " KEY2,
+    "|1|MDEyMzQ1Njc4OWFiY2RlZmdoaWo=|gzfxEI74iflku6CWHlY6D9H4tKY= "
+    "ssh-ed25519 " KEY3,
+    "|1|QUJDREVGR0hJSjAxMjM0NTY3ODk=|Oj+YCRNXMHh2DiYNEJOc26QHJM0= "
+    "ssh-ed25519 " KEY4,
+    "|1|MDEyMzQ1Njc4OWFiY2RlZmdoaWo=|vCaAxh+gqfLOAM8EoUp5id+sdX4= "
+    "ssh-ed25519 " KEY5,
+    "twice.example.com ssh-ed25519 " KEY6,
+    "twice.example.com ssh-ed25519 " KEY7,
+    "shared.example.com ssh-ed25519 " KEY6,
+};
+
+typedef struct {
+  const char *host;
+  int port;
+  const char *key;
+  lv_libssh2_knownhosts_check_results_t expected;
+} check_case_t;
+
+static const check_case_t CASES[] = {
+    {"plain.example.com", -1, KEY1, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"plain.example.com", 22, KEY1, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"10.0.0.1", 22, KEY1, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"plain.example.com", 22, KEY2,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MISMATCH},
+    {"PLAIN.example.com", 22, KEY1,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_NOT_FOUND},
+    {"port.example.com", 2222, KEY2, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"port.example.com", 2222, KEY1,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MISMATCH},
+    {"port.example.com", 22, KEY2,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_NOT_FOUND},
+    {"hashed.example.com", 22, KEY3, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"hashed.example.com", 22, KEY1,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MISMATCH},
+    {"hashedport.example.com", 2200, KEY4,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"hashedport.example.com", 22, KEY4,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_NOT_FOUND},
+    {"twice.example.com", 22, KEY6, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"twice.example.com", 22, KEY7, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"twice.example.com", 22, KEY8,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MISMATCH},
+    {"shared.example.com", 22, KEY5, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"shared.example.com", 22, KEY6, LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MATCH},
+    {"shared.example.com", 22, KEY1,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_MISMATCH},
+    {"other.example.com", 22, KEY1,
+     LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_NOT_FOUND},
+};
+
+static LIBSSH2_SESSION *session = NULL;
+static LIBSSH2_KNOWNHOSTS *known_hosts = NULL;
+static lv_libssh2_knownhosts_index_t hosts_index;
+
+static void test_setup(void) {
+  libssh2_init(0);
+  session = libssh2_session_init();
+  known_hosts = libssh2_knownhost_init(session);
+  lv_libssh2_knownhosts_index_init(&hosts_index);
+  for (size_t i = 0; i < sizeof(LINES) / sizeof(LINES[0]); i++) {
+    /* Marked lines are rejected by libssh2, which is the same as skipping
+     * them for the lookups. */
+    libssh2_knownhost_readline(known_hosts, LINES[i], strlen(LINES[i]),
+                               LIBSSH2_KNOWNHOST_FILE_OPENSSH);
+    lv_libssh2_knownhosts_index_add_line(&hosts_index, LINES[i],
+                                         strlen(LINES[i]));
+  }
+}
+
+static void test_teardown(void) {
+  lv_libssh2_knownhosts_index_free(&hosts_index);
+  libssh2_knownhost_free(known_hosts);
+  libssh2_session_free(session);
+  libssh2_exit();
+}
+
+MU_TEST(test_add_line_works) {
+  lv_libssh2_knownhosts_index_t lines;
+  lv_libssh2_knownhosts_index_init(&lines);
+  for (size_t i = 0; i < sizeof(LINES) / sizeof(LINES[0]); i++) {
+    mu_check(lv_libssh2_knownhosts_index_add_line(
+                 &lines, LINES[i], strlen(LINES[i])) == LV_LIBSSH2_STATUS_OK);
+  }
+  mu_assert_int_eq(3, (int)lines.hashed_count);
+  mu_assert_int_eq(2, (int)lines.group_count);
+  lv_libssh2_knownhosts_index_free(&lines);
+}
+
+MU_TEST(test_add_line_skips_rsa1) {
+  const char *line = "rsa1.example.com 1024 35 1234567890";
+  lv_libssh2_knownhosts_index_t lines;
+  lv_libssh2_knownhosts_index_init(&lines);
+  mu_check(lv_libssh2_knownhosts_index_add_line(&lines, line, strlen(line)) ==
+           LV_LIBSSH2_STATUS_OK);
+  mu_assert_int_eq(0, (int)lines.names.count);
+  lv_libssh2_knownhosts_index_free(&lines);
+}
+
+MU_TEST(test_add_line_rejects_malformed) {
+  const char *line = "nokey.example.com ssh-ed25519";
+  lv_libssh2_knownhosts_index_t lines;
+  lv_libssh2_knownhosts_index_init(&lines);
+  mu_check(lv_libssh2_knownhosts_index_add_line(&lines, line, strlen(line)) ==
+           LV_LIBSSH2_STATUS_ERROR_KNOWN_HOSTS);
+  lv_libssh2_knownhosts_index_free(&lines);
+}
+
+MU_TEST(test_lookup_matches_libssh2) {
+  for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+    const check_case_t *check = &CASES[i];
+    struct libssh2_knownhost *found = NULL;
+    int expected = libssh2_knownhost_checkp(
+        known_hosts, check->host, check->port, check->key, strlen(check->key),
+        LIBSSH2_KNOWNHOST_TYPE_PLAIN | LIBSSH2_KNOWNHOST_KEYENC_BASE64,
+        &found);
+    lv_libssh2_knownhosts_check_results_t result =
+        LV_LIBSSH2_KNOWNHOSTS_CHECK_RESULT_FAILURE;
+    lv_libssh2_knownhosts_index_lookup(&hosts_index, check->host, check->port,
+                                       check->key, &result);
+    mu_assert_int_eq(expected, (int)result);
+    mu_assert_int_eq((int)check->expected, (int)result);
+    /* A second lookup of a hashed name is answered from the memo. */
+    lv_libssh2_knownhosts_index_lookup(&hosts_index, check->host, check->port,
+                                       check->key, &result);
+    mu_assert_int_eq((int)check->expected, (int)result);
+  }
+}
+
+MU_TEST_SUITE(knownhosts_index) {
+  MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+  MU_RUN_TEST(test_add_line_works);
+  MU_RUN_TEST(test_add_line_skips_rsa1);
+  MU_RUN_TEST(test_add_line_rejects_malformed);
+  MU_RUN_TEST(test_lookup_matches_libssh2);
+}
+
+int main(int argc, char *argv[]) {
+  MU_RUN_SUITE(knownhosts_index);
+  MU_REPORT();
+  return minunit_fail;
+}
@@ -0,0 +1,140 @@
+/*
+ * LabSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lv-libssh2-ring-private.h"
+#include "lv-libssh2.h"
+#include "minunit.h"
+
+MU_TEST(test_ring_allocate_rounds_to_pages) {
+  lv_libssh2_ring_t ring;
+  mu_check(lv_libssh2_ring_allocate(&ring, 1) == LV_LIBSSH2_STATUS_OK);
+  mu_check(ring.capacity > 0);
+  mu_check(lv_libssh2_ring_is_aligned(ring.data));
+  size_t page = ring.capacity;
+  lv_libssh2_ring_release(&ring);
+  mu_check(lv_libssh2_ring_allocate(&ring, page + 1) == LV_LIBSSH2_STATUS_OK);
+  mu_check(ring.capacity == 2 * page);
+  mu_check(lv_libssh2_ring_is_aligned(ring.data));
+  mu_check(lv_libssh2_ring_available(&ring) == 2 * page);
+  lv_libssh2_ring_release(&ring);
+  mu_check(ring.data == NULL);
+}
+
+MU_TEST(test_ring_is_aligned_rejects_offset) {
+  lv_libssh2_ring_t ring;
+  mu_check(lv_libssh2_ring_allocate(&ring, 1) == LV_LIBSSH2_STATUS_OK);
+  mu_check(lv_libssh2_ring_is_aligned(ring.data));
+  mu_check(!lv_libssh2_ring_is_aligned(ring.data + 1));
+  mu_check(!lv_libssh2_ring_is_aligned(ring.data + 64));
+  lv_libssh2_ring_release(&ring);
+}
+
+MU_TEST(test_ring_spans_work) {
+  uint8_t buffer[8];
+  lv_libssh2_ring_t ring;
+  lv_libssh2_ring_attach(&ring, buffer, sizeof(buffer));
+  size_t offset = 0;
+  size_t len = 0;
+  lv_libssh2_ring_write_span(&ring, &offset, &len);
+  mu_assert_int_eq(0, (int)offset);
+  mu_assert_int_eq(8, (int)len);
+  lv_libssh2_ring_read_span(&ring, &offset, &len);
+  mu_assert_int_eq(0, (int)len);
+  lv_libssh2_ring_produce(&ring, 6);
+  mu_assert_int_eq(6, (int)lv_libssh2_ring_used(&ring));
+  mu_assert_int_eq(2, (int)lv_libssh2_ring_available(&ring));
+  lv_libssh2_ring_read_span(&ring, &offset, &len);
+  mu_assert_int_eq(0, (int)offset);
+  mu_assert_int_eq(6, (int)len);
+  lv_libssh2_ring_consume(&ring, 4);
+  lv_libssh2_ring_write_span(&ring, &offset, &len);
+  mu_assert_int_eq(6, (int)offset);
+  mu_assert_int_eq(2, (int)len);
+  lv_libssh2_ring_release(&ring);
+}
+
+MU_TEST(test_ring_spans_wrap) {
+  uint8_t buffer[8];
+  lv_libssh2_ring_t ring;
+  lv_libssh2_ring_attach(&ring, buffer, sizeof(buffer));
+  lv_libssh2_ring_produce(&ring, 8);
+  lv_libssh2_ring_consume(&ring, 5);
+  size_t offset = 0;
+  size_t len = 0;
+  lv_libssh2_ring_write_span(&ring, &offset, &len);
+  mu_assert_int_eq(0, (int)offset);
+  mu_assert_int_eq(5, (int)len);
+  lv_libssh2_ring_produce(&ring, 4);
+  lv_libssh2_ring_read_span(&ring, &offset, &len);
+  mu_assert_int_eq(5, (int)offset);
+  mu_assert_int_eq(3, (int)len);
+  lv_libssh2_ring_consume(&ring, len);
+  lv_libssh2_ring_read_span(&ring, &offset, &len);
+  mu_assert_int_eq(0, (int)offset);
+  mu_assert_int_eq(4, (int)len);
+  lv_libssh2_ring_consume(&ring, len);
+  mu_assert_int_eq(0, (int)lv_libssh2_ring_used(&ring));
+  lv_libssh2_ring_release(&ring);
+}
+
+MU_TEST(test_ring_full_has_no_write_span) {
+  uint8_t buffer[4];
+  lv_libssh2_ring_t ring;
+  lv_libssh2_ring_attach(&ring, buffer, sizeof(buffer));
+  lv_libssh2_ring_produce(&ring, 4);
+  size_t offset = 0;
+  size_t len = 0;
+  lv_libssh2_ring_write_span(&ring, &offset, &len);
+  mu_assert_int_eq(0, (int)len);
+  lv_libssh2_ring_read_span(&ring, &offset, &len);
+  mu_assert_int_eq(4, (int)len);
+  lv_libssh2_ring_release(&ring);
+}
+
+MU_TEST_SUITE(ring) {
+  MU_RUN_TEST(test_ring_allocate_rounds_to_pages);
+  MU_RUN_TEST(test_ring_is_aligned_rejects_offset);
+  MU_RUN_TEST(test_ring_spans_work);
+  MU_RUN_TEST(test_ring_spans_wrap);
+  MU_RUN_TEST(test_ring_full_has_no_write_span);
+}
+
+int main(int argc, char *argv[]) {
+  MU_RUN_SUITE(ring);
+  MU_REPORT();
+  return minunit_fail;
+}
@@ -0,0 +1,127 @@
+/*
+ * LabSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lv-libssh2-sftp-cache-private.h"
+#include "lv-libssh2.h"
+#include "minunit.h"
+
+static lv_libssh2_sftp_cache_t *cache = NULL;
+
+static void test_setup(void) { lv_libssh2_sftp_cache_create(60, &cache); }
+
+static void test_teardown(void) {
+  lv_libssh2_sftp_cache_destroy(cache);
+  cache = NULL;
+}
+
+static void store(const char *path, const uint64_t size) {
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.flags = LIBSSH2_SFTP_ATTR_SIZE;
+  attributes.filesize = size;
+  lv_libssh2_sftp_cache_store_attributes(cache,
+                                         LV_LIBSSH2_SFTP_CACHE_KIND_STATUS,
+                                         path, &attributes,
+                                         LV_LIBSSH2_STATUS_OK);
+}
+
+static bool find(const char *path, uint64_t *size) {
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  lv_libssh2_status_t status = LV_LIBSSH2_STATUS_OK;
+  if (!lv_libssh2_sftp_cache_find_attributes(
+          cache, LV_LIBSSH2_SFTP_CACHE_KIND_STATUS, path, &attributes,
+          &status)) {
+    return false;
+  }
+  *size = attributes.filesize;
+  return true;
+}
+
+static size_t bucket_of(const char *path) {
+  for (size_t i = 0;; i++) {
+    for (lv_libssh2_sftp_cache_entry_t *entry = cache->buckets[i];
+         entry != NULL; entry = entry->next) {
+      if (strcmp(entry->path, path) == 0) {
+        return i;
+      }
+    }
+  }
+}
+
+MU_TEST(test_find_works) {
+  uint64_t size = 0;
+  mu_check(!find("/a", &size));
+  store("/a/", 7);
+  mu_check(find("/a", &size));
+  mu_assert_int_eq(7, (int)size);
+  mu_assert_int_eq(1, (int)cache->hits);
+  mu_assert_int_eq(1, (int)cache->misses);
+}
+
+MU_TEST(test_find_expired_does_not_return_neighbour) {
+  char path[32];
+  store("/a", 1);
+  size_t bucket = bucket_of("/a");
+  for (int i = 0;; i++) {
+    snprintf(path, sizeof(path), "/b%d", i);
+    store(path, 2);
+    if (bucket_of(path) == bucket) {
+      break;
+    }
+  }
+  /* The colliding entry is first in the bucket and is followed by `/a`. */
+  mu_check(cache->buckets[bucket]->next != NULL);
+  cache->buckets[bucket]->expires = 0;
+  uint64_t size = 0;
+  uint64_t misses = cache->misses;
+  mu_check(!find(path, &size));
+  mu_check(cache->misses == misses + 1);
+  mu_check(find("/a", &size));
+  mu_assert_int_eq(1, (int)size);
+}
+
+MU_TEST_SUITE(sftp_cache) {
+  MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+  MU_RUN_TEST(test_find_works);
+  MU_RUN_TEST(test_find_expired_does_not_return_neighbour);
+}
+
+int main(int argc, char *argv[]) {
+  MU_RUN_SUITE(sftp_cache);
+  MU_REPORT();
+  return minunit_fail;
+}
@@ -0,0 +1,165 @@
+/*
+ * LabSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-sftp-listing-private.h"
+#include "lv-libssh2.h"
+#include "minunit.h"
+
+static lv_libssh2_sftp_listing_t *listing = NULL;
+
+static void append(const char *name, const uint64_t size) {
+  LIBSSH2_SFTP_ATTRIBUTES attributes;
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.flags = LIBSSH2_SFTP_ATTR_SIZE | LIBSSH2_SFTP_ATTR_PERMISSIONS;
+  attributes.filesize = size;
+  attributes.permissions = LIBSSH2_SFTP_S_IFREG | 0644;
+  lv_libssh2_sftp_listing_append(listing, name, strlen(name), &attributes);
+}
+
+static void test_setup(void) {
+  listing = calloc(1, sizeof(lv_libssh2_sftp_listing_t));
+  append("a.txt", 1);
+  append("", 2);
+  append("longer name.bin", 3);
+}
+
+static void test_teardown(void) {
+  lv_libssh2_sftp_listing_destroy(listing);
+  listing = NULL;
+}
+
+MU_TEST(test_record_layout_works) {
+  mu_assert_int_eq(40, (int)sizeof(lv_libssh2_sftp_listing_record_t));
+  mu_assert_int_eq(
+      0, (int)offsetof(lv_libssh2_sftp_listing_record_t, size));
+  mu_assert_int_eq(
+      8, (int)offsetof(lv_libssh2_sftp_listing_record_t, name_offset));
+  mu_assert_int_eq(
+      12, (int)offsetof(lv_libssh2_sftp_listing_record_t, name_len));
+  mu_assert_int_eq(
+      16, (int)offsetof(lv_libssh2_sftp_listing_record_t, flags));
+  mu_assert_int_eq(
+      36, (int)offsetof(lv_libssh2_sftp_listing_record_t, type));
+}
+
+MU_TEST(test_records_work) {
+  size_t count = 0;
+  size_t len = 0;
+  lv_libssh2_sftp_listing_count(listing, &count);
+  lv_libssh2_sftp_listing_records_len(listing, &len);
+  mu_assert_int_eq(3, (int)count);
+  mu_assert_int_eq(120, (int)len);
+  lv_libssh2_sftp_listing_record_t records[3];
+  lv_libssh2_sftp_listing_records(listing, (uint8_t *)records);
+  mu_assert_int_eq(0, (int)records[0].name_offset);
+  mu_assert_int_eq(5, (int)records[0].name_len);
+  mu_assert_int_eq(6, (int)records[1].name_offset);
+  mu_assert_int_eq(0, (int)records[1].name_len);
+  mu_assert_int_eq(7, (int)records[2].name_offset);
+  mu_assert_int_eq(15, (int)records[2].name_len);
+  mu_assert_int_eq(3, (int)records[2].size);
+  mu_assert_int_eq(LV_LIBSSH2_FILE_TYPE_REGULAR, (int)records[2].type);
+}
+
+MU_TEST(test_names_work) {
+  size_t len = 0;
+  lv_libssh2_sftp_listing_names_len(listing, &len);
+  mu_assert_int_eq(23, (int)len);
+  uint8_t names[23];
+  lv_libssh2_sftp_listing_names(listing, names);
+  mu_check(memcmp(names, "a.txt\0\0longer name.bin\0", 23) == 0);
+}
+
+MU_TEST(test_names_grow) {
+  char name[1000];
+  memset(name, 'x', sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+  for (int i = 0; i < 100; i++) {
+    append(name, (uint64_t)i);
+  }
+  lv_libssh2_sftp_listing_record_t *record = &listing->records[102];
+  mu_assert_int_eq(23 + 99 * 1000, (int)record->name_offset);
+  mu_check(memcmp(listing->names + record->name_offset, name,
+                  sizeof(name)) == 0);
+}
+
+MU_TEST(test_clone_works) {
+  lv_libssh2_sftp_listing_t *copy = NULL;
+  mu_check(lv_libssh2_sftp_listing_clone(listing, &copy) ==
+           LV_LIBSSH2_STATUS_OK);
+  mu_assert_int_eq((int)listing->count, (int)copy->count);
+  mu_assert_int_eq((int)listing->names_len, (int)copy->names_len);
+  mu_check(memcmp(copy->records, listing->records,
+                  listing->count *
+                      sizeof(lv_libssh2_sftp_listing_record_t)) == 0);
+  mu_check(memcmp(copy->names, listing->names, listing->names_len) == 0);
+  mu_check(copy->records != listing->records);
+  mu_check(copy->names != listing->names);
+  lv_libssh2_sftp_listing_destroy(copy);
+}
+
+MU_TEST(test_clone_empty_works) {
+  lv_libssh2_sftp_listing_t *empty =
+      calloc(1, sizeof(lv_libssh2_sftp_listing_t));
+  lv_libssh2_sftp_listing_t *copy = NULL;
+  mu_check(lv_libssh2_sftp_listing_clone(empty, &copy) ==
+           LV_LIBSSH2_STATUS_OK);
+  mu_assert_int_eq(0, (int)copy->count);
+  mu_check(copy->records == NULL);
+  lv_libssh2_sftp_listing_destroy(copy);
+  lv_libssh2_sftp_listing_destroy(empty);
+}
+
+MU_TEST_SUITE(sftp_listing) {
+  MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+  MU_RUN_TEST(test_record_layout_works);
+  MU_RUN_TEST(test_records_work);
+  MU_RUN_TEST(test_names_work);
+  MU_RUN_TEST(test_names_grow);
+  MU_RUN_TEST(test_clone_works);
+  MU_RUN_TEST(test_clone_empty_works);
+}
+
+int main(int argc, char *argv[]) {
+  MU_RUN_SUITE(sftp_listing);
+  MU_REPORT();
+  return minunit_fail;
+}
@@ -0,0 +1,157 @@
+/*
+ * LabSSH2 - A LabVIEW-Friendly C library for libssh2
+ *
+ * Copyright (c) 2018 Field R&D Services, LLC. All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * withoutmodification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the Field R&D Services nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Field R&D Services, LLC ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Field R&D Services, LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contributor(s):
+ *   Christopher R. Field <chris@fieldrndservices.com>
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "libssh2.h"
+#include "libssh2_sftp.h"
+
+#include "lv-libssh2-sftp-read-ahead-private.h"
+#include "minunit.h"
+
+#define FILE_SIZE 262144
+
+/* A remote file whose bytes are derived from their offsets */
+struct _LIBSSH2_SFTP_HANDLE {
+  uint64_t position;
+};
+
+static uint8_t file_byte(const uint64_t offset) {
+  return (uint8_t)((offset * 31) ^ (offset >> 8));
+}
+
+ssize_t libssh2_sftp_read(LIBSSH2_SFTP_HANDLE *handle, char *buffer,
+                          size_t buffer_maxlen) {
+  size_t count = 0;
+  while (count < buffer_maxlen && handle->position < FILE_SIZE) {
+    buffer[count] = (char)file_byte(handle->position);
+    handle->position += 1;
+    count += 1;
+  }
+  return (ssize_t)count;
+}
+
+libssh2_uint64_t libssh2_sftp_tell64(LIBSSH2_SFTP_HANDLE *handle) {
+  return handle->position;
+}
+
+void libssh2_sftp_seek64(LIBSSH2_SFTP_HANDLE *handle,
+                         libssh2_uint64_t offset) {
+  handle->position = offset;
+}
+
+static LIBSSH2_SFTP_HANDLE file;
+static lv_libssh2_sftp_read_ahead_t read_ahead;
+static uint8_t buffer[131072];
+static uint64_t position = 0;
+
+static void test_setup(void) {
+  file.position = 0;
+  position = 0;
+  lv_libssh2_sftp_read_ahead_init(&read_ahead);
+}
+
+static void test_teardown(void) {
+  lv_libssh2_sftp_read_ahead_free(&read_ahead);
+}
+
+/* Reads exactly `len` bytes and checks they are the bytes of the file at the
+ * expected position. */
+static int read_checked(const size_t len) {
+  size_t total = 0;
+  while (total < len) {
+    ssize_t count = lv_libssh2_sftp_read_ahead_read(&read_ahead, &file,
+                                                    buffer, len - total);
+    if (count <= 0) {
+      return 0;
+    }
+    for (ssize_t i = 0; i < count; i++) {
+      if (buffer[i] != file_byte(position + (uint64_t)i)) {
+        return 0;
+      }
+    }
+    position += (uint64_t)count;
+    total += (size_t)count;
+  }
+  return lv_libssh2_sftp_read_ahead_position(&read_ahead, &file) == position;
+}
+
+static void seek(const uint64_t offset) {
+  lv_libssh2_sftp_read_ahead_seek(&read_ahead, &file, offset);
+  position = offset;
+}
+
+MU_TEST(test_sequential_reads_work) {
+  for (int i = 0; i < 1000; i++) {
+    mu_check(read_checked(100));
+  }
+  seek(10);
+  mu_check(read_checked(100));
+  seek(200000);
+  mu_check(read_checked(100));
+}
+
+MU_TEST(test_large_read_drains_buffer) {
+  mu_check(read_checked(100));
+  mu_check(read_checked(100));
+  mu_check(read_ahead.end > read_ahead.start);
+  mu_check(read_checked(read_ahead.end - read_ahead.start));
+  mu_check(read_checked(sizeof(buffer)));
+  seek(position - sizeof(buffer) - 100);
+  mu_check(read_checked(50));
+  mu_check(read_checked(100));
+  mu_check(read_checked(100));
+}
+
+MU_TEST(test_seek_within_buffer_works) {
+  mu_check(read_checked(100));
+  mu_check(read_checked(100));
+  seek(150);
+  mu_check(file.position > 200);
+  mu_check(read_checked(100));
+  mu_check(read_checked(65536));
+}
+
+MU_TEST_SUITE(sftp_read_ahead) {
+  MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+  MU_RUN_TEST(test_sequential_reads_work);
+  MU_RUN_TEST(test_large_read_drains_buffer);
+  MU_RUN_TEST(test_seek_within_buffer_works);
+}
+
+int main(int argc, char *argv[]) {
+  MU_RUN_SUITE(sftp_read_ahead);
+  MU_REPORT();
+  return minunit_fail;
+}
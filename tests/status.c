@@ -39,7 +39,43 @@ MU_TEST(test_status_string_works) {
   mu_assert_string_eq("No Error", text);
 }
 
-MU_TEST_SUITE(status) { MU_RUN_TEST(test_status_string_works); }
+MU_TEST(test_status_string_new_errors_work) {
+  mu_assert_string_eq("Cancelled Error",
+                      lv_libssh2_status_string(
+                          LV_LIBSSH2_STATUS_ERROR_CANCELLED));
+  mu_assert_string_eq("Pool Miss Error",
+                      lv_libssh2_status_string(
+                          LV_LIBSSH2_STATUS_ERROR_POOL_MISS));
+  mu_assert_string_eq("Host Resolve Error",
+                      lv_libssh2_status_string(
+                          LV_LIBSSH2_STATUS_ERROR_HOST_RESOLVE));
+  mu_assert_string_eq("Connect Error", lv_libssh2_status_string(
+                                           LV_LIBSSH2_STATUS_ERROR_CONNECT));
+  mu_assert_string_eq("Remote Command Error",
+                      lv_libssh2_status_string(
+                          LV_LIBSSH2_STATUS_ERROR_REMOTE_COMMAND));
+  mu_assert_string_eq("Host Key Unknown Error",
+                      lv_libssh2_status_string(
+                          LV_LIBSSH2_STATUS_ERROR_HOST_KEY_UNKNOWN));
+  mu_assert_string_eq("Host Key Mismatch Error",
+                      lv_libssh2_status_string(
+                          LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH));
+}
+
+MU_TEST(test_status_message_new_errors_work) {
+  mu_assert_string_eq(
+      "The operation was cancelled before it completed.",
+      lv_libssh2_status_message(LV_LIBSSH2_STATUS_ERROR_CANCELLED));
+  mu_assert_string_eq(
+      "The host key does not match the key in the known hosts.",
+      lv_libssh2_status_message(LV_LIBSSH2_STATUS_ERROR_HOST_KEY_MISMATCH));
+}
+
+MU_TEST_SUITE(status) {
+  MU_RUN_TEST(test_status_string_works);
+  MU_RUN_TEST(test_status_string_new_errors_work);
+  MU_RUN_TEST(test_status_message_new_errors_work);
+}
 
 int main(int argc, char *argv[]) {
   MU_RUN_SUITE(status);